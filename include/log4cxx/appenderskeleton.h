@@ -71,6 +71,17 @@ namespace log4cxx
 		*/
 		bool closed;
 
+		/** Maximum number of characters of the messages appended by this
+		appender. 0 stands for no limit. */
+		int maxMessageLength;
+
+		/** Maximum number of characters of the NDC of the events appended
+		by this appender. 0 stands for no limit. */
+		int maxNDCLength;
+
+		/** Number of events truncated by this appender. */
+		volatile long truncatedEvents;
+
 	public:
 		AppenderSkeleton();
 
@@ -86,7 +97,11 @@ namespace log4cxx
 		requires it.
 		*/
 		void activateOptions() {}
-		void setOption(const tstring& name, const tstring& value) {}
+
+		/**
+		Set <b>MaxMessageLength</b> and <b>MaxNDCLength</b>.
+		*/
+		void setOption(const tstring& option, const tstring& value);
 
 		/**
 		Add a filter to end of the filter list.
@@ -166,6 +181,20 @@ namespace log4cxx
 	public:
 		void doAppend(const spi::LoggingEvent& event);
 
+		/**
+		Calls #append with <code>event</code>, or with a truncated copy of
+		it when its message or NDC exceeds the limits of this appender.
+		*/
+	protected:
+		void appendLimited(const spi::LoggingEvent& event);
+
+		/**
+		Returns <code>true</code> if <code>event</code> is as severe as
+		the threshold of this appender and is not denied by its filters.
+		*/
+	protected:
+		bool isAccepted(const spi::LoggingEvent& event);
+
 		/**
 		Set the {@link spi::ErrorHandler ErrorHandler} for this Appender.
 		*/
@@ -198,6 +227,40 @@ namespace log4cxx
 		*/
 	public:
 		void setThreshold(const Level& threshold) { this->threshold = &threshold; }
+
+		/**
+		Set the maximum number of characters of the messages appended by
+		this appender. A longer message is truncated and ends with a marker
+		giving the number of characters removed. The events are then copied,
+		so this limit is usually stricter than
+		spi::LoggingEvent#setMaxMessageLength. 0, the default, stands for
+		no limit.
+		*/
+	public:
+		void setMaxMessageLength(int maxMessageLength)
+			{ this->maxMessageLength = maxMessageLength; }
+
+		/** Returns the maximum number of characters of the messages
+		appended by this appender. */
+	public:
+		int getMaxMessageLength() const { return maxMessageLength; }
+
+		/**
+		Set the maximum number of characters of the NDC of the events
+		appended by this appender. 0, the default, stands for no limit.
+		*/
+	public:
+		void setMaxNDCLength(int maxNDCLength)
+			{ this->maxNDCLength = maxNDCLength; }
+
+		/** Returns the maximum number of characters of the NDC of the
+		events appended by this appender. */
+	public:
+		int getMaxNDCLength() const { return maxNDCLength; }
+
+		/** Returns the number of events truncated by this appender. */
+	public:
+		long getTruncatedEventCount() const { return truncatedEvents; }
 		
 	}; // class AppenderSkeleton
 }; // namespace log4cxx
@@ -20,6 +20,11 @@
 #include <log4cxx/appenderskeleton.h>
 #include <log4cxx/helpers/appenderattachableimpl.h>
 #include <log4cxx/helpers/thread.h>
+#include <log4cxx/helpers/criticalsection.h>
+#include <log4cxx/helpers/semaphore.h>
+#include <log4cxx/helpers/histogram.h>
+#include <deque>
+#include <map>
 
 namespace log4cxx
 {
@@ -42,6 +47,26 @@ namespace log4cxx
 	<p>The AsyncAppender uses a separate thread to serve the events in
 	its bounded buffer.
 
+	<p>In hybrid mode (see #setHybrid), an event is passed directly to
+	the attached appenders by the calling thread when the buffer is
+	empty and the dispatcher is not writing: an idle AsyncAppender then
+	costs no copy and no thread switch. Events are only queued when the
+	attached appenders are busy, so the order of the events of a given
+	thread is preserved.
+
+	<p>The AsyncAppender measures the time each event spends in the
+	buffer and the time taken by the attached appenders to write it
+	(see #getDispatchDelay and #getAppendDuration), as well as the
+	highest number of events waiting in the buffer. These statistics
+	can be logged periodically with the <b>SummaryInterval</b> option.
+
+	<p>In fan-out mode (see #setFanOut), each attached appender has its
+	own queue, of <b>SinkBufferSize</b> events, and its own thread: the
+	dispatcher only passes a shared copy of each event to the queues,
+	so that a slow appender does not delay the other ones. What happens
+	when the queue of an appender is full is set by the
+	<b>OverflowPolicy</b> option.
+
 	<p><b>Important note:</b> The <code>AsyncAppender</code> can only
 	be script configured using the {@link xml::DOMConfigurator DOMConfigurator}.
 	*/
@@ -55,14 +80,188 @@ namespace log4cxx
 		/** The default buffer size is set to 128 events. */
 		static int DEFAULT_BUFFER_SIZE;
 
+		/** How the dispatcher waits for events, see #setWaitStrategy. */
+		enum WaitStrategy
+		{
+			BLOCK,
+			SPIN,
+			YIELD,
+			PARK
+		};
+
+		/** What the dispatcher does with an event for an appender whose
+		queue is full, in fan-out mode, see #setOverflowPolicy. */
+		enum OverflowPolicy
+		{
+			WAIT_FOR_SPACE,
+			DISCARD_NEWEST,
+			DISCARD_OLDEST
+		};
+
+		/** Statistics of the queue of an appender in fan-out mode. */
+		struct SinkStatistics
+		{
+			tstring appenderName;
+
+			/** Number of events in the queue. */
+			int pending;
+
+			/** Highest number of events in the queue. */
+			int highWaterMark;
+
+			/** Number of events passed to the appender. */
+			long written;
+
+			/** Number of events discarded because the queue was full. */
+			long discarded;
+		};
+
+		/** An event queued for several appenders, deleted by the last
+		one. */
+		struct SharedEvent
+		{
+			spi::LoggingEvent * event;
+			volatile long references;
+		};
+
+		/**
+		The queue and the thread of an attached appender in fan-out
+		mode.
+		*/
+		class Sink :
+			public helpers::Runnable,
+			public helpers::ObjectImpl
+		{
+		public:
+			Sink(const AppenderPtr& appender, int bufferSize,
+				OverflowPolicy policy);
+			~Sink();
+
+			/** Starts the thread of the sink. */
+			void start();
+
+			/** Queues <code>event</code>, or releases it according to
+			the overflow policy or if the sink is closing. */
+			void put(SharedEvent * event);
+
+			/** Writes the queued events and stops the thread. */
+			void close();
+
+			SinkStatistics getStatistics();
+
+			/** Passes the queued events to the appender. */
+			void run();
+
+			AppenderPtr appender;
+
+		protected:
+			/** Releases a reference to <code>event</code>. */
+			static void release(SharedEvent * event);
+
+			helpers::CriticalSection cs;
+			std::deque<SharedEvent *> queue;
+			int bufferSize;
+			OverflowPolicy policy;
+
+			/** Posted for each queued event, and on #close. */
+			helpers::Semaphore available;
+
+			/** Posted when an event is removed while the dispatcher
+			waits for space. */
+			helpers::Semaphore space;
+
+			/** Posted by the thread when it has finished. */
+			helpers::Semaphore ended;
+
+			bool dispatcherWaiting;
+			bool closing;
+			int highWaterMark;
+			long written;
+			long discarded;
+		}; // class Sink
+		typedef helpers::ObjectPtr<Sink> SinkPtr;
+
 		helpers::BoundedFIFOPtr bf;
 		Dispatcher * dispatcher;
 		bool locationInfo;
 		bool interruptedWarningMessage;
+		bool hybrid;
+		WaitStrategy waitStrategy;
+
+		/**
+		Set by the dispatcher, with the buffer lock held, before it
+		waits for #eventAvailable. Producers only post the semaphore
+		when it is set.
+		*/
+		bool dispatcherParked;
+
+		/** Posted when an event is put in a buffer while the dispatcher
+		is parked. */
+		helpers::Semaphore eventAvailable;
+
+		/** Posted for each producer waiting for free space. */
+		helpers::Semaphore spaceAvailable;
+
+		/** Number of producers waiting for free space in the buffer. */
+		int waitingProducers;
+
+		/** Posted by the dispatcher when it has finished. */
+		helpers::Semaphore dispatcherEnded;
+
+		/**
+		Held while events are passed to the attached appenders, either
+		by the dispatcher or, in hybrid mode, by a producer.
+		*/
+		helpers::CriticalSection dispatchCs;
+
+		/** Time spent by the events in the buffer, protected by
+		#dispatchCs. */
+		helpers::Histogram dispatchDelay;
+
+		/** Time spent in appendLoopOnAppenders, protected by
+		#dispatchCs. */
+		helpers::Histogram appendDuration;
+
+		/** Highest number of events in the buffer, protected by the
+		buffer lock. */
+		int highWaterMark;
+
+		/** Seconds between two summaries, 0 if disabled. */
+		int summaryInterval;
+
+		/** Time of the next summary, protected by #dispatchCs. */
+		helpers::int64 nextSummary;
+
+		/** The <code>log4cxx.AsyncAppender</code> logger, looked up
+		before the dispatcher needs it. */
+		LoggerPtr summaryLogger;
+
+		bool fanOut;
+		int sinkBufferSize;
+		OverflowPolicy overflowPolicy;
+
+		/** Overflow policies of the appenders given by name. */
+		std::map<tstring, OverflowPolicy> overflowPolicies;
+
+		/** Sinks of the attached appenders, created by the dispatcher
+		and protected by the appender lock. */
+		std::vector<SinkPtr> sinks;
+
+		/** Sinks of the event being dispatched, used by the dispatcher
+		only. They are held by reference since an appender may be
+		removed while its sink is in use. */
+		std::vector<SinkPtr> targets;
 
 		AsyncAppender();
 		~AsyncAppender();
 
+		/**
+		Unlike AppenderSkeleton#doAppend, this method does not hold the
+		lock of the appender: the buffer is synchronized on its own and
+		producers do not wait for each other.
+		*/
+		void doAppend(const spi::LoggingEvent& event);
+
 		void append(const spi::LoggingEvent& event);
 
 		/**
@@ -116,14 +315,246 @@ namespace log4cxx
 		Returns the current value of the <b>BufferSize</b> option.
 		*/
 		int getBufferSize();
+
+		/**
+		The <b>Hybrid</b> option takes a boolean value. When set to true,
+		events are appended synchronously by the calling thread as long
+		as the buffer is empty and the attached appenders are not busy,
+		and queued otherwise. It is false by default.
+		*/
+		inline void setHybrid(bool hybrid)
+			{ this->hybrid = hybrid; }
+
+		/**
+		Returns the current value of the <b>Hybrid</b> option.
+		*/
+		inline bool isHybrid() const
+			{ return hybrid; }
+
+		/**
+		The <b>WaitStrategy</b> option tells how the dispatcher waits
+		for events when the buffer is empty:
+		<ul>
+		<li><b>Block</b> (the default): it waits on a semaphore.</li>
+		<li><b>Spin</b>: it checks the buffer in a busy loop and never
+		waits. This gives the lowest latency, but keeps a processor
+		busy: use it only with a processor dedicated to the
+		dispatcher.</li>
+		<li><b>Yield</b>: it checks the buffer for a while, then gives
+		up the processor to other threads between checks.</li>
+		<li><b>Park</b>: it spins, then yields a few times, then waits
+		on the semaphore. The spin time adapts itself: it grows when
+		events arrive while spinning and shrinks when the dispatcher
+		has to wait.</li>
+		</ul>
+		<p>In all cases, producers only post the semaphore when the
+		dispatcher actually waits on it.
+		*/
+		inline void setWaitStrategy(WaitStrategy waitStrategy)
+			{ this->waitStrategy = waitStrategy; }
+
+		/**
+		Returns the current value of the <b>WaitStrategy</b> option.
+		*/
+		inline WaitStrategy getWaitStrategy() const
+			{ return waitStrategy; }
+
+		/**
+		Returns the time spent by the events in the buffer, from their
+		append to their dispatch, in microseconds. Events appended
+		directly in hybrid mode count with a delay of 0.
+		*/
+		helpers::Histogram getDispatchDelay();
+
+		/**
+		Returns the time taken by the attached appenders to write each
+		event, in microseconds.
+		*/
+		helpers::Histogram getAppendDuration();
+
+		/**
+		Returns the highest number of events that have been waiting
+		in the buffer.
+		*/
+		int getHighWaterMark();
+
+		/**
+		Resets the histograms and the high-water mark.
+		*/
+		void resetStatistics();
+
+		/**
+		The <b>SummaryInterval</b> option takes a number of seconds.
+		When it is not 0, a summary of the statistics of the appender
+		is logged at INFO level with the <code>log4cxx.AsyncAppender</code>
+		logger every <b>SummaryInterval</b> seconds, by the thread which
+		appends the events. The summary is passed to the attached
+		appenders only. It is 0 by default.
+		*/
+		void setSummaryInterval(int seconds);
+
+		/**
+		Returns the current value of the <b>SummaryInterval</b> option.
+		*/
+		inline int getSummaryInterval() const
+			{ return summaryInterval; }
+
+		/**
+		Looks up the logger of the summaries, so that the thread which
+		appends the events does not have to.
+		*/
+		void activateOptions();
+
+		/**
+		The <b>FanOut</b> option takes a boolean value. When set to true,
+		each attached appender is written by its own thread from its own
+		queue, and the <b>Hybrid</b> option is ignored. It is false by
+		default and must be set before the first event is appended.
+		*/
+		inline void setFanOut(bool fanOut)
+			{ this->fanOut = fanOut; }
+
+		/**
+		Returns the current value of the <b>FanOut</b> option.
+		*/
+		inline bool isFanOut() const
+			{ return fanOut; }
+
+		/**
+		The <b>SinkBufferSize</b> option takes the number of events in
+		the queue of each appender in fan-out mode. It is
+		#DEFAULT_BUFFER_SIZE by default.
+		*/
+		inline void setSinkBufferSize(int size)
+			{ sinkBufferSize = (size > 0) ? size : 1; }
+
+		/**
+		Returns the current value of the <b>SinkBufferSize</b> option.
+		*/
+		inline int getSinkBufferSize() const
+			{ return sinkBufferSize; }
+
+		/**
+		The <b>OverflowPolicy</b> option tells what the dispatcher does
+		with an event for an appender whose queue is full, in fan-out
+		mode:
+		<ul>
+		<li><b>Block</b> (the default): it waits for space in the queue,
+		and then the other appenders wait too once their queues are
+		empty.</li>
+		<li><b>DiscardNewest</b>: the event is not written by this
+		appender.</li>
+		<li><b>DiscardOldest</b>: the oldest event of the queue is not
+		written by this appender.</li>
+		</ul>
+		<p>The policy of a single appender is set with the
+		<b>OverflowPolicy.</b><i>name</i> option, where <i>name</i> is the
+		name of the appender.
+		*/
+		void setOverflowPolicy(OverflowPolicy policy)
+			{ overflowPolicy = policy; }
+
+		/**
+		Sets the overflow policy of the appender named
+		<code>appenderName</code>.
+		*/
+		void setOverflowPolicy(const tstring& appenderName,
+			OverflowPolicy policy);
+
+		/**
+		Returns the current value of the <b>OverflowPolicy</b> option.
+		*/
+		inline OverflowPolicy getOverflowPolicy() const
+			{ return overflowPolicy; }
+
+		/**
+		Returns the statistics of the queue of each appender which has
+		received events in fan-out mode.
+		*/
+		std::vector<SinkStatistics> getSinkStatistics();
+
+		/**
+		Writes the events queued for the attached appenders in fan-out
+		mode, and then removes and closes them.
+		*/
+		void removeAllAppenders();
+
+		/**
+		Removes <code>appender</code> once the events queued for it in
+		fan-out mode are written.
+		*/
+		void removeAppender(AppenderPtr appender);
+
+		/**
+		Removes the appender named <code>name</code> once the events
+		queued for it in fan-out mode are written.
+		*/
+		void removeAppender(const tstring& name);
+
+		/**
+		Set options
+		*/
+		void setOption(const tstring& option, const tstring& value);
+
+	protected:
+		/**
+		Passes <code>event</code>, which is deleted once written, to the
+		queues of the attached appenders. Called by the dispatcher in
+		fan-out mode.
+		*/
+		void fanOutEvent(spi::LoggingEvent * event);
+
+		/**
+		Writes the events in the queues of the appenders and stops
+		their threads.
+		*/
+		void closeSinks();
+
+		/**
+		Writes the events in the queues of the appenders which are no
+		longer attached and stops their threads.
+		*/
+		void closeDetachedSinks();
+
+		/**
+		Wakes up the producers waiting for free space. Must be called
+		with the buffer lock held.
+		*/
+		void notifyWaitingProducers();
+
+		/**
+		Records the statistics of an event passed to the attached
+		appenders and appends a summary if it is time to. Must be
+		called with #dispatchCs held.
+		*/
+		void eventDispatched(helpers::int64 enqueued,
+			helpers::int64 dispatched, helpers::int64 written);
 	}; // class AsyncAppender
 
 	class Dispatcher : public  helpers::Thread
 	{
 		helpers::BoundedFIFOPtr bf;
-		bool interrupted;
+		volatile bool interrupted;
 		AsyncAppender * container;
 
+		enum
+		{
+			MIN_SPIN_COUNT = 64,
+			MAX_SPIN_COUNT = 64 * 1024,
+			YIELD_COUNT = 8
+		};
+
+		/** Number of checks before yielding, adapted by the PARK
+		strategy. */
+		int spinCount;
+
+		/**
+		Waits for events according to the wait strategy of the
+		container. May return before an event is available: the caller
+		checks the buffer again.
+		*/
+		void waitForEvents();
+
 	public:
 		Dispatcher(helpers::BoundedFIFOPtr bf, AsyncAppender * container);
 		void close();
@@ -134,6 +565,13 @@ namespace log4cxx
 		the monitor (variable bf) so that new events can be placed in the
 		buffer, instead of keeping the monitor and processing the remaining
 		events in the buffer.
+		<p>The dispatch lock of the container is taken before an event is
+		removed from the buffer and released once it has been appended,
+		so that a producer in hybrid mode never overtakes an event being
+		dispatched.
+		<p>In fan-out mode, the events are passed to the queues of the
+		appenders instead, and the queues are emptied before the
+		dispatcher ends.
 		<p>Other approaches might yield better results.
 		*/
 		void run();
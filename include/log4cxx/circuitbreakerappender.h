@@ -0,0 +1,261 @@
+/***************************************************************************
+                          circuitbreakerappender.h  -  class CircuitBreakerAppender
+                             -------------------
+    begin                : jeu mai 22 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#ifndef _LOG4CXX_CIRCUIT_BREAKER_APPENDER_H
+#define _LOG4CXX_CIRCUIT_BREAKER_APPENDER_H
+
+#include <log4cxx/appenderskeleton.h>
+#include <log4cxx/spi/appenderattachable.h>
+#include <log4cxx/helpers/reclaimer.h>
+
+namespace log4cxx
+{
+	/**
+	The CircuitBreakerAppender protects the threads which log from an
+	appender which has become too slow or fails, such as a file on an
+	unreachable network drive or a socket to a dead server.
+
+	<p>The first attached appender is the protected appender and the
+	second one, if any, the backup appender. As long as the protected
+	appender is healthy, the events are passed to it. The circuit
+	breaker <em>trips</em> when:
+	<ul>
+	<li>an append has been running for more than <b>LatencyThreshold</b>
+	milliseconds: other threads would then wait for it,</li>
+	<li>or <b>FailureThreshold</b> consecutive appends have taken more
+	than <b>LatencyThreshold</b> milliseconds or thrown an exception.</li>
+	</ul>
+	<p>Once tripped, the events are diverted to the backup appender, or
+	dropped and counted if there is none. The error handler of the
+	circuit breaker is told when it trips. Every <b>ProbeInterval</b>
+	milliseconds, one event is passed to the protected appender again:
+	if it is appended in time, the circuit breaker is reset.
+
+	<p>Unlike AppenderSkeleton#doAppend, #doAppend does not hold the
+	lock of the appender: the state of the circuit breaker is only
+	changed with atomic operations, so that threads do not wait for
+	each other while the protected appender is healthy. The attached
+	appenders can be changed at any time: they are replaced together
+	and read without any lock.
+	*/
+	class CircuitBreakerAppender :
+		public AppenderSkeleton,
+		public virtual spi::AppenderAttachable
+	{
+	public:
+		/** The default latency threshold is 1 second. */
+		static int DEFAULT_LATENCY_THRESHOLD;
+
+		/** By default, the circuit breaker trips after 3 failures. */
+		static int DEFAULT_FAILURE_THRESHOLD;
+
+		/** The default probe interval is 10 seconds. */
+		static int DEFAULT_PROBE_INTERVAL;
+
+	protected:
+		enum State
+		{
+			HEALTHY,
+			TRIPPED,
+			PROBING
+		};
+
+		/**
+		The protected and the backup appenders. They are never changed
+		once published: a new pair replaces them.
+		*/
+		class Appenders : public virtual helpers::ObjectImpl
+		{
+		public:
+			AppenderPtr appender;
+			AppenderPtr backupAppender;
+		};
+		typedef helpers::ObjectPtr<Appenders> AppendersPtr;
+
+		/** Appenders read by #append, owned by #appendersPtr. */
+		Appenders * volatile appenders;
+
+		/** The published appenders, only replaced under the lock of the
+		circuit breaker. */
+		AppendersPtr appendersPtr;
+
+		/**
+		Keeps the replaced appenders until no thread is still in #append
+		with them.
+		*/
+		helpers::Reclaimer reclaimer;
+
+		int latencyThreshold;
+		int failureThreshold;
+		int probeInterval;
+
+		volatile long state;
+
+		/** Number of consecutive failures while healthy. */
+		volatile long failures;
+
+		/** Start time of an append in progress, 0 if there is none. */
+		volatile long busySince;
+
+		/** Time of the next probe while tripped. */
+		volatile long nextProbe;
+
+		volatile long trips;
+		volatile long divertedEvents;
+		volatile long droppedEvents;
+
+	public:
+		CircuitBreakerAppender();
+		~CircuitBreakerAppender();
+
+		/**
+		Unlike AppenderSkeleton#doAppend, this method does not hold the
+		lock of the appender, nor any other lock.
+		*/
+		void doAppend(const spi::LoggingEvent& event);
+
+		void append(const spi::LoggingEvent& event);
+
+		/**
+		Closes the attached appenders.
+		*/
+		void close();
+
+		/**
+		The <code>CircuitBreakerAppender</code> does not require a layout.
+		Hence, this method always returns <code>false</code>.
+		*/
+		bool requiresLayout()
+			{ return false; }
+
+		/**
+		Sets the protected appender if there is none, else the backup
+		appender.
+		*/
+		void addAppender(AppenderPtr newAppender);
+
+		AppenderList getAllAppenders();
+		AppenderPtr getAppender(const tstring& name);
+		bool isAttached(AppenderPtr appender);
+		void removeAllAppenders();
+		void removeAppender(AppenderPtr appender);
+		void removeAppender(const tstring& name);
+
+		/** Sets the appender protected by the circuit breaker. */
+		void setAppender(AppenderPtr appender);
+
+		/** Returns the appender protected by the circuit breaker. */
+		AppenderPtr getAppender();
+
+		/**
+		Sets the appender which receives the events while the circuit
+		breaker is tripped. If it is null, these events are dropped.
+		*/
+		void setBackupAppender(AppenderPtr backupAppender);
+
+		/** Returns the backup appender. */
+		AppenderPtr getBackupAppender();
+
+		/**
+		The <b>LatencyThreshold</b> option takes a number of
+		milliseconds: an append which takes longer is a failure.
+		*/
+		inline void setLatencyThreshold(int millis)
+			{ latencyThreshold = millis; }
+
+		/** Returns the current value of the <b>LatencyThreshold</b>
+		option. */
+		inline int getLatencyThreshold() const
+			{ return latencyThreshold; }
+
+		/**
+		The <b>FailureThreshold</b> option takes the number of
+		consecutive failures which trip the circuit breaker.
+		*/
+		inline void setFailureThreshold(int failures)
+			{ failureThreshold = failures; }
+
+		/** Returns the current value of the <b>FailureThreshold</b>
+		option. */
+		inline int getFailureThreshold() const
+			{ return failureThreshold; }
+
+		/**
+		The <b>ProbeInterval</b> option takes a number of milliseconds
+		between two attempts to use the protected appender while the
+		circuit breaker is tripped.
+		*/
+		inline void setProbeInterval(int millis)
+			{ probeInterval = millis; }
+
+		/** Returns the current value of the <b>ProbeInterval</b>
+		option. */
+		inline int getProbeInterval() const
+			{ return probeInterval; }
+
+		/** Returns true if the events are currently diverted. */
+		inline bool isTripped() const
+			{ return state != HEALTHY; }
+
+		/** Returns the number of times the circuit breaker tripped. */
+		inline long getTripCount() const
+			{ return trips; }
+
+		/** Returns the number of events passed to the backup
+		appender. */
+		inline long getDivertedCount() const
+			{ return divertedEvents; }
+
+		/** Returns the number of events dropped because there is no
+		backup appender. */
+		inline long getDroppedCount() const
+			{ return droppedEvents; }
+
+		/**
+		Set options
+		*/
+		void setOption(const tstring& option, const tstring& value);
+
+	protected:
+		/** Returns the current time, in milliseconds. */
+		static long currentTimeMillis();
+
+		/**
+		Passes an event to the protected appender. Returns false if it
+		failed or took too long.
+		*/
+		bool tryAppend(const Appenders& appenders,
+			const spi::LoggingEvent& event, long start);
+
+		/** Trips the circuit breaker, if it is not already, because
+		of the protected appender of <code>appenders</code>. */
+		void trip(const Appenders& appenders, long now,
+			const tstring& reason);
+
+		/** Passes an event to the backup appender or drops it. */
+		void divert(const Appenders& appenders,
+			const spi::LoggingEvent& event);
+
+		/**
+		Publishes a new pair of appenders. The lock of the circuit
+		breaker must be held.
+		*/
+		void setAppenders(const AppenderPtr& appender,
+			const AppenderPtr& backupAppender);
+	}; // class CircuitBreakerAppender
+}; //  namespace log4cxx
+
+#endif //_LOG4CXX_CIRCUIT_BREAKER_APPENDER_H
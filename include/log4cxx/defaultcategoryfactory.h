@@ -19,6 +19,7 @@
 
 #include <log4cxx/spi/loggerfactory.h>
 #include <log4cxx/helpers/objectimpl.h>
+#include <log4cxx/helpers/arena.h>
 
 namespace log4cxx
 {
@@ -30,7 +31,16 @@ namespace log4cxx
 		public virtual helpers::ObjectImpl
 	{
 	public:
+		/**
+		@param arena If not null, the loggers are allocated from this
+		arena instead of the heap.
+		*/
+		DefaultCategoryFactory(helpers::ArenaPtr arena = 0);
+
 		virtual LoggerPtr makeNewLoggerInstance(const tstring& name);
+
+	protected:
+		helpers::ArenaPtr arena;
 	};	
 }; // namespace log4cxx
 
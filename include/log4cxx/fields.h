@@ -0,0 +1,144 @@
+/***************************************************************************
+                          fields.h  -  class Fields
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#ifndef _LOG4CXX_FIELDS_H
+#define _LOG4CXX_FIELDS_H
+
+#include <log4cxx/helpers/tchar.h>
+#include <log4cxx/helpers/clock.h>
+
+namespace log4cxx
+{
+	/**
+	A typed value attached to a logging event by its name.
+	*/
+	class Field
+	{
+	public:
+		enum Type { INT64, DOUBLE, STRING, BOOL };
+
+		/** The name of the field, not null terminated. */
+		const TCHAR * name;
+		size_t nameLength;
+
+		Type type;
+
+		/** The value of an INT64, DOUBLE or BOOL field. */
+		union
+		{
+			helpers::int64 int64Value;
+			double doubleValue;
+			bool boolValue;
+		} value;
+
+		/** The characters of a STRING field, not null terminated. */
+		const TCHAR * string;
+		size_t stringLength;
+
+		/** Returns true if the field is named <code>name</code>. */
+		bool hasName(const tstring& name) const;
+
+		/** Writes the value of the field, as text. */
+		void format(tostream& output) const;
+	};
+
+	/**
+	The typed fields of a logging event: structured data which is not
+	converted to text by the thread which logs.
+
+	<p>The fields are kept in a small array, without allocation: at most
+	#MAX_FIELDS fields can be added, the next ones are ignored. The
+	strings given to #add are not copied: they must stay unchanged
+	while the event is logged. The copies of the events which are kept
+	after the call, such as the ones of the AsyncAppender, own copies
+	of the strings.
+
+	<pre>
+	LOG4CXX_LOG_FIELDS(logger, Level::INFO, _T("request served"),
+		Fields().add(_T("status"), 200).add(_T("latency"), 0.012)
+		.add(_T("user"), user));
+	</pre>
+
+	<p>PatternLayout writes the value of a field with the <b>X</b>
+	conversion character, for example <code>\%X{latency}</code>, and all
+	the fields with <code>\%X</code>. XMLLayout writes them as
+	properties, and the SocketAppender sends them with their type.
+	*/
+	class Fields
+	{
+	public:
+		enum { MAX_FIELDS = 8 };
+
+		Fields();
+
+		/** Copies <code>fields</code> and their strings. */
+		Fields(const Fields& fields);
+
+		/** Copies <code>fields</code> and their strings. */
+		Fields& operator=(const Fields& fields);
+
+		Fields& add(const TCHAR * name, int value);
+		Fields& add(const TCHAR * name, long value);
+		Fields& add(const TCHAR * name, unsigned int value);
+		Fields& add(const TCHAR * name, unsigned long value);
+		Fields& add(const TCHAR * name, helpers::int64 value);
+		Fields& add(const TCHAR * name, double value);
+		Fields& add(const TCHAR * name, bool value);
+
+		/** Adds a string field referencing <code>value</code>. */
+		Fields& add(const TCHAR * name, const TCHAR * value);
+
+		/** Adds a string field referencing the characters of
+		<code>value</code>. */
+		Fields& add(const TCHAR * name, const tstring& value);
+
+		/** Returns the number of fields. */
+		inline int size() const
+			{ return count; }
+
+		/** Returns the field at <code>index</code>. */
+		inline const Field& operator[](int index) const
+			{ return fields[index]; }
+
+		/** Returns the field named <code>name</code>, or 0. */
+		const Field * find(const tstring& name) const;
+
+		/**
+		Copies <code>fields</code> without copying their strings, which
+		must outlive this object.
+		*/
+		void view(const Fields& fields);
+
+		/** Writes the fields as <code>name=value</code> pairs separated
+		by spaces. */
+		void format(tostream& output) const;
+
+	protected:
+		/** Adds a field and returns it, or 0 if there are too many. */
+		Field * add(const TCHAR * name, Field::Type type);
+
+		/** Copies the strings of the fields into #text. */
+		void own();
+
+		Field fields[MAX_FIELDS];
+		int count;
+
+		/** The names and strings of the fields, when they are owned. */
+		tstring text;
+	};
+}; // namespace log4cxx
+
+#endif //_LOG4CXX_FIELDS_H
@@ -20,6 +20,7 @@
 #include <log4cxx/config.h>
 #include <log4cxx/helpers/tchar.h>
 #include <log4cxx/writerappender.h>
+#include <log4cxx/helpers/gatherbuffer.h>
 #include <fstream>
 
 namespace log4cxx
@@ -61,6 +62,17 @@ namespace log4cxx
 		std::ofstream ofs;
 #endif
 
+		/**
+		Descriptor of the file, opened in append mode like #ofs. The
+		events with a large message are written to it with a
+		scatter-gather write of the output of the layout, which
+		references the message instead of copying it in the stream.
+		*/
+		int fd;
+
+		/** output of the layout for the scatter-gather writes */
+		helpers::GatherBuffer gatherBuffer;
+
 	public:
 		/**
 		The default constructor does not do anything.
@@ -140,6 +152,25 @@ namespace log4cxx
         */
         virtual void closeWriter();
 
+        /**
+        Opens #fileName, in append or truncate mode, and sets the output
+        stream. Returns false if the file could not be opened.
+        */
+        bool openFile(bool append);
+
+        /**
+        Returns the length of the file, including what is still
+        buffered in the stream.
+        */
+        long getFileLength();
+
+        /**
+        Writes the events with a large message with a scatter-gather
+        write, when the layout supports it, and the other ones to the
+        output stream.
+        */
+        virtual void subAppend(const spi::LoggingEvent& event);
+
     public:
         /**
         Get the value of the <b>BufferedIO</b> option.
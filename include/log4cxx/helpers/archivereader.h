@@ -0,0 +1,140 @@
+/***************************************************************************
+                          archivereader.h  -  class ArchiveReader
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#ifndef _LOG4CXX_HELPERS_ARCHIVE_READER_H
+#define _LOG4CXX_HELPERS_ARCHIVE_READER_H
+
+#include <log4cxx/helpers/archivewriter.h>
+
+namespace log4cxx
+{
+	namespace helpers
+	{
+		/**
+		Queries a log archive written by ArchiveWriter.
+
+		<p>A query reads the header of each block and skips the blocks
+		whose timestamps are out of its range, or whose bloom filter
+		does not contain its logger. In the other blocks, it only reads
+		the columns it filters on and the ones it returns.
+
+		<p>An ArchiveReader is not synchronized.
+		*/
+		class ArchiveReader
+		{
+		public:
+			/** Columns of an archive, to be combined in Query#columns. */
+			enum Column
+			{
+				TIMESTAMP = 1,
+				LEVEL = 2,
+				LOGGER = 4,
+				THREAD = 8,
+				MESSAGE = 16,
+				ALL_COLUMNS = 31
+			};
+
+			/** An event read from an archive. Only the columns asked by
+			the query are set. */
+			struct Record
+			{
+				/** microseconds since the epoch */
+				int64 timeStamp;
+				int level;
+				tstring loggerName;
+				unsigned long threadId;
+				tstring message;
+			};
+
+			/** The events a query returns. */
+			struct Query
+			{
+				/** Matches all the events and returns all the columns. */
+				Query();
+
+				/** range of timestamps, in microseconds since the epoch,
+				bounds included */
+				int64 from;
+				int64 to;
+
+				/** lowest level, as returned by Level#toInt */
+				int minLevel;
+
+				/** name of the logger of the events, any logger if
+				empty */
+				tstring loggerName;
+
+				/** columns to return, made of Column values */
+				int columns;
+			};
+
+			ArchiveReader();
+			~ArchiveReader();
+
+			/**
+			Opens <code>fileName</code>. Returns false if it could not be
+			opened or is not an archive.
+			*/
+			bool open(const tstring& fileName);
+
+			void close();
+
+			/**
+			Appends the events of the archive matching
+			<code>query</code> to <code>records</code>. Returns false if
+			the archive could not be read to its end.
+			*/
+			bool scan(const Query& query, std::vector<Record>& records);
+
+			/** Returns the number of blocks read by the last scan. */
+			inline int getBlocksRead() const
+				{ return blocksRead; }
+
+			/** Returns the number of blocks skipped by the last scan. */
+			inline int getBlocksSkipped() const
+				{ return blocksSkipped; }
+
+		protected:
+			/** Reads column <code>index</code> of the current block in
+			#columnData, decoded. */
+			bool readColumn(int index);
+
+			static bool readVarInt(const std::string& column, size_t& pos,
+				int64& value);
+			static bool readString(const std::string& column, size_t& pos,
+				tstring& value);
+			static int64 readFixed(const unsigned char * buffer, int size);
+
+			FILE * file;
+			int blocksRead;
+			int blocksSkipped;
+
+			// header of the current block
+			int eventCount;
+			int64 minTime;
+			int64 maxTime;
+			unsigned char bloom[ArchiveWriter::BLOOM_BYTES];
+			long storedSizes[ArchiveWriter::COLUMN_COUNT];
+			long sizes[ArchiveWriter::COLUMN_COUNT];
+			int encodings[ArchiveWriter::COLUMN_COUNT];
+
+			std::string columnData[ArchiveWriter::COLUMN_COUNT];
+			std::string stored;
+		}; // class ArchiveReader
+	}; // namespace helpers
+}; // namespace log4cxx
+
+#endif //_LOG4CXX_HELPERS_ARCHIVE_READER_H
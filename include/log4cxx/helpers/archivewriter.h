@@ -0,0 +1,162 @@
+/***************************************************************************
+                          archivewriter.h  -  class ArchiveWriter
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#ifndef _LOG4CXX_HELPERS_ARCHIVE_WRITER_H
+#define _LOG4CXX_HELPERS_ARCHIVE_WRITER_H
+
+#include <log4cxx/helpers/tchar.h>
+#include <log4cxx/helpers/clock.h>
+#include <stdio.h>
+#include <map>
+#include <vector>
+
+namespace log4cxx
+{
+	namespace spi
+	{
+		class LoggingEvent;
+	};
+
+	namespace helpers
+	{
+		/**
+		Writes events to a columnar log archive, which ArchiveReader
+		queries without reading the columns or the blocks it does not
+		need.
+
+		<p>The events are written in blocks of #getBlockSize events. Each
+		block starts with a header:
+		<ul>
+		<li>the magic number "L4CB" and the number of events;</li>
+		<li>the first and last timestamps of the block, in microseconds
+		since the epoch;</li>
+		<li>a bloom filter of the logger names of the block;</li>
+		<li>the stored size, the decoded size and the encoding of each
+		column, raw or deflated with zlib.</li>
+		</ul>
+		It is followed by the columns, in this order:
+		<ul>
+		<li>timestamps, as the difference with the previous one, the
+		first one in full;</li>
+		<li>levels, run-length encoded;</li>
+		<li>loggers, as indexes in a dictionary of the names in the
+		block;</li>
+		<li>thread identifiers;</li>
+		<li>messages.</li>
+		</ul>
+		The integers of the columns are variable length, and the strings
+		are made of their length followed by their characters, as
+		written by SocketOutputStream. The archive file starts with the
+		magic number "L4CA" followed by the format version.
+
+		<p>An ArchiveWriter is not synchronized.
+		*/
+		class ArchiveWriter
+		{
+		public:
+			enum
+			{
+				FORMAT_VERSION = 1,
+				COLUMN_COUNT = 5,
+				BLOOM_BYTES = 64,
+				BLOOM_HASHES = 3
+			};
+
+			/** Encodings of a column. */
+			enum Encoding
+			{
+				RAW = 0,
+				DEFLATE = 1
+			};
+
+			/** The default block size is 4096 events. */
+			static int DEFAULT_BLOCK_SIZE;
+
+			ArchiveWriter();
+			~ArchiveWriter();
+
+			/**
+			Opens <code>fileName</code>, in append or truncate mode.
+			Returns false if the file could not be opened.
+			*/
+			bool open(const tstring& fileName, bool append);
+
+			/** Writes the current block and closes the file. */
+			void close();
+
+			inline bool isOpen() const
+				{ return file != 0; }
+
+			/** Adds <code>event</code> to the current block, which is
+			written once full. */
+			void write(const spi::LoggingEvent& event);
+
+			/** Writes the current block, even if it is not full. */
+			void flush();
+
+			/** Sets the number of events in a block. Larger blocks compress
+			better but are skipped less often by queries. */
+			inline void setBlockSize(int blockSize)
+				{ this->blockSize = (blockSize > 0) ? blockSize : 1; }
+
+			inline int getBlockSize() const
+				{ return blockSize; }
+
+			/**
+			Computes the bits of the bloom filter set by
+			<code>loggerName</code>.
+			*/
+			static void getBloomBits(const tstring& loggerName,
+				unsigned int bits[BLOOM_HASHES]);
+
+		protected:
+			static void writeVarInt(std::string& column, int64 value);
+			static void writeString(std::string& column,
+				const tstring& value);
+			static void writeFixed(std::string& buffer, int64 value,
+				int size);
+
+			/** Stores <code>column</code> in #data and its size and
+			encoding in the header. */
+			void addColumn(std::string& header, const std::string& column);
+
+			FILE * file;
+			int blockSize;
+
+			// current block
+			int eventCount;
+			int64 minTime;
+			int64 maxTime;
+			int64 lastTime;
+			unsigned char bloom[BLOOM_BYTES];
+			std::string timestamps;
+			std::string levels;
+			int lastLevel;
+			int levelRun;
+			std::map<tstring, int> dictionary;
+			std::vector<const tstring *> loggerNames;
+			std::string loggers;
+			std::string threads;
+			std::string messages;
+
+			/** columns of the block being written */
+			std::string data;
+			std::string compressed;
+		}; // class ArchiveWriter
+	}; // namespace helpers
+}; // namespace log4cxx
+
+#endif //_LOG4CXX_HELPERS_ARCHIVE_WRITER_H
@@ -0,0 +1,103 @@
+/***************************************************************************
+                          arena.h  -  class Arena
+                             -------------------
+    begin                : mar mai 20 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#ifndef _LOG4CXX_HELPERS_ARENA_H
+#define _LOG4CXX_HELPERS_ARENA_H
+
+#include <log4cxx/helpers/objectimpl.h>
+#include <log4cxx/helpers/objectptr.h>
+#include <vector>
+#include <map>
+#include <stddef.h>
+
+/** Size of a cache line of the target processor. */
+#ifndef LOG4CXX_CACHE_LINE_SIZE
+#define LOG4CXX_CACHE_LINE_SIZE 64
+#endif
+
+namespace log4cxx
+{
+	namespace helpers
+	{
+		class Arena;
+		typedef ObjectPtr<Arena> ArenaPtr;
+
+		/**
+		Slab allocator for objects allocated in large numbers and released
+		together, such as the loggers of a Hierarchy.
+
+		<p>Blocks are carved out of large chunks and aligned on a cache
+		line. A released block is kept in a free list and reused for the
+		next allocation of the same size. The chunks are only released
+		when the arena is destroyed, which happens when the last reference
+		to it goes away: every block allocated holds a reference to its
+		arena.
+
+		<p>The objects are still destroyed one at a time. Once the arena is
+		closed, their blocks are no longer put back in the free lists:
+		releasing a block only drops its reference to the arena.
+		*/
+		class Arena : public virtual ObjectImpl
+		{
+		public:
+			/**
+			Creates an arena.
+			@param chunkSize The size of the chunks requested to the heap.
+			*/
+			Arena(size_t chunkSize = 64 * 1024);
+			~Arena();
+
+			/**
+			Allocates <code>size</code> bytes aligned on a cache line from
+			this arena. The block must be released by #deallocate.
+			*/
+			void * allocate(size_t size);
+
+			/**
+			Allocates <code>size</code> bytes aligned on a cache line from
+			the heap. The block must be released by #deallocate.
+			*/
+			static void * allocateAligned(size_t size);
+
+			/**
+			Releases a block returned by #allocate or #allocateAligned to
+			the arena or to the heap it was allocated from.
+			*/
+			static void deallocate(void * p);
+
+			/**
+			Tells the arena that no block will be allocated any more. The
+			blocks released afterwards are not reused.
+			*/
+			void close();
+
+		protected:
+			void release(void * p, size_t slotSize);
+
+			size_t chunkSize;
+			char * current;
+			char * end;
+			std::vector<char *> chunks;
+			volatile bool closed;
+
+			/** free blocks, by slot size */
+			typedef std::map<size_t, void *> FreeLists;
+			FreeLists freeLists;
+		};
+	}; // namespace helpers
+}; // namespace log4cxx
+
+#endif //_LOG4CXX_HELPERS_ARENA_H
@@ -19,6 +19,7 @@
 
 #include <log4cxx/helpers/objectimpl.h>
 #include <log4cxx/helpers/objectptr.h>
+#include <log4cxx/helpers/clock.h>
 
 namespace log4cxx
 {
@@ -39,7 +40,12 @@ namespace log4cxx
 		class BoundedFIFO : public ObjectImpl
 		{
 			spi::LoggingEvent * * buf;
-			int numElements;
+
+			/** time each event was put in the buffer */
+			int64 * stamps;
+
+			/** read without the lock by a spinning consumer */
+			volatile int numElements;
 			int first;
 			int next;
 			int maxSize;
@@ -49,18 +55,26 @@ namespace log4cxx
 			Instantiate a new BoundedFIFO with a maximum size passed as argument.
 			*/
 			BoundedFIFO(int maxSize);
+			~BoundedFIFO();
 
 			/**
 			Get the first element in the buffer. Returns <code>null</code> if
-			there are no elements in the buffer.  */
-			spi::LoggingEvent * get();
+			there are no elements in the buffer.
+			@param stamp If not null, receives the stamp the element was put
+			with.
+			*/
+			spi::LoggingEvent * get(int64 * stamp = 0);
 
 			/**
 			Place a {@link spi::LoggingEvent LoggingEvent} in the buffer.
 			If the buffer is full
 			then the event is <b>silently dropped</b>. It is the caller's
-			responsability to make sure that the buffer has free space.  */
-			void put(spi::LoggingEvent * o);
+			responsability to make sure that the buffer has free space.
+			@param o The event.
+			@param stamp A time, usually Clock#monotonicMicros, returned with
+			the event by #get.
+			*/
+			void put(spi::LoggingEvent * o, int64 stamp = 0);
 
 			/**
 			Get the maximum size of the buffer.
@@ -0,0 +1,61 @@
+/***************************************************************************
+                          byterange.h  -  class ByteRange
+                             -------------------
+    begin                : sam mai 24 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#ifndef _LOG4CXX_HELPERS_BYTE_RANGE_H
+#define _LOG4CXX_HELPERS_BYTE_RANGE_H
+
+#include <log4cxx/config.h>
+#include <stddef.h>
+
+namespace log4cxx
+{
+	namespace helpers
+	{
+		/**
+		A range of bytes in memory, one of the buffers of a scatter-gather
+		write: writing several ranges in a single system call avoids
+		copying them into one buffer first.
+		*/
+		class ByteRange
+		{
+		public:
+			/**
+			Length from which a buffer is referenced in a scatter-gather
+			write rather than copied with the bytes around it.
+			*/
+			enum { MIN_GATHER_LENGTH = 4096 };
+
+			const void * data;
+			size_t length;
+
+			inline ByteRange()
+				: data(0), length(0) {}
+
+			inline ByteRange(const void * data, size_t length)
+				: data(data), length(length) {}
+
+			/**
+			Writes <code>count</code> ranges to a file descriptor. Uses
+			<code>writev</code> where available, and resumes it until all
+			the bytes are written. Returns the number of bytes written,
+			or -1 in case of error.
+			*/
+			static long write(int fd, const ByteRange * ranges, int count);
+		};
+	}; // namespace helpers
+}; // namespace log4cxx
+
+#endif //_LOG4CXX_HELPERS_BYTE_RANGE_H
@@ -0,0 +1,58 @@
+/***************************************************************************
+                          clock.h  -  class Clock
+                             -------------------
+    begin                : mer mai 21 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#ifndef _LOG4CXX_HELPERS_CLOCK_H
+#define _LOG4CXX_HELPERS_CLOCK_H
+
+#include <log4cxx/config.h>
+
+namespace log4cxx
+{
+	namespace helpers
+	{
+		/** 64 bits signed integer, used for times in microseconds. */
+#ifdef WIN32
+		typedef __int64 int64;
+		typedef unsigned __int64 uint64;
+#else
+		typedef long long int64;
+		typedef unsigned long long uint64;
+#endif
+
+		/**
+		Time sources with a microsecond resolution.
+		*/
+		class Clock
+		{
+		public:
+			/**
+			Returns the number of microseconds elapsed since an arbitrary
+			origin. Unlike #currentTimeMicros, the value is not affected
+			by changes of the system time: it is meant to measure
+			durations.
+			*/
+			static int64 monotonicMicros();
+
+			/**
+			Returns the number of microseconds elapsed since
+			01.01.1970.
+			*/
+			static int64 currentTimeMicros();
+		};
+	}; // namespace helpers
+}; // namespace log4cxx
+
+#endif //_LOG4CXX_HELPERS_CLOCK_H
@@ -19,6 +19,10 @@
 
 #include <log4cxx/config.h>
 
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
 namespace log4cxx
 {
 	namespace helpers
@@ -29,10 +33,22 @@ namespace log4cxx
 			CriticalSection();
 			~CriticalSection();
 			void lock();
+
+			/**
+			Locks the critical section if it is not owned by any thread,
+			including the calling one, and returns <code>true</code>.
+			Returns <code>false</code> without waiting otherwise.
+			*/
+			bool tryLock();
+
 			void unlock();
 
 		protected:
+#ifdef HAVE_PTHREAD_H
+			pthread_mutex_t mutex;
+#elif defined(WIN32)
 			void * mutex;
+#endif
 		};
 	}; // namespace helpers
 }; // namespace log4cxx
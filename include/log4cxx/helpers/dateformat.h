@@ -18,21 +18,110 @@
 #define _LOG4CXX_HELPERS_DATE_FORMAT_H
 
 #include <log4cxx/helpers/tchar.h>
+#include <log4cxx/helpers/timezone.h>
+#include <log4cxx/helpers/criticalsection.h>
 #include <locale>
+#include <vector>
 
 namespace log4cxx
 {
 	namespace helpers
 	{
+		/**
+		Formats a date with a strftime pattern, in the time zone
+		identified by <code>timeZone</code> (see helpers::TimeZone). The
+		empty ID stands for the local time zone of the system.
+
+		<p>Besides the strftime conversions, the pattern may contain
+		<b>%Q</b>, <b>%f</b> and <b>%N</b> which are replaced by the
+		milliseconds, microseconds and nanoseconds elapsed in the
+		second, on 3, 6 and 9 digits. <b>%z</b> and <b>%Z</b> give the
+		offset, as +hhmm, and the abbreviation of the time zone of the
+		format, not the ones of the system.
+
+		<p>The pattern is compiled once in a list of fields. The numeric
+		fields are written directly, the other conversions, which depend
+		on the locale, use the <code>time_put</code> facet of the stream.
+		The text of the last second formatted is kept: the next dates of
+		the same second only need their sub-second fields to be written.
+		*/
 		class DateFormat
 		{
 		public:
 			DateFormat(const tstring& dateFormat, const tstring& timeZone = _T(""));
-			virtual void format(tostream& os, time_t time);
+			virtual ~DateFormat() {}
+
+			/** Formats <code>time</code>, in seconds since 01.01.1970. */
+			inline void format(tostream& os, time_t time)
+				{ format(os, time, 0); }
+
+			/**
+			Formats <code>time</code>, in seconds since 01.01.1970, plus
+			<code>microseconds</code>.
+			*/
+			virtual void format(tostream& os, time_t time, long microseconds);
 
 		protected:
-			tstring timeZone;
+			/**
+			Converts <code>time</code> to the local time of the time zone.
+			*/
+			void toLocalTime(time_t time, struct tm& tm);
+
+			/** Compiles #dateFormat in #fields. */
+			void compile();
+
+			/** Formats the fields of the second <code>time</code> in
+			#cachedText. */
+			void formatSecond(time_t time);
+
+			enum FieldType
+			{
+				LITERAL,
+				YEAR,
+				YEAR_OF_CENTURY,
+				MONTH,
+				DAY,
+				DAY_SPACE_PADDED,
+				DAY_OF_YEAR,
+				HOUR,
+				HOUR_12,
+				MINUTE,
+				SECOND,
+				MILLISECOND,
+				MICROSECOND,
+				NANOSECOND,
+				ZONE_OFFSET,
+				ZONE_NAME,
+				LOCALE_DEPENDENT
+			};
+
+			/** Element of a compiled date pattern. */
+			struct Field
+			{
+				FieldType type;
+
+				/** literal text, or the strftime conversion of a
+				LOCALE_DEPENDENT field */
+				tstring text;
+			};
+
+			TimeZonePtr timeZone;
 			tstring dateFormat;
+
+			std::vector<Field> fields;
+			bool localeDependent;
+
+			/** the text of the second #cachedTime, and the position and
+			type of its sub-second fields */
+			time_t cachedTime;
+			bool cacheValid;
+			tstring cachedText;
+			std::vector< std::pair<size_t, FieldType> > subSecondFields;
+
+			/** stream of the LOCALE_DEPENDENT fields, which has the
+			locale of the last stream formatted to */
+			tostringstream facetStream;
+			CriticalSection cacheCs;
 		};
 	}; // namespace helpers
 }; // namespace log4cxx
@@ -92,8 +92,10 @@ namespace log4cxx
 				{ return dateFormatOption; }
 
 		/**
-		The <b>TimeZoneID</b> option is a time zone ID string in the format
-		expected by the <code>locale</code> C++ standard class.
+		The <b>TimeZone</b> option is a time zone ID string in the format
+		expected by helpers::TimeZone#getTimeZone, such as
+		<b>Europe/Paris</b> or <b>GMT+01:00</b>. The default is the local
+		time zone.
 		*/
 			inline void setTimeZone(const tstring& timeZone)
 				{ this->timeZone = timeZone; }
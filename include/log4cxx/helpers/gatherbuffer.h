@@ -0,0 +1,78 @@
+/***************************************************************************
+                          gatherbuffer.h  -  class GatherBuffer
+                             -------------------
+    begin                : lun mai 26 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#ifndef _LOG4CXX_HELPERS_GATHER_BUFFER_H
+#define _LOG4CXX_HELPERS_GATHER_BUFFER_H
+
+#include <log4cxx/helpers/tchar.h>
+#include <log4cxx/helpers/byterange.h>
+#include <vector>
+
+namespace log4cxx
+{
+	namespace helpers
+	{
+		/**
+		Output of a layout made of the text it formats and of
+		references to the large strings of the event, such as its
+		message. The appender writes them with a scatter-gather write,
+		so that these strings are never copied.
+		*/
+		class GatherBuffer
+		{
+		public:
+			GatherBuffer();
+
+			/** Returns the stream receiving the text formatted by the
+			layout. */
+			inline tostream& getStream()
+				{ return stream; }
+
+			/**
+			Appends <code>text</code> to the output. It is referenced
+			rather than copied if it is at least
+			ByteRange#MIN_GATHER_LENGTH bytes long: it must then stay
+			unchanged until the ranges are written.
+			*/
+			void append(const tstring& text);
+
+			/** Returns true if the output references a string. */
+			inline bool hasReferences() const
+				{ return !references.empty(); }
+
+			/**
+			Returns the ranges of the output, in order. They are valid
+			until the buffer is modified.
+			*/
+			const std::vector<ByteRange>& getRanges();
+
+			/** Empties the buffer. */
+			void reset();
+
+		protected:
+			tostringstream stream;
+
+			/** the referenced strings and their position in the text
+			of the stream */
+			std::vector< std::pair<size_t, const tstring *> > references;
+
+			tstring text;
+			std::vector<ByteRange> ranges;
+		};
+	}; // namespace helpers
+}; // namespace log4cxx
+
+#endif //_LOG4CXX_HELPERS_GATHER_BUFFER_H
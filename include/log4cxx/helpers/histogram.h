@@ -0,0 +1,87 @@
+/***************************************************************************
+                          histogram.h  -  class Histogram
+                             -------------------
+    begin                : mer mai 21 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#ifndef _LOG4CXX_HELPERS_HISTOGRAM_H
+#define _LOG4CXX_HELPERS_HISTOGRAM_H
+
+#include <log4cxx/helpers/tchar.h>
+#include <log4cxx/helpers/clock.h>
+
+namespace log4cxx
+{
+	namespace helpers
+	{
+		/**
+		Histogram of durations in microseconds, with logarithmic buckets:
+		bucket 0 counts the durations under 1 microsecond, and bucket
+		<code>i</code> the ones in [2<sup>i-1</sup>, 2<sup>i</sup>[
+		microseconds. The last bucket also counts the longer durations.
+
+		<p>A histogram is not synchronized.
+		*/
+		class Histogram
+		{
+		public:
+			enum { BUCKET_COUNT = 40 };
+
+			Histogram();
+
+			/** Counts a duration. */
+			void record(int64 micros);
+
+			/** Forgets all the recorded durations. */
+			void reset();
+
+			/** Returns the number of recorded durations. */
+			inline long getCount() const
+				{ return count; }
+
+			/** Returns the number of durations in a bucket. */
+			inline long getBucketCount(int bucket) const
+				{ return buckets[bucket]; }
+
+			/** Returns the upper bound of a bucket, in microseconds. */
+			static int64 getBucketLimit(int bucket);
+
+			/** Returns the longest recorded duration. */
+			inline int64 getMax() const
+				{ return max; }
+
+			/** Returns the mean of the recorded durations. */
+			int64 getMean() const;
+
+			/**
+			Returns the upper bound of the bucket which contains the
+			given percentile, a number between 0 and 100.
+			*/
+			int64 getPercentile(int percentile) const;
+
+			/**
+			Returns a summary such as
+			"count=12 mean=3us p50<4us p99<16us max=13us".
+			*/
+			tstring toString() const;
+
+		protected:
+			long buckets[BUCKET_COUNT];
+			long count;
+			int64 total;
+			int64 max;
+		};
+	}; // namespace helpers
+}; // namespace log4cxx
+
+#endif //_LOG4CXX_HELPERS_HISTOGRAM_H
@@ -0,0 +1,61 @@
+/***************************************************************************
+                          interlocked.h  -  class Interlocked
+                             -------------------
+    begin                : lun mai 19 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#ifndef _LOG4CXX_HELPERS_INTERLOCKED_H
+#define _LOG4CXX_HELPERS_INTERLOCKED_H
+
+#include <log4cxx/config.h>
+
+namespace log4cxx
+{
+	namespace helpers
+	{
+		/**
+		Atomic operations on variables shared by several threads.
+
+		<p>These operations do not need any CriticalSection and are used
+		wherever a lock would only protect a single word, such as
+		reference counters or lazily created objects.
+		*/
+		class Interlocked
+		{
+		public:
+			/** Increments <code>value</code> and returns the new value. */
+			static long increment(volatile long * value);
+
+			/** Decrements <code>value</code> and returns the new value. */
+			static long decrement(volatile long * value);
+
+			/** Adds <code>delta</code> to <code>value</code> and returns the
+			new value. */
+			static long add(volatile long * value, long delta);
+
+			/** Stores <code>exchange</code> in <code>dest</code> if
+			<code>dest</code> is equal to <code>comparand</code>. Returns the
+			initial value of <code>dest</code>. */
+			static long compareExchange(volatile long * dest, long exchange,
+				long comparand);
+
+			/** Stores <code>exchange</code> in <code>dest</code> if
+			<code>dest</code> is equal to <code>comparand</code>. Returns the
+			initial value of <code>dest</code>. */
+			static void * compareExchange(void * volatile * dest,
+				void * exchange, void * comparand);
+		};
+	}; // namespace helpers
+}; // namespace log4cxx
+
+#endif //_LOG4CXX_HELPERS_INTERLOCKED_H
@@ -26,12 +26,20 @@ namespace log4cxx
 {
 	namespace helpers
 	{
-		/** Implementation class for Object.*/
+		/** Implementation class for Object.
+
+		<p>The reference count is maintained with Interlocked operations.
+		The critical section and the semaphore are only allocated the first
+		time #lock or #wait/#notify is called: most objects (loggers,
+		layouts, filters, pattern converters...) never use them.
+		*/
 		class ObjectImpl : public virtual Object
 		{
 		public:
 			ObjectImpl();
+			ObjectImpl(const ObjectImpl& object);
 			virtual ~ObjectImpl();
+			ObjectImpl& operator=(const ObjectImpl& object);
 			void addRef();
 			void releaseRef();
 			virtual void lock();
@@ -40,12 +48,15 @@ namespace log4cxx
 			virtual void notify();
 
 		protected:
-			unsigned int ref;
-#ifdef HAVE_PTHREAD_H
-			CriticalSection refCs;
-#endif
-			CriticalSection cs;
-			Semaphore sem;
+			volatile long ref;
+			CriticalSection * volatile cs;
+			Semaphore * volatile sem;
+
+		private:
+			/** Returns the critical section, creating it if needed. */
+			CriticalSection * getCriticalSection();
+			/** Returns the semaphore, creating it if needed. */
+			Semaphore * getSemaphore();
 		};
 	};
 };
@@ -31,6 +31,7 @@ namespace log4cxx
 	namespace helpers
 	{
 		class FormattingInfo;
+		class GatherBuffer;
 
 		class PatternConverter;
 		typedef ObjectPtr<PatternConverter> PatternConverterPtr;
@@ -51,6 +52,11 @@ namespace log4cxx
 			int max;
 			bool leftAlign;
 
+			/** If true, the control characters and invalid sequences
+			in the converted text are escaped, see
+			Transform#appendSanitized. */
+			bool sanitize;
+
 		protected:
 			PatternConverter();
 			PatternConverter(const FormattingInfo& fi);
@@ -69,6 +75,12 @@ namespace log4cxx
 			*/
 			virtual void format(tostream& sbuf, const spi::LoggingEvent& e);
 
+			/**
+			Formats in a GatherBuffer, which may reference the strings of
+			the event. The base class uses #format.
+			*/
+			virtual void gather(GatherBuffer& output, const spi::LoggingEvent& e);
+
 			/**
 			Fast space padding method.
 			*/
@@ -87,6 +87,7 @@ namespace log4cxx
 			public:
 				BasicPatternConverter(const FormattingInfo& formattingInfo, int type);
 				virtual void convert(tostream& sbuf, const spi::LoggingEvent& event);
+				virtual void gather(GatherBuffer& output, const spi::LoggingEvent& event);
 			};
 
 			class LiteralPatternConverter : public PatternConverter
@@ -96,7 +97,7 @@ namespace log4cxx
 
 			public:
 				LiteralPatternConverter(const tstring& value);
-				virtual void format(tostringstream& sbuf, const spi::LoggingEvent& e);
+				virtual void format(tostream& sbuf, const spi::LoggingEvent& e);
 				virtual void convert(tostream& sbuf, const spi::LoggingEvent& event);
 			};
 
@@ -113,13 +114,27 @@ namespace log4cxx
 				virtual void convert(tostream& sbuf, const spi::LoggingEvent& event);
 			};
 
-			class MDCPatternConverter : public PatternConverter
+			/** Writes a typed field of the event, or all of them if the
+			key is empty. */
+			class FieldPatternConverter : public PatternConverter
 			{
 			private:
 				tstring key;
 			
 			public:
-				MDCPatternConverter(const FormattingInfo& formattingInfo, const tstring& key);
+				FieldPatternConverter(const FormattingInfo& formattingInfo, const tstring& key);
+				virtual void convert(tostream& sbuf, const spi::LoggingEvent& event);
+			};
+
+			/** Writes the stack trace of the event, at most maxFrames
+			frames unless it is 0. */
+			class StackTracePatternConverter : public PatternConverter
+			{
+			private:
+				int maxFrames;
+
+			public:
+				StackTracePatternConverter(const FormattingInfo& formattingInfo, int maxFrames);
 				virtual void convert(tostream& sbuf, const spi::LoggingEvent& event);
 			};
 
@@ -0,0 +1,97 @@
+/***************************************************************************
+                          performancecounters.h  -  class PerformanceCounters
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#ifndef _LOG4CXX_HELPERS_PERFORMANCE_COUNTERS_H
+#define _LOG4CXX_HELPERS_PERFORMANCE_COUNTERS_H
+
+#include <log4cxx/helpers/tchar.h>
+#include <log4cxx/helpers/clock.h>
+
+namespace log4cxx
+{
+	namespace helpers
+	{
+		/**
+		Hardware performance counters of the calling thread.
+
+		<p>On Linux, the counters are read with <code>perf_event_open</code>.
+		A counter which the kernel, the processor or the permissions of
+		the process do not allow is not available and its value is -1;
+		on the other systems, no counter is available. The counters only
+		count in user mode.
+
+		<p>An instance counts the events of the thread which created it,
+		between #start and #stop:
+		<pre>
+		PerformanceCounters counters;
+		counters.start();
+		...
+		counters.stop();
+		int64 cycles = counters.getValue(PerformanceCounters::CYCLES);
+		</pre>
+		*/
+		class PerformanceCounters
+		{
+		public:
+			enum Counter
+			{
+				CYCLES,
+				INSTRUCTIONS,
+				BRANCH_MISSES,
+				CACHE_MISSES,
+				COUNTER_COUNT
+			};
+
+			/** Opens the counters for the calling thread. */
+			PerformanceCounters();
+
+			~PerformanceCounters();
+
+			/** Returns true if <code>counter</code> can be read. */
+			inline bool isAvailable(Counter counter) const
+				{ return fds[counter] != -1; }
+
+			/** Resets the counters and starts counting. */
+			void start();
+
+			/** Stops counting and reads the counters. */
+			void stop();
+
+			/**
+			Returns the number of events counted by <code>counter</code>
+			between #start and #stop, or -1 if it is not available. When
+			the kernel had to share the processor counters between more
+			counters, the value is extrapolated from the time during
+			which the counter actually counted.
+			*/
+			inline int64 getValue(Counter counter) const
+				{ return values[counter]; }
+
+			/** Returns the name of <code>counter</code>, such as
+			"cycles". */
+			static const TCHAR * getName(Counter counter);
+
+		private:
+			PerformanceCounters(const PerformanceCounters&);
+			PerformanceCounters& operator=(const PerformanceCounters&);
+
+			int fds[COUNTER_COUNT];
+			int64 values[COUNTER_COUNT];
+		};
+	}; // namespace helpers
+}; // namespace log4cxx
+
+#endif //_LOG4CXX_HELPERS_PERFORMANCE_COUNTERS_H
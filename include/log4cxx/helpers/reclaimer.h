@@ -0,0 +1,93 @@
+/***************************************************************************
+                          reclaimer.h  -  class Reclaimer
+                             -------------------
+    begin                : mer mai 21 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#ifndef _LOG4CXX_HELPERS_RECLAIMER_H
+#define _LOG4CXX_HELPERS_RECLAIMER_H
+
+#include <log4cxx/helpers/objectptr.h>
+#include <log4cxx/helpers/object.h>
+#include <log4cxx/helpers/criticalsection.h>
+#include <log4cxx/helpers/interlocked.h>
+#include <vector>
+
+namespace log4cxx
+{
+	namespace helpers
+	{
+		/**
+		Releases the snapshots of a value which threads read without any
+		lock, once no thread can still be using them.
+
+		<p>A reader calls #enter before it reads the current snapshot and
+		#leave once it no longer uses it. A writer publishes the new
+		snapshot with Interlocked, and then passes the one it replaced to
+		#retire. The retired snapshots are released as soon as no reader
+		is found, by #retire or else by the last reader which leaves: a
+		reader only takes a lock when there are snapshots to release.
+		*/
+		class Reclaimer
+		{
+		public:
+			/** Calls #enter and #leave in a scope. */
+			class Reader
+			{
+			public:
+				Reader(Reclaimer& reclaimer) : reclaimer(reclaimer)
+					{ reclaimer.enter(); }
+				~Reader()
+					{ reclaimer.leave(); }
+
+			protected:
+				Reclaimer& reclaimer;
+			};
+
+			Reclaimer();
+
+			inline void enter()
+				{ Interlocked::increment(&readers); }
+
+			inline void leave()
+			{
+				if (Interlocked::decrement(&readers) == 0 && retiredCount != 0)
+				{
+					reclaim();
+				}
+			}
+
+			/**
+			Keeps <code>snapshot</code>, which is no longer published,
+			until no reader can be using it.
+			*/
+			void retire(Object * snapshot);
+
+			/** Returns the number of snapshots retired but not released
+			yet. */
+			inline long getRetiredCount() const
+				{ return retiredCount; }
+
+		protected:
+			/** Releases the retired snapshots if there is no reader. */
+			void reclaim();
+
+			volatile long readers;
+			volatile long retiredCount;
+			CriticalSection cs;
+			std::vector< ObjectPtr<Object> > retired;
+		}; // class Reclaimer
+	}; // namespace helpers
+}; // namespace log4cxx
+
+#endif //_LOG4CXX_HELPERS_RECLAIMER_H
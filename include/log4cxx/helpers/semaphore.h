@@ -40,6 +40,11 @@ namespace log4cxx
 			Semaphore(int value = 0);
 			~Semaphore();
 			void wait();
+
+			/** Waits at most <code>timeout</code> milliseconds. Returns
+			false if the semaphore was not posted in time. */
+			bool wait(long timeout);
+
 			bool tryWait();
 			void post();
 
@@ -87,6 +87,29 @@ namespace log4cxx
 			size_t write(const void * buf, size_t len)
 				{ return socketImpl->write(buf, len); }
 
+			/** Reads at most <code>len</code> bytes, waiting only if none
+			is available. Returns 0 at the end of the stream.
+			*/
+			size_t readSome(void * buf, size_t len)
+				{ return socketImpl->readSome(buf, len); }
+
+			/** Writes <code>count</code> ranges of bytes, with as few
+			system calls as possible.
+			*/
+			size_t write(const ByteRange * ranges, int count)
+				{ return socketImpl->write(ranges, count); }
+
+			/** Retrieve setting for SO_TIMEOUT.
+			*/
+			int getSoTimeout()
+				{ return socketImpl->getSoTimeout(); }
+
+			/** Enable/disable SO_TIMEOUT with the specified timeout, in
+			milliseconds. It applies to #readSome.
+			*/
+			void setSoTimeout(int timeout)
+				{ socketImpl->setSoTimeout(timeout); }
+
 			/** Closes this socket. */
 			void close()
 				{ socketImpl->close(); }
@@ -21,6 +21,7 @@
 #include <log4cxx/helpers/objectptr.h>
 #include <log4cxx/helpers/inetaddress.h>
 #include <log4cxx/helpers/exception.h>
+#include <log4cxx/helpers/byterange.h>
 
 namespace log4cxx
 {
@@ -137,6 +138,18 @@ namespace log4cxx
 			size_t read(void * buf, size_t len);
 			size_t write(const void * buf, size_t len);
 
+			/** Reads at most <code>len</code> bytes, waiting only if none
+			is available. Returns 0 at the end of the stream. Throws an
+			InterruptedIOException if nothing is received within the
+			SO_TIMEOUT, when it is set.
+			*/
+			size_t readSome(void * buf, size_t len);
+
+			/** Writes <code>count</code> ranges of bytes, with as few
+			system calls as possible.
+			*/
+			size_t write(const ByteRange * ranges, int count);
+
 			/** Retrive setting for SO_TIMEOUT.
 			*/
 			int getSoTimeout();
@@ -48,6 +48,12 @@ namespace log4cxx
 			SocketInputStream(SocketPtr socket, size_t bufferSize);
 			~SocketInputStream();
 
+			/**
+			Maximum number of characters of a string: a longer string is
+			considered as corrupted data.
+			*/
+			static size_t MAX_STRING_LENGTH;
+
 			void read(void * buffer, int len);
 			void read(unsigned int &value);
 			void read(int &value);
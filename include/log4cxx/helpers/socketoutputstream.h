@@ -20,6 +20,8 @@
 #include <log4cxx/helpers/tchar.h>
 #include <log4cxx/helpers/objectimpl.h>
 #include <log4cxx/helpers/objectptr.h>
+#include <log4cxx/helpers/byterange.h>
+#include <vector>
 
 namespace log4cxx
 {
@@ -36,12 +38,27 @@ namespace log4cxx
 		public:
 			SocketOutputStream(SocketPtr socket);
 			~SocketOutputStream();
+
+			/**
+			Maximum number of characters of a string. A longer string is
+			truncated with a marker giving the number of characters
+			removed.
+			*/
+			static size_t MAX_STRING_LENGTH;
 			
 			void write(const void * buffer, int len);
 			void write(unsigned int value);
 			void write(int value);
 			void write(unsigned long value);
 			void write(long value);
+
+			/**
+			Writes the size and the characters of a string, truncated to
+			#MAX_STRING_LENGTH characters. A string of at least
+			ByteRange#MIN_GATHER_LENGTH bytes is referenced rather than
+			copied: it must stay unchanged until the stream is flushed or
+			reset.
+			*/
 			void write(const tstring& value);
 			// some write functions are missing ...
 
@@ -54,6 +71,15 @@ namespace log4cxx
 			*/
 			void flush();
 
+			/** Writes the buffered bytes to another socket, without
+			discarding them: the same data can be sent to several
+			sockets.
+			*/
+			void writeTo(SocketPtr socket);
+
+			/** Discards the buffered bytes. */
+			void reset();
+
 		protected:
 			SocketPtr socket;
 
@@ -67,6 +93,14 @@ namespace log4cxx
 			}*/
 
 			unsigned char * beg, * cur, * end;
+
+			/** the referenced strings and their position in the
+			buffer */
+			std::vector< std::pair<size_t, ByteRange> > references;
+
+			/** Returns the ranges of the buffer and of the referenced
+			strings, in order. */
+			void getRanges(std::vector<ByteRange>& ranges);
 		};
 	}; // namespace helpers
 }; // namespace log4cxx
@@ -0,0 +1,95 @@
+/***************************************************************************
+                          stacktrace.h  -  class StackTrace
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#ifndef _LOG4CXX_HELPERS_STACK_TRACE_H
+#define _LOG4CXX_HELPERS_STACK_TRACE_H
+
+#include <log4cxx/helpers/tchar.h>
+
+namespace log4cxx
+{
+	namespace helpers
+	{
+		/**
+		The return addresses of a thread, captured when an event is
+		created and symbolized only when the event is formatted.
+
+		<p>Capturing only walks the stack into a fixed array, which
+		costs a few microseconds. Finding the symbols costs much more:
+		it is done by the thread which formats the event, such as the
+		dispatcher of an AsyncAppender, and each address is looked up
+		once, then cached.
+
+		<p>A trace received from another process is made of the text
+		formatted by the sender, since the addresses are only meaningful
+		in the process which captured them.
+		*/
+		class StackTrace
+		{
+		public:
+			enum { MAX_FRAMES = 32 };
+
+			/** An empty trace. */
+			StackTrace();
+
+			/** A trace formatted by another process. */
+			StackTrace(const tstring& text);
+
+			/**
+			Captures the return addresses of the calling thread, except
+			this method and the <code>skip</code> frames which called
+			it.
+			*/
+			void capture(int skip);
+
+			/** Returns the number of captured addresses. */
+			inline int getFrameCount() const
+				{ return frameCount; }
+
+			inline void * getFrame(int index) const
+				{ return frames[index]; }
+
+			/**
+			Writes each frame, at most <code>maxFrames</code> of them
+			unless it is 0, on a line of its own which starts with a
+			line separator and a tabulation.
+			*/
+			void format(tostream& os, int maxFrames = 0) const;
+
+			/** Returns all the frames formatted by #format. */
+			tstring toString() const;
+
+			/**
+			Returns the symbol of <code>address</code>, with the offset
+			of the address in it and the module which contains it. It is
+			computed once for each address.
+			*/
+			static tstring getSymbol(void * address);
+
+			/** Returns the number of addresses whose symbol is cached. */
+			static long getCachedSymbolCount();
+
+		protected:
+			void * frames[MAX_FRAMES];
+			int frameCount;
+
+			/** the frames formatted by another process */
+			tstring text;
+		}; // class StackTrace
+	}; // namespace helpers
+}; // namespace log4cxx
+
+#endif //_LOG4CXX_HELPERS_STACK_TRACE_H
@@ -55,6 +55,35 @@ namespace log4cxx
             static bool equalsIgnoreCase(const tstring& s1, const tstring& s2)
             {
 				return toLowerCase(s1) == toLowerCase(s2);
+            }
+
+			/**
+			Copies the <code>maxLength</code> first characters of
+			<code>s</code> to <code>result</code>, the last ones being
+			replaced by a marker giving the number of characters removed.
+			*/
+            static void truncate(const tstring& s, size_t maxLength,
+				tstring& result)
+            {
+				// the room of the marker is the one needed for the
+				// largest number of characters removed
+				tostringstream os;
+				os << _T("...[") << s.size() << _T(" characters truncated]");
+				size_t markerLength = os.str().size();
+
+				if (markerLength >= maxLength)
+				{
+					result.assign(s, 0, maxLength);
+					return;
+				}
+
+				size_t kept = maxLength - markerLength;
+				os.str(tstring());
+				os << _T("...[") << s.size() - kept << _T(" characters truncated]");
+
+				result.reserve(maxLength);
+				result.assign(s, 0, kept);
+				result += os.str();
             }
         };
     };
@@ -68,6 +68,7 @@ public:
 	#define W2T(src) src
 	#define tostringstream std::wostringstream
 	#define ttol wcstol
+	#define tcstod wcstod
 #else // Not UNICODE
 	#include <ctype.h>
 	#define _T(x) x
@@ -90,6 +91,7 @@ public:
 	#define W2T(src) W2A(src)
 	#define tostringstream std::ostringstream
 	#define ttol atol
+	#define tcstod strtod
 #endif // UNICODE
 
 #endif //_LOG4CXX_HELPERS_TCHAR_H
@@ -76,6 +76,11 @@ namespace log4cxx
 			*/
 			static void sleep(long millis);
 
+			/** Causes the currently executing thread to give up the
+			processor to another thread ready to run, if any.
+			*/
+			static void yield();
+
 			/** Causes this thread to begin execution;
 			calls the run method of this thread.
 			*/
@@ -0,0 +1,210 @@
+/***************************************************************************
+                          timezone.h  -  class TimeZone
+                             -------------------
+    begin                : dim mai 25 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#ifndef _LOG4CXX_HELPERS_TIME_ZONE_H
+#define _LOG4CXX_HELPERS_TIME_ZONE_H
+
+#include <log4cxx/helpers/tchar.h>
+#include <log4cxx/helpers/objectimpl.h>
+#include <log4cxx/helpers/objectptr.h>
+#include <log4cxx/helpers/criticalsection.h>
+#include <log4cxx/helpers/clock.h>
+#include <vector>
+#include <time.h>
+
+namespace log4cxx
+{
+	namespace helpers
+	{
+		class TimeZone;
+		typedef ObjectPtr<TimeZone> TimeZonePtr;
+
+		/**
+		Offset of the local time of a region to UTC, with its daylight
+		saving time transitions.
+
+		<p>A time zone is identified by:
+		<ul>
+		<li>an empty string for the local time zone of the system,
+		<li><b>GMT</b> or <b>UTC</b>,
+		<li>a custom ID in the form <b>GMT+hh:mm</b> or <b>GMT-hh:mm</b>,
+		<li>the name of a zoneinfo file, such as <b>Europe/Paris</b>,
+		<li>or a POSIX TZ string, such as <b>CET-1CEST,M3.5.0,M10.5.0/3</b>.
+		</ul>
+
+		<p>The offset is constant between two transitions: the one in
+		effect at a given time is kept with the bounds of this period,
+		so that most conversions only need a comparison. Time zones are
+		shared by all the date formats which use them and may be used by
+		several threads at the same time.
+		*/
+		class TimeZone : public ObjectImpl
+		{
+		public:
+			virtual ~TimeZone();
+
+			/**
+			Returns the time zone identified by <code>id</code>. An unknown
+			ID is reported with LogLog and gives the GMT time zone.
+			*/
+			static TimeZonePtr getTimeZone(const tstring& id);
+
+			/** Returns the local time zone of the system. */
+			static TimeZonePtr getDefault();
+
+			/** Returns the ID used to get this time zone. */
+			inline const tstring& getID() const
+				{ return id; }
+
+			/**
+			Returns the number of seconds to add to UTC to get the local
+			time at <code>time</code>.
+			*/
+			inline long getOffset(time_t time)
+			{
+				const Period * p = current;
+				if (p != 0 && time >= p->begin && time < p->end)
+				{
+					return p->offset;
+				}
+
+				Period period;
+				findPeriod(time, period);
+				return period.offset;
+			}
+
+			/**
+			Returns true if daylight saving time is in effect at
+			<code>time</code>.
+			*/
+			bool inDaylightTime(time_t time);
+
+			/**
+			Returns the abbreviation of the local time at
+			<code>time</code>, such as <b>CEST</b>, or <b>GMT+hh:mm</b>
+			if the time zone does not name it.
+			*/
+			tstring getAbbreviation(time_t time);
+
+		protected:
+			/** Index of #names standing for no abbreviation. */
+			enum { NO_NAME = -1 };
+
+			/** Time interval with a constant offset. */
+			struct Period
+			{
+				int64 begin;
+				int64 end;
+				long offset;
+				bool isDst;
+
+				/** index of the abbreviation in #names */
+				int name;
+			};
+
+			/** Day of a transition of a POSIX TZ rule. */
+			struct RuleDate
+			{
+				/** 'J': day 1 to 365 without February 29,
+				'D': day 0 to 365, 'M': week of a month. */
+				int type;
+				int day;
+				int week;
+				int month;
+
+				/** seconds after midnight, local time */
+				long time;
+			};
+
+			/** Offset of a local time type of a zoneinfo file. */
+			struct LocalTimeType
+			{
+				long offset;
+				bool isDst;
+				int name;
+			};
+
+			TimeZone(const tstring& id);
+
+			/** Loads the zoneinfo file <code>name</code>, or parses it as
+			a POSIX TZ string if there is no such file. */
+			bool load(const std::string& name);
+
+			/** Loads a zoneinfo file. Returns false if it could not be
+			read. */
+			bool loadFile(const std::string& fileName);
+
+			/** Parses a POSIX TZ string. Returns false if it is
+			malformed. */
+			bool parseRule(const std::string& rule);
+
+			/** Parses a GMT+hh:mm ID. Returns false if it is not one. */
+			bool parseCustomID(const tstring& id);
+
+			/** Returns the index of <code>name</code> in #names, adding
+			it if needed. */
+			int addName(const tstring& name);
+
+			/** Copies the period containing <code>time</code>, from the
+			periods already computed if possible. */
+			void findPeriod(time_t time, Period& period);
+
+			/** Computes the period containing <code>time</code>. */
+			void computePeriod(int64 time, Period& period) const;
+
+			/** Computes the period of the POSIX rule containing
+			<code>time</code>. */
+			void computeRulePeriod(int64 time, Period& period) const;
+
+			/** Returns the time a rule date occurs in the year, in
+			seconds from 01.01 00:00 local time. */
+			static int64 getRuleTime(int year, const RuleDate& date);
+
+			tstring id;
+
+			/** transitions of the zoneinfo file */
+			std::vector<int64> transitionTimes;
+			std::vector<unsigned char> transitionTypes;
+			std::vector<LocalTimeType> localTimeTypes;
+
+			/** POSIX rule used after the last transition */
+			bool hasRule;
+			long stdOffset;
+			long dstOffset;
+			bool hasDst;
+			RuleDate dstStart;
+			RuleDate dstEnd;
+			int stdName;
+			int dstName;
+
+			/** abbreviations of the local times, only changed while
+			the time zone is loaded */
+			std::vector<tstring> names;
+
+			/** the periods already computed, which are never deleted
+			while the time zone is alive so that #current stays
+			valid */
+			std::vector<Period *> periods;
+			CriticalSection periodsCs;
+			const Period * volatile current;
+
+			/** maximum number of periods kept by a time zone */
+			enum { MAX_PERIODS = 256 };
+		};
+	}; // namespace helpers
+}; // namespace log4cxx
+
+#endif //_LOG4CXX_HELPERS_TIME_ZONE_H
@@ -61,6 +61,28 @@ namespace log4cxx
 			*/
 			static void appendEscapingCDATA(
 				tostream& buf, const tstring& input);
+
+			/**
+			Returns the number of characters at the start of
+			<code>input</code> which are neither control characters nor,
+			unless UNICODE is defined, bytes of a multibyte sequence. The
+			scan checks 32 bytes at a time with SSE2 when it is available.
+			*/
+			static size_t scanSafe(const TCHAR * input, size_t length);
+
+			/**
+			Appends <code>input</code> to <code>buf</code>, escaping the
+			control characters other than tab: CR and LF are written as
+			\\r and \\n, the others, such as ESC, as \\xHH. Unless
+			UNICODE is defined, the string is expected to be in UTF-8 and
+			each invalid sequence is replaced with U+FFFD. The safe runs
+			found by #scanSafe are copied as a whole.
+
+			@param buf output stream where to write the sanitized string.
+			@param input The text to be sanitized.
+			*/
+			static void appendSanitized(
+				tostream& buf, const tstring& input);
 		}; // class Transform
 	}; // namespace helpers
 }; //namespace log4cxx
@@ -23,6 +23,7 @@
 #include <map>
 #include <log4cxx/provisionnode.h>
 #include <log4cxx/helpers/objectimpl.h>
+#include <log4cxx/helpers/arena.h>
 
 namespace log4cxx
 {
@@ -60,6 +61,14 @@ namespace log4cxx
 		public virtual helpers::ObjectImpl
 	{
 	private:
+		/**
+		The loggers created by the default factory are allocated from
+		this arena: they are close to each other in memory. Each logger
+		is still destroyed on its own, but its memory is released in a few
+		chunks once the hierarchy and all its loggers are gone.
+		*/
+		helpers::ArenaPtr arena;
+
         spi::LoggerFactoryPtr defaultFactory;
 		spi::HierarchyEventListenerList listeners;
 		
@@ -77,6 +86,15 @@ namespace log4cxx
         bool emittedNoAppenderWarning;
         bool emittedNoResourceBundleWarning;
 
+		/**
+		Number of loggers above which unused loggers are reclaimed, 0
+		if they are never reclaimed automatically.
+		*/
+		int reclaimThreshold;
+
+		/** Number of loggers which triggers the next reclaim. */
+		int nextReclaim;
+
         /**
         Map synchronization
         */
@@ -118,6 +136,34 @@ namespace log4cxx
 		*/
 	public:
 		LoggerPtr exists(const tstring& name);
+
+		/**
+		Removes from this hierarchy the loggers which are not used: the
+		ones which have no appender, no level, the default additivity
+		and which are not referenced outside of this hierarchy, neither
+		by the application nor as the parent of another logger.
+
+		<p>This is meant for applications which create loggers with
+		dynamic names, like one logger per session, that would make the
+		hierarchy grow forever. A reclaimed logger is created again the
+		next time it is retrieved.
+
+		@return the number of loggers removed.
+		*/
+	public:
+		int reclaimUnusedLoggers();
+
+		/**
+		Enables the automatic reclaim of unused loggers: when the number
+		of loggers goes over <code>threshold</code>, #reclaimUnusedLoggers
+		is called by #getLogger. The next reclaim happens when the number
+		of loggers has doubled, so that its cost is amortized.
+
+		@param threshold The number of loggers above which unused loggers
+		are reclaimed, 0 (the default) to disable the automatic reclaim.
+		*/
+	public:
+		void setReclaimThreshold(int threshold);
 		
 		/**
 		The string form of {@link #setThreshold(const Level&) setThreshold}.
@@ -279,6 +325,20 @@ namespace log4cxx
 	private:
 
 		void updateChildren(ProvisionNode& pn, LoggerPtr logger);
+
+		/**
+		Reclaims the unused loggers. Must be called with the map lock
+		held.
+		*/
+	private:
+		int reclaim();
+
+		/**
+		Returns <code>true</code> and removes <code>logger</code> from the
+		provision nodes of its missing ancestors if it can be reclaimed.
+		*/
+	private:
+		bool removeIfUnused(Logger * logger);
 	};
 }; //namespace log4cxx
 
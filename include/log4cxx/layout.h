@@ -31,6 +31,11 @@ namespace log4cxx
 		class LoggingEvent;
     };
 
+	namespace helpers
+	{
+		class GatherBuffer;
+	};
+
 	/**
 	Extend this abstract class to create your own log layout format.
 	*/
@@ -46,6 +51,16 @@ namespace log4cxx
 		*/
 		virtual void format(tostream& output, const spi::LoggingEvent& event) = 0;
 
+		/**
+		Formats the event like #format, in a helpers::GatherBuffer
+		which references the large strings of the event rather than
+		copying them. Returns <code>false</code> if the layout does not
+		support it, which is the case of the base class: the appender
+		then uses #format.
+		*/
+		virtual bool gather(helpers::GatherBuffer&,
+			const spi::LoggingEvent&) { return false; }
+
 		/**
 		Returns the content type output by this layout. The base class
 		returns "text/plain".
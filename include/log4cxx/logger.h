@@ -24,6 +24,9 @@
 #include <log4cxx/spi/loggerrepository.h>
 #include <log4cxx/helpers/appenderattachableimpl.h>
 #include <log4cxx/helpers/objectimpl.h>
+#include <log4cxx/helpers/arena.h>
+#include <log4cxx/helpers/reclaimer.h>
+#include <log4cxx/fields.h>
 
 namespace log4cxx
 {
@@ -51,6 +54,64 @@ namespace log4cxx
     public:
 
     protected:
+		/**
+		Appenders reached by a logging request on a logger: its own
+		appenders and the ones of its ancestors, up to the first logger
+		whose additivity flag is <code>false</code>.
+
+		<p>A snapshot is read without any lock. Its appenders never
+		change: when the configuration changes but not the appenders, it
+		is only given the new generation.
+		*/
+		class AppenderSnapshot : public virtual helpers::ObjectImpl
+		{
+		public:
+			/** Generation this snapshot is valid for. */
+			volatile long generation;
+			AppenderList appenders;
+		};
+		typedef helpers::ObjectPtr<AppenderSnapshot> AppenderSnapshotPtr;
+
+		/**
+		State read by every logging request. It is only written when the
+		configuration changes, and is kept on its own cache line, away
+		from the reference count and the lock of ObjectImpl which are
+		written each time a LoggerPtr is copied.
+		*/
+		struct DispatchState
+		{
+			/** Generation #threshold and #effectiveLevel were computed
+			for. */
+			volatile long generation;
+
+			/** Lowest level enabled for this logger: the greater of the
+			effective level and the threshold of the repository. */
+			volatile int threshold;
+
+			/** Level returned by #getEffectiveLevel. */
+			const Level * volatile effectiveLevel;
+
+			/**
+			The parent of this logger. All loggers have at least one
+			ancestor which is the root logger. */
+			LoggerPtr parent;
+
+			/** Appenders called by #callAppenders, built on demand and
+			owned by #appenderSnapshot. */
+			AppenderSnapshot * volatile appenders;
+		};
+
+		DispatchState dispatch;
+		char dispatchPadding[LOG4CXX_CACHE_LINE_SIZE - sizeof(DispatchState)];
+
+		/**
+		Incremented each time a level, a threshold, an appender, an
+		additivity flag or a parent changes in any logger: the dispatch
+		state of a logger is valid only if its generation is equal to
+		this one.
+		*/
+		static volatile long generation;
+
         /**
         The name of this logger.
         */
@@ -62,11 +123,6 @@ namespace log4cxx
         which case it is inherited form the hierarchy.  */
         const Level * level;
 
-        /**
-        The parent of this logger. All loggers have at least one
-        ancestor which is the root logger. */
-        LoggerPtr parent;
-
         // Loggers need to know what Hierarchy they are in
         spi::LoggerRepository * repository;
 
@@ -78,6 +134,16 @@ namespace log4cxx
         have their additivity flag set to <code>false</code> too. See
         the user manual for more details. */
         bool additive;
+
+		/** The published snapshot of the appenders. It is only replaced
+		when the appenders reached by the logger change. */
+		AppenderSnapshotPtr appenderSnapshot;
+
+		/**
+		Keeps the replaced snapshots until no thread is still in
+		#callAppenders with them, since they are read without any lock.
+		*/
+		helpers::Reclaimer snapshots;
        
 	/**
         This constructor created a new <code>logger</code> instance and
@@ -94,6 +160,21 @@ namespace log4cxx
 
     public:
 		~Logger();
+
+		/**
+		Loggers are allocated on a cache line boundary, so that their
+		dispatch state does not share a cache line with another object.
+		*/
+		static void * operator new(size_t size);
+
+		/**
+		Allocates a logger from <code>arena</code>, or from the heap if
+		<code>arena</code> is null.
+		*/
+		static void * operator new(size_t size, helpers::Arena * arena);
+
+		static void operator delete(void * p);
+		static void operator delete(void * p, helpers::Arena * arena);
 		
         /**
         Add <code>newAppender</code> to the list of appenders of this
@@ -133,6 +214,23 @@ namespace log4cxx
         @param event the event to log.  */
         void callAppenders(const spi::LoggingEvent& event);
 
+        /**
+        Remove all previously added appenders from this Logger
+        instance.
+        */
+		virtual void removeAllAppenders();
+
+        /**
+        Remove the appender passed as parameter form the list of appenders.
+        */
+		virtual void removeAppender(AppenderPtr appender);
+
+        /**
+        Remove the appender with the name passed as parameter form the
+        list of appenders.
+        */
+		virtual void removeAppender(const tstring& name);
+
         /**
         Close all attached appenders implementing the AppenderAttachable
         interface.
@@ -199,6 +297,12 @@ namespace log4cxx
         void forcedLog(const Level& level, const tstring& message, 
 			const char* file=0, int line=-1);
 
+        /**
+        Like #forcedLog, with typed fields attached to the event.
+		*/
+        void forcedLog(const Level& level, const tstring& message,
+			const Fields& fields, const char* file=0, int line=-1);
+
 
         /**
         Get the additivity flag for this Logger instance.
@@ -366,18 +470,96 @@ namespace log4cxx
         void log(const Level& level, const tstring& message,
 			const char* file=0, int line=-1);
 
+        /**
+        Logs a message with typed fields, which are not converted to
+        text by the calling thread. See Fields.
+
+        @param level The level of the logging request.
+        @param message The message of the logging request.
+        @param fields The fields of the logging request.
+        @param file The source file of the logging request, may be null.
+        @param line The number line of the logging request.  */
+        void log(const Level& level, const tstring& message,
+			const Fields& fields, const char* file=0, int line=-1);
+
         /**
         Set the additivity flag for this Logger instance.
          */
     public:
         void setAdditivity(bool additive);
 
+		/**
+		Makes all the loggers call <code>target</code> instead of
+		<code>appender</code>, or <code>appender</code> again if
+		<code>target</code> is null.
+
+		<p>The appender lists of the loggers are not modified: the
+		substitution is made when the appenders called by a logger are
+		collected again, which happens in all the loggers at once after
+		this call.
+
+		<p>If <code>equivalent</code>, or <code>target</code> when
+		<code>equivalent</code> is null, is already called by a logger,
+		<code>appender</code> is only removed from it: this avoids
+		appending events twice when <code>target</code> forwards them to
+		another appender.
+		*/
+		static void redirectAppender(AppenderPtr appender, AppenderPtr target,
+			AppenderPtr equivalent = 0);
+
     protected:
         friend class Hierarchy;
         /**
         Only the Hierarchy class can set the hierarchy of a logger.*/
         void setHierarchy(spi::LoggerRepository * repository);
 
+		/**
+		Invalidates the dispatch state of all the loggers. Must be called
+		after any change which may modify the effective level or the
+		appenders of a logger.
+		*/
+		static void invalidateDispatchState();
+
+		/**
+		Computes the effective level and the threshold of this logger
+		again if the configuration changed since they were computed.
+		*/
+		inline void checkDispatchState()
+		{
+			if (dispatch.generation != generation)
+			{
+				updateDispatchState();
+			}
+		}
+
+		void updateDispatchState();
+
+		/**
+		Returns the appenders called by #callAppenders, without any lock
+		unless the configuration changed since they were built. The
+		caller must be a reader of #snapshots while it uses them.
+		*/
+		inline AppenderSnapshot * getAppenderSnapshot()
+		{
+			AppenderSnapshot * snapshot = dispatch.appenders;
+			if (snapshot != 0 && snapshot->generation == generation)
+			{
+				return snapshot;
+			}
+
+			return updateAppenderSnapshot();
+		}
+
+		/** Builds the appenders called by #callAppenders again. */
+		AppenderSnapshot * updateAppenderSnapshot();
+
+		/** Applies the redirections of #redirectAppender to a list of
+		appenders. */
+		static void redirectAppenders(AppenderList& appenders);
+
+		/** Number of appenders redirected by #redirectAppender. */
+		static volatile long redirections;
+
         /**
         Set the level of this Logger. If you are passing any of
         <code>Level#DEBUG</code>, <code>Level#INFO</code>,
@@ -441,4 +623,10 @@ namespace log4cxx
 	oss << message; \
 	logger->fatal(oss.str(), __FILE__, __LINE__); }}
 
+#define LOG4CXX_LOG_FIELDS(logger, level, message, fields) { \
+	if (logger->isEnabledFor(level)) {\
+	tostringstream oss; \
+	oss << message; \
+	logger->log(level, oss.str(), fields, __FILE__, __LINE__); }}
+
 #endif //_LOG4CXX_LOGGER_H
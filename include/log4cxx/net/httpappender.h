@@ -0,0 +1,372 @@
+/***************************************************************************
+                          httpappender.h  -  class HTTPAppender
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#ifndef _LOG4CXX_NET_HTTP_APPENDER_H
+#define _LOG4CXX_NET_HTTP_APPENDER_H
+
+#include <log4cxx/appenderskeleton.h>
+#include <log4cxx/helpers/socket.h>
+#include <log4cxx/helpers/thread.h>
+#include <log4cxx/helpers/criticalsection.h>
+#include <log4cxx/helpers/semaphore.h>
+#include <log4cxx/helpers/clock.h>
+#include <deque>
+#include <vector>
+#include <string>
+
+namespace log4cxx
+{
+	namespace net
+	{
+		class HTTPAppender;
+		typedef helpers::ObjectPtr<HTTPAppender> HTTPAppenderPtr;
+
+		/**
+		Sends the events formatted by its layout to an HTTP endpoint, such
+		as the bulk API of a log collector, in <code>POST</code> requests
+		holding several events.
+
+		<p>The events are formatted by the thread which logs them and
+		queued. A background thread sends them in batches: a request is
+		sent when <b>BatchSize</b> events or <b>BatchBytes</b> bytes are
+		waiting, or when the first waiting event has been queued for
+		<b>LingerTime</b> milliseconds. The body of a request is the
+		concatenation of the formatted events, so the layout must produce
+		the format expected by the endpoint, such as one JSON document
+		per line.
+
+		<p>The connection is kept alive from one request to the next. The
+		body is compressed with gzip if <b>Compression</b> is set to
+		<code>gzip</code> and log4cxx was built with zlib. A request which
+		fails because of the network, a timeout or a 408, 429 or 5xx
+		response is sent again up to <b>MaxRetries</b> times, waiting
+		<b>RetryDelay</b> milliseconds before the first retry and twice as
+		long before each of the next ones. The events of a request which
+		still fails, or which is rejected with another status, are
+		dropped. Until a request succeeds again, the next requests are
+		not retried, so that an unreachable endpoint does not hold up
+		the queue.
+
+		<p>The logging threads never wait for the network: when
+		<b>BufferSize</b> events are already waiting, new events are
+		dropped. The dropped events are counted, see
+		#getDroppedEventCount.
+
+		<p>When the appender is closed, the waiting events are sent
+		before #close returns.
+
+		<p>Only the <code>http</code> scheme is supported, as in
+		<code>http://localhost:9200/_bulk</code>.
+		*/
+		class HTTPAppender : public AppenderSkeleton
+		{
+		public:
+			/** The default maximum number of events per request, 512. */
+			static int DEFAULT_BATCH_SIZE;
+
+			/** The default maximum size of a request body, 1 MB. */
+			static int DEFAULT_BATCH_BYTES;
+
+			/** The default linger time, 1000 milliseconds. */
+			static int DEFAULT_LINGER_TIME;
+
+			/** The default maximum number of waiting events, 8192. */
+			static int DEFAULT_BUFFER_SIZE;
+
+			/** The default number of retries of a failed request, 3. */
+			static int DEFAULT_MAX_RETRIES;
+
+			/** The default delay before the first retry, 100
+			milliseconds. */
+			static int DEFAULT_RETRY_DELAY;
+
+			/** The longest delay between two retries, 30 seconds. */
+			static int MAX_RETRY_DELAY;
+
+			/** The default time to wait for a response, 10 seconds. */
+			static int DEFAULT_TIMEOUT;
+
+			HTTPAppender();
+
+			/** Sends the events formatted by <code>layout</code> to
+			<code>url</code>. */
+			HTTPAppender(LayoutPtr layout, const tstring& url);
+
+			~HTTPAppender();
+
+			/**
+			Parses the <b>URL</b> and starts the sender thread.
+			*/
+			void activateOptions();
+
+			/**
+			Set options
+			*/
+			void setOption(const tstring& option, const tstring& value);
+
+			/**
+			Sends the waiting events and stops the sender thread.
+			*/
+			void close();
+
+			/**
+			The HTTPAppender requires a layout. Hence, this method
+			returns <code>true</code>.
+			*/
+			bool requiresLayout()
+				{ return true; }
+
+			/**
+			The <b>URL</b> option takes the URL the requests are sent to,
+			such as <code>http://localhost:9200/_bulk</code>.
+			*/
+			inline void setURL(const tstring& url)
+				{ this->url = url; }
+
+			/** Returns value of the <b>URL</b> option. */
+			inline const tstring& getURL() const
+				{ return url; }
+
+			/**
+			The <b>ContentType</b> option takes the media type of the
+			request bodies. It is <code>application/x-ndjson</code> by
+			default.
+			*/
+			inline void setContentType(const tstring& contentType)
+				{ this->contentType = contentType; }
+
+			/** Returns value of the <b>ContentType</b> option. */
+			inline const tstring& getContentType() const
+				{ return contentType; }
+
+			/**
+			The <b>BatchSize</b> option takes the maximum number of events
+			sent in a request.
+			*/
+			inline void setBatchSize(int batchSize)
+				{ this->batchSize = batchSize; }
+
+			/** Returns value of the <b>BatchSize</b> option. */
+			inline int getBatchSize() const
+				{ return batchSize; }
+
+			/**
+			The <b>BatchBytes</b> option takes the maximum size of a
+			request body before compression. A larger event is sent
+			alone.
+			*/
+			inline void setBatchBytes(int batchBytes)
+				{ this->batchBytes = batchBytes; }
+
+			/** Returns value of the <b>BatchBytes</b> option. */
+			inline int getBatchBytes() const
+				{ return batchBytes; }
+
+			/**
+			The <b>LingerTime</b> option takes the longest time, in
+			milliseconds, an event waits for other events before a
+			request is sent.
+			*/
+			inline void setLingerTime(int lingerTime)
+				{ this->lingerTime = lingerTime; }
+
+			/** Returns value of the <b>LingerTime</b> option. */
+			inline int getLingerTime() const
+				{ return lingerTime; }
+
+			/**
+			The <b>BufferSize</b> option takes the maximum number of events
+			waiting to be sent.
+			*/
+			inline void setBufferSize(int bufferSize)
+				{ this->bufferSize = bufferSize; }
+
+			/** Returns value of the <b>BufferSize</b> option. */
+			inline int getBufferSize() const
+				{ return bufferSize; }
+
+			/**
+			The <b>Compression</b> option takes <code>gzip</code> or
+			<code>none</code>, the default.
+			*/
+			void setCompression(bool compression);
+
+			/** Returns true if the request bodies are compressed. */
+			inline bool getCompression() const
+				{ return compression; }
+
+			/**
+			The <b>MaxRetries</b> option takes the number of times a failed
+			request is sent again.
+			*/
+			inline void setMaxRetries(int maxRetries)
+				{ this->maxRetries = maxRetries; }
+
+			/** Returns value of the <b>MaxRetries</b> option. */
+			inline int getMaxRetries() const
+				{ return maxRetries; }
+
+			/**
+			The <b>RetryDelay</b> option takes the delay, in milliseconds,
+			before the first retry of a failed request.
+			*/
+			inline void setRetryDelay(int retryDelay)
+				{ this->retryDelay = retryDelay; }
+
+			/** Returns value of the <b>RetryDelay</b> option. */
+			inline int getRetryDelay() const
+				{ return retryDelay; }
+
+			/**
+			The <b>Timeout</b> option takes the time, in milliseconds, to
+			wait for each part of a response.
+			*/
+			inline void setTimeout(int timeout)
+				{ this->timeout = timeout; }
+
+			/** Returns value of the <b>Timeout</b> option. */
+			inline int getTimeout() const
+				{ return timeout; }
+
+			/** Returns the number of events accepted by the endpoint. */
+			inline long getSentEventCount() const
+				{ return sentEvents; }
+
+			/** Returns the number of events dropped because the buffer was
+			full or their request failed. */
+			inline long getDroppedEventCount() const
+				{ return droppedEvents; }
+
+			/** Returns the number of requests sent again. */
+			inline long getRetryCount() const
+				{ return retries; }
+
+			/** Returns the number of requests accepted by the endpoint. */
+			inline long getRequestCount() const
+				{ return requests; }
+
+		protected:
+			/**
+			Formats the event and queues it for the sender thread.
+			*/
+			void append(const spi::LoggingEvent& event);
+
+			/**
+			Takes the next batch from the queue, waiting until it is
+			complete or has lingered enough. Returns false when the
+			appender is closed and the queue is empty.
+			*/
+			bool nextBatch(std::vector<tstring>& batch);
+
+			/**
+			Sends a batch, retrying as configured. Called by the sender
+			thread only.
+			*/
+			void send(std::vector<tstring>& batch);
+
+			/**
+			Sends a request on the connection, opening it if needed, and
+			returns the status of the response. Throws an
+			helpers::IOException if the connection fails.
+			*/
+			int exchange(const std::string& request);
+
+			/**
+			Compresses <code>body</code> in place.
+			*/
+			void compress(std::string& body);
+
+			/** Closes the connection, if any. */
+			void disconnect();
+
+			tstring url;
+			tstring contentType;
+			int batchSize;
+			int batchBytes;
+			int lingerTime;
+			int bufferSize;
+			bool compression;
+			int maxRetries;
+			int retryDelay;
+			int timeout;
+
+			/** Parts of the #url. */
+			tstring host;
+			int port;
+			tstring path;
+
+			/** Formats the events, protected by the appender lock. */
+			tostringstream formatStream;
+
+			/** Formatted events waiting to be sent, protected by
+			#queueCs. */
+			std::deque<tstring> queue;
+
+			/** Total length of the events in #queue. */
+			size_t queueBytes;
+
+			/** Time at which the first event of #queue was queued, in
+			microseconds. */
+			helpers::int64 firstQueued;
+
+			/** Set by #close, protected by #queueCs. */
+			bool closing;
+
+			helpers::CriticalSection queueCs;
+
+			/** Posted when the queue becomes non-empty, when a batch is
+			complete and on #close. */
+			helpers::Semaphore wakeUp;
+
+			/** Posted when the sender thread ends. */
+			helpers::Semaphore senderEnded;
+
+			bool senderStarted;
+
+			/** Connection, used by the sender thread only. */
+			helpers::SocketPtr socket;
+
+			/** Deflate state, used by the sender thread only. */
+			void * zstream;
+
+			/** Set when a request failed after all its retries, used by
+			the sender thread only. */
+			bool failing;
+
+			volatile long sentEvents;
+			volatile long droppedEvents;
+			volatile long retries;
+			volatile long requests;
+
+		private:
+			/** Runs the sender thread. */
+			class Sender :
+				public helpers::Runnable,
+				public helpers::ObjectImpl
+			{
+			private:
+				HTTPAppender * appender;
+
+			public:
+				Sender(HTTPAppender * appender);
+				void run();
+			}; // class Sender
+			friend class Sender;
+		}; // class HTTPAppender
+	}; // namespace net
+}; // namespace log4cxx
+
+#endif // _LOG4CXX_NET_HTTP_APPENDER_H
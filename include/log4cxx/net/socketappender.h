@@ -52,6 +52,11 @@ namespace log4cxx
         serialized {@link spi::LoggingEvent LoggingEvent} object
 		to the server side.
 
+        <p><li>The stack trace of an event is symbolized when it is sent,
+        since its addresses are only meaningful in this process. Attach
+        the SocketAppender to an AsyncAppender so that this is done by
+        the dispatcher rather than by the logging thread.
+
         <p><li>Remote logging uses the TCP protocol. Consequently, if
         the server is reachable, then log events will eventually arrive
         at the server.
@@ -21,10 +21,13 @@
 #include <log4cxx/helpers/socket.h>
 #include <log4cxx/helpers/thread.h>
 #include <vector>
-#include <log4cxx/helpers/socket.h>
+#include <map>
+#include <log4cxx/helpers/semaphore.h>
 
 namespace log4cxx
 {
+	class Level;
+
 	namespace helpers
 	{
 		class SocketOutputStream;
@@ -93,6 +96,17 @@ namespace log4cxx
 
 		link.
 
+		<p><li>A client can restrict the events it receives by sending a
+		list of logger names and levels with #subscribe, at any time
+		after connecting: it then only receives the events of these
+		loggers and of their descendants whose level is at least the
+		one of the subscription. A client which sends no subscription
+		receives all the events. The subscriptions are compiled in a
+		trie of logger name components, the set of clients interested
+		in a logger is cached until the subscriptions or the clients
+		change, and each event is serialized once for all the clients
+		which receive it.
+
 		<p><li>If the application hosting the <code>SocketHubAppender</code> 
 		exits before the <code>SocketHubAppender</code> is closed either
 		explicitly or subsequent to garbage collection, then there might
@@ -109,6 +123,34 @@ namespace log4cxx
 
 		class SocketHubAppender : public AppenderSkeleton
 		{
+		public:
+			/**
+			Events a client wants to receive: the ones of the logger
+			named #loggerName and of its descendants whose level is at
+			least #level. An empty name stands for all the loggers.
+			*/
+			class Subscription
+			{
+			public:
+				Subscription(const tstring& loggerName, const Level& level);
+				Subscription(const tstring& loggerName, int level);
+
+				tstring loggerName;
+				int level;
+			};
+			typedef std::vector<Subscription> SubscriptionList;
+
+			/**
+			Sends subscriptions to the SocketHubAppender a client is
+			connected to. They replace the previous subscriptions of the
+			client.
+			*/
+			static void subscribe(helpers::SocketPtr socket,
+				const SubscriptionList& subscriptions);
+
+			/** Maximum number of subscriptions of a client. */
+			static int MAX_SUBSCRIPTIONS;
+
 		private:
 			/**
 			The default port number of the ServerSocket will be created on.
@@ -116,23 +158,97 @@ namespace log4cxx
 			static int DEFAULT_PORT;
 			
 			int port;
-			std::vector<helpers::SocketOutputStreamPtr> oosList;
 			bool locationInfo;
-			
+
+			/**
+			A connected client, which reads the subscriptions sent by
+			the remote side in its own thread.
+			*/
+			/** Incremented each time a client of a hub connects,
+			disconnects or subscribes. It is shared with the clients,
+			whose threads may outlive the hub. */
+			class Generation : public helpers::ObjectImpl
+			{
+			public:
+				Generation() : value(0) {}
+				volatile long value;
+			};
+			typedef helpers::ObjectPtr<Generation> GenerationPtr;
+
+			class Client :
+				public helpers::Runnable,
+				public helpers::ObjectImpl
+			{
+			public:
+				Client(helpers::SocketPtr socket,
+					const GenerationPtr& generation);
+				void run();
+
+				helpers::SocketPtr socket;
+				GenerationPtr generation;
+
+				/** Protected by the lock of the client. */
+				SubscriptionList subscriptions;
+				bool subscribed;
+			};
+			typedef helpers::ObjectPtr<Client> ClientPtr;
+
+			/** Clients interested in a logger, with the lowest level
+			they want. */
+			typedef std::vector< std::pair<Client *, int> > ClientSet;
+
+			/** A component of a subscribed logger name. */
+			class TrieNode
+			{
+			public:
+				~TrieNode();
+				std::map<tstring, TrieNode *> children;
+				ClientSet clients;
+			};
+
+			std::vector<ClientPtr> clients;
+
+			/** Subscriptions of all the clients, built by #update. */
+			TrieNode * trie;
+
+			/** Client sets of the loggers seen since #update. */
+			std::map<tstring, ClientSet> clientSets;
+
+			/** Value of #generation when #trie was built. */
+			long trieGeneration;
+
+			/** Generation of the clients of this hub. */
+			GenerationPtr generation;
+
+			/** Each event is serialized once in this buffer. */
+			helpers::SocketOutputStreamPtr eventBuffer;
+
+			/** Builds the trie again from the subscriptions. */
+			void update();
+
+			/** Returns the clients interested in a logger. */
+			const ClientSet& getClientSet(const tstring& loggerName);
+
+			/** Adds a client to a set, or lowers its level. */
+			static void merge(ClientSet& set, Client * client, int level);
+
+			/** Called by the server monitor for each new connection. */
+			void addClient(helpers::SocketPtr socket);
+
 		public:
 			SocketHubAppender();
 			~SocketHubAppender();
-			
+
 			/**
 			Connects to remote server at <code>address</code> and <code>port</code>.
 			*/
 			SocketHubAppender(int port) ;
-			
+
 			/**
 			Set up the socket server on the specified port.
 			*/
 			virtual void activateOptions();
-			
+
 		    /**
 		    Set options
 		    */
@@ -144,79 +260,82 @@ namespace log4cxx
 			call then #cleanUp method.
 			*/
 			virtual void close();
-			
+
 			/**
 			Release the underlying ServerMonitor thread, and drop the connections
 			to all connected remote servers. */
 			void cleanUp();
-			
+
 			/**
-			Append an event to all of current connections. */
+			Append an event to the connections of the clients interested
+			in it. */
 			virtual void append(const spi::LoggingEvent& event);
-			
+
 			/**
 			The SocketHubAppender does not use a layout. Hence, this method returns
 			<code>false</code>. */
 			virtual bool requiresLayout()
 				{ return false; }
-			
+
 			/**
 			The <b>Port</b> option takes a positive integer representing
 			the port where the server is waiting for connections. */
 			inline void setPort(int port)
 				{ this->port = port; }
-			
+
 			/**
 			Returns value of the <b>Port</b> option. */
 			inline int getPort() const
 				{ return port; }
-			
+
 			/**
 			The <b>LocationInfo</b> option takes a boolean value. If true,
 			the information sent to the remote host will include location
 			information. By default no location information is sent to the server. */
 			inline void setLocationInfo(bool locationInfo)
 				{  this->locationInfo = locationInfo; }
-			
+
 			/**
 			Returns value of the <b>LocationInfo</b> option. */
 			inline bool getLocationInfo() const
 				{ return locationInfo; }
-			
+
 			/**
 			Start the ServerMonitor thread. */
 		private:
 			void startServer();
-			
+
 			/**
 			This class is used internally to monitor a ServerSocket
-			and register new connections in a vector passed in the
-			constructor. */
+			and register new connections with the appender. */
 			class ServerMonitor : 
 				public helpers::Runnable,
 					public helpers::ObjectImpl
 			{
 			private:
 				int port;
-				std::vector<helpers::SocketOutputStreamPtr> oosList;
-				bool keepRunning;
-				helpers::Thread * monitorThread;
-				
+				SocketHubAppender * hub;
+				volatile bool keepRunning;
+
+				/** Posted when the monitor thread ends. */
+				helpers::Semaphore ended;
+
 			public:
 				/**
 				Create a thread and start the monitor. */
-				ServerMonitor(int port, const std::vector<helpers::SocketOutputStreamPtr>& oosList);
-			
+				ServerMonitor(int port, SocketHubAppender * hub);
+
 				/**
 				Stops the monitor. This method will not return until
 				the thread has finished executing. */
 				void stopMonitor();
-				
+
 				/**
 				Method that runs, monitoring the ServerSocket and adding connections as
 				they connect to the socket. */
 				void run();
 			}; // class ServerMonitor
+			friend class ServerMonitor;
 
 			typedef helpers::ObjectPtr<ServerMonitor> ServerMonitorPtr;
 			ServerMonitorPtr serverMonitor;
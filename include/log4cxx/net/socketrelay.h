@@ -0,0 +1,155 @@
+/***************************************************************************
+                          socketrelay.h  -  class SocketRelay
+                             -------------------
+    begin                : sam mai 24 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#ifndef _LOG4CXX_NET_SOCKET_RELAY_H
+#define _LOG4CXX_NET_SOCKET_RELAY_H
+
+#include <log4cxx/helpers/tchar.h>
+#include <log4cxx/helpers/objectimpl.h>
+#include <log4cxx/helpers/objectptr.h>
+#include <log4cxx/helpers/socket.h>
+#include <log4cxx/helpers/byterange.h>
+#include <vector>
+
+namespace log4cxx
+{
+	class Level;
+
+	namespace net
+	{
+		class SocketRelay;
+		typedef helpers::ObjectPtr<SocketRelay> SocketRelayPtr;
+
+		/**
+		Forwards the events received by {@link net::SocketRelayNode
+		SocketRelayNode} objects to other log servers or to files,
+		without decoding them.
+
+		<p>Only the frame boundaries of the events are checked, and the
+		logger name and the level are read to choose the targets of each
+		event: there is no LoggingEvent, logger lookup or serialization
+		involved. The received bytes are written to the targets as they
+		are, the events of a buffer which go to the same target in a
+		single scatter-gather write.
+
+		<p>The routes must be added before the relay is used by a node.
+		*/
+		class SocketRelay : public virtual helpers::ObjectImpl
+		{
+		public:
+			/**
+			Destination of the relayed events. The writes to a target are
+			serialized by its lock and always contain complete events.
+			*/
+			class Target : public virtual helpers::ObjectImpl
+			{
+			public:
+				virtual ~Target() {}
+
+				/** Writes events, throws an IOException on failure. */
+				virtual void write(const helpers::ByteRange * ranges,
+					int count) = 0;
+
+				/** Describes the target in error messages. */
+				virtual tstring toString() const = 0;
+			};
+			typedef helpers::ObjectPtr<Target> TargetPtr;
+
+			/**
+			Sends the events to another log server, such as a
+			{@link net::SocketNode SocketNode} or another relay. While
+			the server cannot be reached, the events are dropped and a
+			connection is attempted every <code>reconnectionDelay</code>
+			milliseconds.
+			*/
+			class SocketTarget : public Target
+			{
+			public:
+				SocketTarget(const tstring& host, int port,
+					int reconnectionDelay = 30000);
+				void write(const helpers::ByteRange * ranges, int count);
+				tstring toString() const;
+
+			protected:
+				void connect();
+
+				tstring host;
+				int port;
+				int reconnectionDelay;
+				helpers::SocketPtr socket;
+				long nextConnection;
+			};
+
+			/**
+			Appends the events to a file, in the format they are sent
+			on the wire: the file can be sent to a log server later.
+			*/
+			class FileTarget : public Target
+			{
+			public:
+				/** Opens the file, throws an IOException on failure. */
+				FileTarget(const tstring& fileName);
+				~FileTarget();
+				void write(const helpers::ByteRange * ranges, int count);
+				tstring toString() const;
+
+			protected:
+				tstring fileName;
+				int fd;
+			};
+
+			SocketRelay();
+
+			/**
+			Forwards to <code>target</code> the events of the logger
+			named <code>loggerName</code> and of its descendants whose
+			level is at least <code>threshold</code>. An empty name
+			matches all the loggers. An event is written once to a
+			target, even if several routes lead to it.
+			*/
+			void addRoute(const tstring& loggerName, const Level& threshold,
+				TargetPtr target);
+
+			/**
+			Forwards the complete events at the beginning of a buffer and
+			returns their total size. Throws a SocketException if the
+			buffer does not hold valid events.
+			*/
+			size_t relay(const unsigned char * buffer, size_t length);
+
+			/** Returns the number of events relayed. */
+			inline long getEventCount() const
+				{ return eventCount; }
+
+		protected:
+			struct Route
+			{
+				tstring loggerName;
+				int threshold;
+				int target;
+			};
+
+			bool matches(const Route& route, const unsigned char * name,
+				size_t nameLength, int level) const;
+
+			std::vector<Route> routes;
+			std::vector<TargetPtr> targets;
+			volatile long eventCount;
+		}; // class SocketRelay
+	}; // namespace net
+}; // namespace log4cxx
+
+#endif // _LOG4CXX_NET_SOCKET_RELAY_H
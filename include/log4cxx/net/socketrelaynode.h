@@ -0,0 +1,53 @@
+/***************************************************************************
+                          socketrelaynode.h  -  class SocketRelayNode
+                             -------------------
+    begin                : sam mai 24 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#ifndef _LOG4CXX_NET_SOCKET_RELAY_NODE_H
+#define _LOG4CXX_NET_SOCKET_RELAY_NODE_H
+
+#include <log4cxx/helpers/thread.h>
+#include <log4cxx/helpers/objectptr.h>
+#include <log4cxx/helpers/objectimpl.h>
+#include <log4cxx/net/socketrelay.h>
+
+namespace log4cxx
+{
+	namespace net
+	{
+        /**
+        Reads the events sent by a remote client, like a
+        {@link net::SocketNode SocketNode}, and passes them undecoded to
+        a {@link net::SocketRelay SocketRelay}.
+        */
+        class SocketRelayNode :
+			public virtual helpers::Runnable,
+			public virtual helpers::ObjectImpl
+		{
+		protected:
+			helpers::SocketPtr socket;
+			SocketRelayPtr relay;
+
+		public:
+			/** Initial size of the receive buffer, which grows up to the
+			size of the largest event. */
+			static size_t BUFFER_SIZE;
+
+			SocketRelayNode(helpers::SocketPtr socket, SocketRelayPtr relay);
+			virtual void run();
+		};
+	}; // namespace net
+}; // namespace log4cxx
+
+#endif // _LOG4CXX_NET_SOCKET_RELAY_NODE_H
@@ -120,6 +120,9 @@ namespace log4cxx
 	<li>%M -- Minute as decimal(0-59)
 	<li>%p -- Locale's equivalent of AM or PM
 	<li>%S -- Second as decimal(0-59)
+	<li>%Q -- Milliseconds as decimal(000-999)
+	<li>%f -- Microseconds as decimal(000000-999999)
+	<li>%N -- Nanoseconds as decimal(000000000-999999999)
 	<li>%U -- Week of year, Sunday being first day(0-53)
 	<li>%w -- Weekday as a decimal(0-6, Sunday being 0)
 	<li>%W -- Week of year, Monday being first day(0-53)
@@ -219,6 +222,28 @@ namespace log4cxx
 	</tr>
 
 
+	<tr>
+	<td align=center><b>s</b></td>
+
+	<td>
+
+	<p>Used to output the stack trace of the logging event, which is
+	captured by the events of level
+	spi::LoggingEvent#setStackTraceLevel or higher. Each frame is
+	output on a line of its own, starting with a line separator, so
+	that the pattern usually ends with <b>\%m\%s\%n</b>. The number of
+	frames can be limited by a decimal constant placed between braces,
+	as in <b>\%s{10}</b>. Nothing is output if the event has no stack
+	trace.</p>
+
+	<p>The frames are symbolized by the thread which formats the
+	event: they are cheap to capture, but the first symbolization of
+	an address takes much longer. See helpers::StackTrace.
+	</p>
+
+	</td>
+	</tr>
+
 	<tr>
 	<td align=center><b>t</b></td>
 
@@ -242,14 +267,15 @@ namespace log4cxx
 
 	<td> 
 
-	<p>Used to output the MDC (mapped diagnostic context) associated
-	with the thread that generated the logging event. The <b>X</b>
-	conversion character <em>must</em> be followed by the key for the
-	map placed between braces, as in <b>\%X{clientNumber}</b> where
-	<code>clientNumber</code> is the key. The value in the MDC
-	corresponding to the key will be output.</p>
+	<p>Used to output the typed fields of the logging event. The
+	<b>X</b> conversion character can be followed by the name of a
+	field placed between braces, as in <b>\%X{clientNumber}</b> where
+	<code>clientNumber</code> is the name. The value of the field will
+	be output, or nothing if the event has no such field. Without a
+	name, all the fields are output as <code>name=value</code> pairs
+	separated by spaces.</p>
 
-	<p>See MDC class for more details.
+	<p>See Fields class for more details.
 	</p>
 
 	</td>
@@ -368,6 +394,13 @@ namespace log4cxx
 
 	</dl>
 
+	<p>When the <b>Sanitize</b> option is set to true, the text output by
+	the conversion specifiers, such as the message, can no longer inject
+	lines or terminal escape sequences into the log: the control
+	characters other than tab are escaped and the invalid UTF-8 sequences
+	are replaced, see helpers::Transform#appendSanitized. The literal text
+	of the pattern is output as is.
+
 	<p>The above text is largely inspired from Peter A. Darnell and
 	Philip E. Margolis' highly recommended book "C -- a Software
 	Engineering Approach", ISBN 0-387-97389-3.
@@ -394,6 +427,7 @@ namespace log4cxx
 		tstring pattern;
 		helpers::PatternConverterPtr head;
 		tstring timezone;
+		bool sanitize;
 
 	public:
 		/**
@@ -419,6 +453,18 @@ namespace log4cxx
 		inline tstring getConversionPattern() const
 			{ return pattern; }
 
+		/**
+		Set the <b>Sanitize</b> option, which escapes the control
+		characters and invalid sequences in the converted text.
+		*/
+		void setSanitize(bool sanitize);
+
+		/**
+		Returns the value of the <b>Sanitize</b> option.
+		*/
+		inline bool getSanitize() const
+			{ return sanitize; }
+
 		/**
 		Call createPatternParser
 		*/
@@ -439,6 +485,13 @@ namespace log4cxx
 		*/
 		virtual void format(tostream& output, const spi::LoggingEvent& event);
 
+		/**
+		Produces the same string as #format, referencing the message of
+		the event when it is large.
+		*/
+		virtual bool gather(helpers::GatherBuffer& output,
+			const spi::LoggingEvent& event);
+
 	protected:
 		/**
 		Returns head of PatternParser used to parse the conversion string. 
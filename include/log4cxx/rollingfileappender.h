@@ -19,12 +19,20 @@
 
 #include <log4cxx/fileappender.h>
 #include <log4cxx/helpers/optionconverter.h>
+#include <log4cxx/helpers/archivewriter.h>
 
 namespace log4cxx
 {
 	/**
 	RollingFileAppender extends FileAppender to backup the log files when
 	they reach a certain size.
+
+	<p>If the <b>Archive</b> option is set, the events are also written
+	to <code>File.lca</code>, a columnar archive which
+	helpers::ArchiveReader queries much faster than the text can be
+	searched. It rolls over with the log file, to <code>File.lca.1</code>
+	and so on, but keeps <b>MaxArchiveIndex</b> backups, so that the
+	compact archives can be kept longer than the text.
 	*/
 	class RollingFileAppender : public FileAppender
 	{
@@ -39,6 +47,18 @@ namespace log4cxx
 		*/
 		int  maxBackupIndex;
 
+		/**
+		Are the events also written to an archive? False by default.
+		*/
+		bool archive;
+
+		/**
+		There are 10 archive backups by default.
+		*/
+		int maxArchiveIndex;
+
+		helpers::ArchiveWriter archiveWriter;
+
 	public:
 		/**
 		The default constructor simply calls its {@link
@@ -120,9 +140,49 @@ namespace log4cxx
 				value, maxFileSize + 1); }
 
 
+		/**
+		The <b>Archive</b> option takes a boolean value. If true, the
+		events are also written to the archive <code>File.lca</code>.
+
+		<p>Note: the archive is opened by #activateOptions.
+		*/
+		inline void setArchive(bool archive)
+			{ this->archive = archive; }
+
+		inline bool getArchive() const
+			{ return archive; }
+
+		/**
+		The <b>MaxArchiveIndex</b> option sets the number of archive
+		backups, <code>File.lca.1</code> to
+		<code>File.lca.MaxArchiveIndex</code>.
+		*/
+		inline void setMaxArchiveIndex(int maxArchiveIndex)
+			{ this->maxArchiveIndex = maxArchiveIndex; }
+
+		inline int getMaxArchiveIndex() const
+			{ return maxArchiveIndex; }
+
+		/**
+		Opens the log file and, if the <b>Archive</b> option is set, the
+		archive.
+		*/
+		void activateOptions();
+
 		virtual void setOption(const std::string& option, const std::string& value);
 			
 	protected:
+		/**
+		Closes the log file and the archive, after having written its
+		last block.
+		*/
+		virtual void closeWriter();
+
+		/**
+		Opens the archive of #fileName, in append or truncate mode.
+		*/
+		void openArchive(bool append);
+
 		/**
 		This method differentiates RollingFileAppender from its parent
 		class.
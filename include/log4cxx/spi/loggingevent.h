@@ -21,6 +21,7 @@
 #include <log4cxx/helpers/tchar.h>
 #include <time.h>
 #include <log4cxx/logger.h>
+#include <log4cxx/fields.h>
 
 namespace log4cxx
 {
@@ -36,6 +37,8 @@ namespace log4cxx
 
 		class SocketInputStream;
 		typedef helpers::ObjectPtr<SocketInputStream> SocketInputStreamPtr;
+
+		class StackTrace;
 	};
 	
 	namespace spi
@@ -73,6 +76,25 @@ namespace log4cxx
 			LoggingEvent(const LoggerPtr& logger, const Level& level,
 				const tstring& message, const char* file=0, int line=-1);
 
+			/**
+			Instantiate a LoggingEvent with typed fields. The strings of
+			the fields are not copied: they must outlive the event, or
+			the event must be copied.
+			*/
+			LoggingEvent(const LoggerPtr& logger, const Level& level,
+				const tstring& message, const Fields& fields,
+				const char* file=0, int line=-1);
+
+			/**
+			Copies <code>event</code>, truncating its message and NDC to
+			<code>maxMessageLength</code> and <code>maxNDCLength</code>
+			characters. A length of 0 stands for no limit.
+			*/
+			LoggingEvent(const LoggingEvent& event, int maxMessageLength,
+				int maxNDCLength);
+
+			~LoggingEvent();
+
 			/**  Return the name of the #logger. */
 			inline const tstring& getLoggerName() const
 				{ return logger->getName(); }
@@ -89,6 +111,20 @@ namespace log4cxx
 			inline time_t getTimeStamp() const
 				{ return timeStamp; }
 
+			/** Return the number of microseconds elapsed in the second
+			of the #timeStamp. */
+			inline long getMicroseconds() const
+				{ return microseconds; }
+
+			/** Return the typed #fields of this event. */
+			inline const Fields& getFields() const
+				{ return fields; }
+
+			/** Return the #stackTrace of this event, or null if it has
+			none. */
+			inline const helpers::StackTrace * getStackTrace() const
+				{ return stackTrace; }
+
 			/** Return the #threadId of this event. */
 			inline unsigned long getThreadId() const
 				{ return threadId; }
@@ -123,12 +159,71 @@ namespace log4cxx
 			/** Obtain a copy a this event. */
 			LoggingEvent * copy() const;
 
+			/**
+			Returns true if the message of this event is longer than
+			<code>maxMessageLength</code> or if its NDC is longer than
+			<code>maxNDCLength</code>. A length of 0 stands for no limit.
+			*/
+			bool exceeds(int maxMessageLength, int maxNDCLength) const;
+
+			/**
+			Sets the maximum number of characters of the messages. A
+			longer message is truncated when the event is created, before
+			it is copied, and ends with a marker giving the number of
+			characters removed. 0, the default, stands for no limit.
+			*/
+			static void setMaxMessageLength(int maxMessageLength);
+
+			/** Returns the maximum number of characters of the
+			messages. */
+			inline static int getMaxMessageLength()
+				{ return maxMessageLength; }
+
+			/**
+			Sets the maximum number of characters of the NDC of the
+			events. 0, the default, stands for no limit.
+			*/
+			static void setMaxNDCLength(int maxNDCLength);
+
+			/** Returns the maximum number of characters of the NDC of
+			the events. */
+			inline static int getMaxNDCLength()
+				{ return maxNDCLength; }
+
+			/** Returns the number of messages truncated since the
+			application started. */
+			inline static long getTruncatedMessageCount()
+				{ return truncatedMessages; }
+
+			/** Returns the number of NDC truncated since the
+			application started. */
+			inline static long getTruncatedNDCCount()
+				{ return truncatedNDCs; }
+
+			/**
+			Sets the lowest level of the events which capture the stack
+			of their thread, usually Level#ERROR. Level#OFF, the
+			default, disables the capture.
+			*/
+			static void setStackTraceLevel(const Level& level);
+
+			/** Returns the lowest level of the events which capture the
+			stack of their thread, as an integer. */
+			inline static int getStackTraceLevel()
+				{ return stackTraceLevel; }
+
 			/**
 			Obtain a copy of this thread's MDC prior to serialization
 			or asynchronous logging.
 			*/
 			void getMDCCopy() const {}
 		private:
+			LoggingEvent& operator=(const LoggingEvent&);
+
+			/** Sets the message, the time stamp and the thread of the
+			event, and captures its stack trace. */
+			void init(const tstring& message);
+
             /** The logger of the logging event */
 			LoggerPtr logger;
 
@@ -145,6 +240,10 @@ namespace log4cxx
             was created. */
             time_t timeStamp;
 
+			/** Microseconds elapsed in the second of #timeStamp. They are
+			not serialized: a received event has none. */
+			long microseconds;
+
 			/** The is the file where this log statement was written. */
 			char* file;
 
@@ -166,7 +265,20 @@ namespace log4cxx
 			*/
 			unsigned long threadId;
 
+			/** The typed fields of the logging event. */
+			Fields fields;
+
+			/** The return addresses of the thread which created the
+			event, if its level is at least #stackTraceLevel. */
+			helpers::StackTrace * stackTrace;
+
 			static time_t startTime;
+
+			static int maxMessageLength;
+			static int maxNDCLength;
+			static int stackTraceLevel;
+			static volatile long truncatedMessages;
+			static volatile long truncatedNDCs;
   		};
 	};
 };
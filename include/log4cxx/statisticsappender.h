@@ -0,0 +1,229 @@
+/***************************************************************************
+                          statisticsappender.h  -  class StatisticsAppender
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#ifndef _LOG4CXX_STATISTICS_APPENDER_H
+#define _LOG4CXX_STATISTICS_APPENDER_H
+
+#include <log4cxx/appenderskeleton.h>
+#include <log4cxx/helpers/appenderattachableimpl.h>
+#include <log4cxx/helpers/thread.h>
+#include <log4cxx/helpers/criticalsection.h>
+#include <log4cxx/helpers/semaphore.h>
+#include <log4cxx/helpers/threadspecificdata.h>
+#include <map>
+#include <vector>
+
+namespace log4cxx
+{
+	class StatisticsAppender;
+	typedef helpers::ObjectPtr<StatisticsAppender> StatisticsAppenderPtr;
+
+	/**
+	The StatisticsAppender does not write the events: it counts them per
+	logger and level, and periodically passes a summary of the counts to
+	the appenders attached to it.
+
+	<p>The loggers are grouped by the first <b>Depth</b> components of
+	their names: with a depth of 2, the events of <code>app.db.pool</code>
+	are counted with those of <code>app.db</code>. With the default depth
+	of 0, each logger is counted on its own. Levels between the standard
+	ones are counted with the next lower standard level.
+
+	<p>The <b>Fields</b> option takes a comma separated list of names.
+	The numbers written as <code>name=value</code> in the messages are
+	then aggregated too: their count, sum, minimum and maximum.
+
+	<p>Every <b>FlushInterval</b> seconds, and when the appender is
+	closed, an INFO event of the <code>log4cxx.StatisticsAppender</code>
+	logger is passed to the attached appenders for each group and level
+	counted during the interval. Its message gives the group, the level,
+	the number of events and, for each field found, its count, sum,
+	minimum and maximum:
+	<pre>
+	app.db ERROR 12 latency=10/340/1/90
+	</pre>
+	A FileAppender with the <b>"\%d \%m\%n"</b> pattern attached to the
+	StatisticsAppender writes them to a file.
+
+	<p>Each thread counts in its own shard, locked only by the thread and
+	by the flush, so that the threads which log do not wait for each
+	other. Unlike AppenderSkeleton#doAppend, #doAppend does not hold the
+	lock of the appender. A shard is kept until the appender is
+	destroyed, even if its thread ends.
+	*/
+	class StatisticsAppender :
+		public AppenderSkeleton,
+		public helpers::AppenderAttachableImpl
+	{
+	public:
+		/** The default flush interval is 60 seconds. */
+		static int DEFAULT_FLUSH_INTERVAL;
+
+	protected:
+		/** Index of the FATAL, ERROR, WARN, INFO and DEBUG levels in the
+		counters. */
+		enum { LEVEL_COUNT = 5 };
+
+		/** Aggregate of the values of a field. */
+		struct FieldStatistics
+		{
+			long count;
+			double sum;
+			double min;
+			double max;
+		};
+
+		/** Counters of a group of loggers. */
+		struct Counters
+		{
+			long events[LEVEL_COUNT];
+
+			/** Statistics of each field for each level, the fields of a
+			level being contiguous. */
+			std::vector<FieldStatistics> fields;
+		};
+
+		/** Counters of a thread. */
+		struct Shard
+		{
+			helpers::CriticalSection cs;
+
+			/** Counters of each group. */
+			std::map<tstring, Counters> groups;
+
+			/** Counters of each logger seen, shared by the loggers of a
+			group. */
+			std::map<tstring, Counters *> loggers;
+		};
+
+		int depth;
+		std::vector<tstring> fields;
+		int flushInterval;
+
+		/** Shards of the threads, protected by the appender lock. */
+		std::vector<Shard *> shards;
+
+		/** Shard of the current thread. */
+		helpers::ThreadSpecificData currentShard;
+
+		/** Posted on #close, to flush at once. */
+		helpers::Semaphore wakeUp;
+
+		/** Posted when the flush thread ends. */
+		helpers::Semaphore flusherEnded;
+
+		bool flusherStarted;
+		volatile bool closing;
+
+	public:
+		StatisticsAppender();
+		~StatisticsAppender();
+
+		/**
+		Unlike AppenderSkeleton#doAppend, this method does not hold the
+		lock of the appender.
+		*/
+		void doAppend(const spi::LoggingEvent& event);
+
+		/**
+		Starts the flush thread.
+		*/
+		void activateOptions();
+
+		/**
+		Flushes the counters and closes the attached appenders.
+		*/
+		void close();
+
+		/**
+		The <code>StatisticsAppender</code> does not require a layout.
+		Hence, this method always returns <code>false</code>.
+		*/
+		bool requiresLayout()
+			{ return false; }
+
+		/**
+		The <b>Depth</b> option takes the number of components of the
+		logger names which make a group, 0 standing for the whole name.
+		*/
+		inline void setDepth(int depth)
+			{ this->depth = depth; }
+
+		/** Returns value of the <b>Depth</b> option. */
+		inline int getDepth() const
+			{ return depth; }
+
+		/**
+		The <b>Fields</b> option takes the names of the numeric fields
+		to aggregate, separated by commas. It must be set before the
+		appender is used.
+		*/
+		void setFields(const tstring& fields);
+
+		/**
+		The <b>FlushInterval</b> option takes the number of seconds
+		between two summaries.
+		*/
+		inline void setFlushInterval(int flushInterval)
+			{ this->flushInterval = flushInterval; }
+
+		/** Returns value of the <b>FlushInterval</b> option. */
+		inline int getFlushInterval() const
+			{ return flushInterval; }
+
+		/**
+		Passes the summary of the counters to the attached appenders
+		and resets them.
+		*/
+		void flush();
+
+		/**
+		Set options
+		*/
+		void setOption(const tstring& option, const tstring& value);
+
+	protected:
+		/**
+		Counts the event in the shard of the current thread.
+		*/
+		void append(const spi::LoggingEvent& event);
+
+		/** Returns the group of the logger named <code>name</code>. */
+		tstring getGroup(const tstring& name) const;
+
+		/** Adds the fields found in <code>message</code> to
+		<code>statistics</code>. */
+		void parseFields(const tstring& message,
+			FieldStatistics * statistics) const;
+
+	private:
+		/** Runs the flush thread. */
+		class Flusher :
+			public helpers::Runnable,
+			public helpers::ObjectImpl
+		{
+		private:
+			StatisticsAppender * appender;
+
+		public:
+			Flusher(StatisticsAppender * appender);
+			void run();
+		}; // class Flusher
+		friend class Flusher;
+	}; // class StatisticsAppender
+}; // namespace log4cxx
+
+#endif //_LOG4CXX_STATISTICS_APPENDER_H
@@ -0,0 +1,172 @@
+/***************************************************************************
+                          expressionfilter.h  -  class ExpressionFilter
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#ifndef _LOG4CXX_VARIA_EXPRESSION_FILTER_H
+#define _LOG4CXX_VARIA_EXPRESSION_FILTER_H
+
+#include <log4cxx/spi/filter.h>
+#include <vector>
+
+namespace log4cxx
+{
+	namespace spi
+	{
+		class LoggingEvent;
+	};
+
+	namespace varia
+	{
+		class ExpressionFilter;
+		typedef helpers::ObjectPtr<ExpressionFilter> ExpressionFilterPtr;
+
+		/**
+		A filter deciding with a boolean expression on the event.
+
+		<p>The filter admits two options <b>Expression</b> and
+		<b>AcceptOnMatch</b>. If the expression is true for an event, the
+		#decide method returns {@link spi::Filter#ACCEPT ACCEPT} if the
+		<b>AcceptOnMatch</b> option value is true, and {@link
+		spi::Filter#DENY DENY} if it is false. Otherwise, {@link
+		spi::Filter#NEUTRAL NEUTRAL} is returned.
+
+		<p>An expression compares attributes of the event with constants,
+		and combines the comparisons with <code>&amp;&amp;</code>,
+		<code>||</code>, <code>!</code> and parentheses:
+		<pre>
+		level >= WARN &amp;&amp; logger ^= "db." &amp;&amp; field.tenant == "acme"
+		</pre>
+
+		<table border=1>
+		<tr><th>Attribute</th><th>Operators</th><th>Constants</th></tr>
+		<tr><td><code>level</code></td>
+		<td><code>== != &lt; &lt;= &gt; &gt;=</code></td>
+		<td>a level name or its integer value</td></tr>
+		<tr><td><code>logger</code>, <code>message</code>,
+		<code>ndc</code></td>
+		<td><code>== !=</code>, <code>^=</code> (starts with),
+		<code>$=</code> (ends with), <code>~=</code> (contains)</td>
+		<td>a string between double quotes</td></tr>
+		<tr><td><code>field.</code><i>name</i> or
+		<code>mdc.</code><i>name</i></td>
+		<td>the ones of the strings, or of the levels for numbers</td>
+		<td>a string, a number, <code>true</code> or
+		<code>false</code></td></tr>
+		</table>
+
+		<p>A field compared with a constant of another type is not equal
+		to it. Alone, <code>field.</code><i>name</i> is true if the event
+		has the field.
+
+		<p>The expression is compiled when it is set: the level names are
+		resolved, the constant parts are folded and an event is then
+		decided without allocation. An invalid expression is reported
+		with LogLog and the filter is then neutral.
+		*/
+		class ExpressionFilter : public spi::Filter
+		{
+		private:
+			static tstring EXPRESSION_OPTION;
+			static tstring ACCEPT_ON_MATCH_OPTION;
+
+		public:
+			/** Types of the nodes of a compiled expression. */
+			enum NodeType
+			{
+				CONSTANT, NOT, AND, OR, LEVEL, STRING, FIELD_EXISTS,
+				FIELD_STRING, FIELD_NUMBER, FIELD_BOOL
+			};
+
+			/** Comparison operators. */
+			enum Operator
+			{
+				EQ, NE, LT, LE, GT, GE, PREFIX, SUFFIX, CONTAINS
+			};
+
+			/** Attributes compared with strings. */
+			enum Attribute { LOGGER, MESSAGE, NDC };
+
+			/** A node of a compiled expression. */
+			struct Node
+			{
+				NodeType type;
+				Operator op;
+
+				/** Operands of NOT, AND and OR. */
+				int left;
+				int right;
+
+				/** Value of CONSTANT and FIELD_BOOL. */
+				bool boolean;
+
+				Attribute attribute;
+				int level;
+				double number;
+
+				/** Name of a field. */
+				tstring name;
+				tstring string;
+			};
+
+		protected:
+			bool acceptOnMatch;
+			tstring expression;
+
+			/** The nodes of the compiled expression. */
+			std::vector<Node> nodes;
+
+			/** Index of the root node, or -1 without valid expression. */
+			int root;
+
+		public:
+			ExpressionFilter();
+
+			/**
+			Set options
+			*/
+			virtual void setOption(const tstring& option,
+				const tstring& value);
+
+			/**
+			Compiles <code>expression</code>. An invalid expression is
+			reported with LogLog.
+			*/
+			void setExpression(const tstring& expression);
+
+			inline const tstring& getExpression() const
+				{ return expression; }
+
+			inline void setAcceptOnMatch(bool acceptOnMatch)
+				{ this->acceptOnMatch = acceptOnMatch; }
+
+			inline bool getAcceptOnMatch() const
+				{ return acceptOnMatch; }
+
+			/**
+			Returns {@link spi::Filter#NEUTRAL NEUTRAL} if the expression
+			is false.
+			*/
+			int decide(const spi::LoggingEvent& event);
+
+		protected:
+			/** Evaluates the node at <code>index</code>. */
+			bool evaluate(int index, const spi::LoggingEvent& event) const;
+
+			friend class ExpressionParser;
+		}; // class ExpressionFilter
+	}; // namespace varia
+}; // namespace log4cxx
+
+#endif // _LOG4CXX_VARIA_EXPRESSION_FILTER_H
@@ -0,0 +1,206 @@
+/***************************************************************************
+                          fallbackerrorhandler.h  -  class FallbackErrorHandler
+                             -------------------
+    begin                : ven mai 23 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#ifndef _LOG4CXX_VARIA_FALLBACK_ERROR_HANDLER_H
+#define _LOG4CXX_VARIA_FALLBACK_ERROR_HANDLER_H
+
+#include <log4cxx/spi/errorhandler.h>
+#include <log4cxx/helpers/objectimpl.h>
+#include <log4cxx/appenderskeleton.h>
+
+namespace log4cxx
+{
+	namespace varia
+	{
+		class FallbackErrorHandler;
+		typedef helpers::ObjectPtr<FallbackErrorHandler> FallbackErrorHandlerPtr;
+
+		/**
+		The <code>FallbackErrorHandler</code> implements an error handling
+		strategy that replaces the failing appender by a backup appender
+		in all the loggers it is attached to.
+
+		<p>The replacement does not modify the appenders of the loggers:
+		it uses Logger#redirectAppender, which takes effect in all the
+		loggers at once without going through them. While the appender
+		is replaced, an event is passed to it every <b>RetryInterval</b>
+		milliseconds: if it is appended without error and in less than
+		<b>LatencyThreshold</b> milliseconds, the loggers call the
+		appender again.
+
+		<p>The event being appended when the error occured is passed to
+		the backup appender. Events passed to the failing appender by
+		other means than a logger, such as an AsyncAppender, are not
+		redirected.
+		*/
+		class FallbackErrorHandler : public virtual spi::ErrorHandler,
+			public virtual helpers::ObjectImpl
+		{
+		friend class Redirector;
+
+		public:
+			/** The default retry interval is 30 seconds. */
+			static int DEFAULT_RETRY_INTERVAL;
+
+			/** The default latency threshold is 1 second. */
+			static int DEFAULT_LATENCY_THRESHOLD;
+
+		protected:
+			/**
+			Called by the loggers instead of the failing appender. Passes
+			the events to the backup appender and retries the failing
+			appender from time to time.
+			*/
+			class Redirector : public AppenderSkeleton
+			{
+			public:
+				Redirector(FallbackErrorHandler * handler,
+					AppenderPtr appender);
+				~Redirector();
+
+				void append(const spi::LoggingEvent& event);
+				void close();
+
+				bool requiresLayout()
+					{ return false; }
+
+			protected:
+				FallbackErrorHandlerPtr handler;
+				AppenderPtr appender;
+				long nextRetry;
+			};
+
+			/**
+			The failing appender. It is not referenced: it references
+			this handler.
+			*/
+			Appender * appender;
+
+			AppenderPtr backupAppender;
+
+			/** Set while the appender is redirected. */
+			AppenderPtr redirector;
+
+			int retryInterval;
+			int latencyThreshold;
+
+			/** Number of errors reported by the appender. */
+			volatile long errors;
+
+			/** 1 while the redirector retries the appender, changed
+			with Interlocked so that one thread retries at a time. */
+			volatile long probing;
+
+		public:
+			FallbackErrorHandler();
+
+			/**
+			Does not do anything: the appender is replaced in all the
+			loggers it is attached to.
+			*/
+			void setLogger(LoggerPtr logger);
+
+			/**
+			No options to activate.
+			*/
+			void activateOptions();
+
+			/**
+			Supports the <b>RetryInterval</b> and <b>LatencyThreshold</b>
+			options.
+			*/
+			void setOption(const tstring& option, const tstring& value);
+
+			/**
+			Prints the message and the exception and replaces the
+			failing appender by the backup appender.
+			*/
+			void error(const tstring& message, helpers::Exception& e,
+				int errorCode);
+
+			/**
+			Prints the message and the exception, replaces the failing
+			appender by the backup appender and passes it the event.
+			*/
+			void error(const tstring& message, helpers::Exception& e,
+				int errorCode, spi::LoggingEvent& event);
+
+			/**
+			Prints the message and replaces the failing appender by the
+			backup appender.
+			*/
+			void error(const tstring& message);
+
+			/**
+			Sets the appender which is replaced in case of failure.
+			*/
+			void setAppender(AppenderPtr appender);
+
+			/**
+			Sets the appender which replaces the failing appender.
+			*/
+			void setBackupAppender(AppenderPtr backupAppender);
+
+			/**
+			Returns the appender which replaces the failing appender.
+			*/
+			AppenderPtr getBackupAppender();
+
+			/**
+			Sets the number of milliseconds between two attempts to use
+			the failing appender again. If 0, the failing appender is
+			never used again.
+			*/
+			inline void setRetryInterval(int millis)
+				{ retryInterval = millis; }
+
+			/** Returns the current value of the <b>RetryInterval</b>
+			option. */
+			inline int getRetryInterval() const
+				{ return retryInterval; }
+
+			/**
+			Sets the time within which an event must be appended by the
+			failing appender to consider it has recovered.
+			*/
+			inline void setLatencyThreshold(int millis)
+				{ latencyThreshold = millis; }
+
+			/** Returns the current value of the <b>LatencyThreshold</b>
+			option. */
+			inline int getLatencyThreshold() const
+				{ return latencyThreshold; }
+
+			/** Returns true while the appender is replaced. */
+			bool isRedirected();
+
+		protected:
+			/**
+			Replaces the appender by the backup appender, if it is not
+			already. Returns false if it was already replaced.
+			*/
+			bool redirect();
+
+			/** Makes the loggers call the appender again. */
+			void restore();
+
+			/** Returns the current time, in milliseconds. */
+			static long currentTimeMillis();
+		}; // class FallbackErrorHandler
+	}; // namespace varia
+}; // namespace log4cxx
+
+#endif //_LOG4CXX_VARIA_FALLBACK_ERROR_HANDLER_H
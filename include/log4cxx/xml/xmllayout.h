@@ -53,6 +53,10 @@ namespace log4cxx
 		* <p>This approach enforces the independence of the XMLLayout and the
 		* appender where it is embedded.
 		*
+		* <p>The typed fields of an event are written in a
+		* log4cxx:properties element, one log4cxx:data element with the
+		* name, type and value of each field.
+		*
 		* */
 		class XMLLayout : public Layout
 		{
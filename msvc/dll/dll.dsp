@@ -102,6 +102,18 @@ SOURCE=..\..\src\appenderskeleton.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\archivereader.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\src\archivewriter.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\src\arena.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\asyncappender.cpp
 # End Source File
 # Begin Source File
@@ -110,6 +122,18 @@ SOURCE=..\..\src\boundedfifo.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\byterange.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\src\circuitbreakerappender.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\src\clock.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\consoleappender.cpp
 # End Source File
 # Begin Source File
@@ -204,6 +228,18 @@ BuildCmds= \
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\expressionfilter.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\src\fallbackerrorhandler.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\src\fields.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\fileappender.cpp
 # End Source File
 # Begin Source File
@@ -212,6 +248,10 @@ SOURCE=..\..\src\formattinginfo.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\gatherbuffer.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\gnomexmlreader.cpp
 # End Source File
 # Begin Source File
@@ -220,14 +260,26 @@ SOURCE=..\..\src\hierarchy.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\histogram.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\htmllayout.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\httpappender.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\inetaddress.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\interlocked.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\level.cpp
 # End Source File
 # Begin Source File
@@ -292,6 +344,14 @@ SOURCE=..\..\src\patternparser.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\performancecounters.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\src\reclaimer.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\rollingfileappender.cpp
 # End Source File
 # Begin Source File
@@ -344,6 +404,22 @@ SOURCE=..\..\src\socketoutputstream.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\socketrelay.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\src\socketrelaynode.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\src\stacktrace.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\src\statisticsappender.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\stringmatchfilter.cpp
 # End Source File
 # Begin Source File
@@ -360,6 +436,10 @@ SOURCE=..\..\src\threadspecificdata.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\timezone.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\transform.cpp
 # End Source File
 # Begin Source File
@@ -391,10 +471,30 @@ SOURCE=..\..\include\log4cxx\helpers\appenderattachableimpl.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\include\log4cxx\helpers\archivereader.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\include\log4cxx\helpers\archivewriter.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\include\log4cxx\helpers\arena.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\include\log4cxx\helpers\boundedfifo.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\include\log4cxx\helpers\byterange.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\include\log4cxx\helpers\clock.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\include\log4cxx\helpers\criticalsection.h
 # End Source File
 # Begin Source File
@@ -419,14 +519,26 @@ SOURCE=..\..\include\log4cxx\helpers\formattinginfo.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\include\log4cxx\helpers\gatherbuffer.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\include\log4cxx\helpers\gnomexmlreader.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\include\log4cxx\helpers\histogram.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\include\log4cxx\helpers\inetaddress.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\include\log4cxx\helpers\interlocked.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\include\log4cxx\helpers\iso8601dateformat.h
 # End Source File
 # Begin Source File
@@ -467,6 +579,14 @@ SOURCE=..\..\include\log4cxx\helpers\patternparser.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\include\log4cxx\helpers\performancecounters.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\include\log4cxx\helpers\reclaimer.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\include\log4cxx\helpers\relativetimedateformat.h
 # End Source File
 # Begin Source File
@@ -495,6 +615,10 @@ SOURCE=..\..\include\log4cxx\helpers\socketoutputstream.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\include\log4cxx\helpers\stacktrace.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\include\log4cxx\helpers\stringhelper.h
 # End Source File
 # Begin Source File
@@ -511,6 +635,10 @@ SOURCE=..\..\include\log4cxx\helpers\threadspecificdata.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\include\log4cxx\helpers\timezone.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\include\log4cxx\helpers\transform.h
 # End Source File
 # End Group
@@ -579,6 +707,10 @@ SOURCE=..\..\include\log4cxx\xml\xmllayout.h
 # PROP Default_Filter "h"
 # Begin Source File
 
+SOURCE=..\..\include\log4cxx\net\httpappender.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\include\log4cxx\net\socketappender.h
 # End Source File
 # Begin Source File
@@ -591,6 +723,14 @@ SOURCE=..\..\include\log4cxx\net\socketnode.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\include\log4cxx\net\socketrelay.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\include\log4cxx\net\socketrelaynode.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\include\log4cxx\net\telnetappender.h
 # End Source File
 # End Group
@@ -603,6 +743,14 @@ SOURCE=..\..\include\log4cxx\varia\denyallfilter.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\include\log4cxx\varia\expressionfilter.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\include\log4cxx\varia\fallbackerrorhandler.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\include\log4cxx\varia\levelmatchfilter.h
 # End Source File
 # Begin Source File
@@ -636,6 +784,10 @@ SOURCE=..\..\include\log4cxx\asyncappender.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\include\log4cxx\circuitbreakerappender.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\include\log4cxx\config.h
 # End Source File
 # Begin Source File
@@ -648,6 +800,10 @@ SOURCE=..\..\include\log4cxx\defaultcategoryfactory.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\include\log4cxx\fields.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\include\log4cxx\fileappender.h
 # End Source File
 # Begin Source File
@@ -696,6 +852,10 @@ SOURCE=..\..\include\log4cxx\simplelayout.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\include\log4cxx\statisticsappender.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\include\log4cxx\ttcclayout.h
 # End Source File
 # Begin Source File
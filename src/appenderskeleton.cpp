@@ -19,6 +19,9 @@
 #include <log4cxx/appenderskeleton.h>
 #include <log4cxx/helpers/loglog.h>
 #include <log4cxx/helpers/onlyonceerrorhandler.h>
+#include <log4cxx/helpers/optionconverter.h>
+#include <log4cxx/helpers/stringhelper.h>
+#include <log4cxx/helpers/interlocked.h>
 #include <log4cxx/level.h>
 
 using namespace log4cxx;
@@ -27,7 +30,8 @@ using namespace log4cxx::helpers;
 
 AppenderSkeleton::AppenderSkeleton()
 : errorHandler(new OnlyOnceErrorHandler()), closed(false),
-threshold(&Level::ALL)
+threshold(&Level::ALL), maxMessageLength(0), maxNDCLength(0),
+truncatedEvents(0)
 {
 }
 
@@ -77,20 +81,42 @@ void AppenderSkeleton::doAppend(const spi::LoggingEvent& event)
 		return;
 	}
 
-	if(!isAsSevereAsThreshold(event.getLevel()))
+	if(!isAccepted(event))
 	{
 		return;
 	}
 
-	FilterPtr f = headFilter;
+	appendLimited(event);
+}
+
+void AppenderSkeleton::appendLimited(const spi::LoggingEvent& event)
+{
+	if((maxMessageLength == 0 && maxNDCLength == 0)
+		|| !event.exceeds(maxMessageLength, maxNDCLength))
+	{
+		append(event);
+		return;
+	}
 
+	Interlocked::increment(&truncatedEvents);
+	append(LoggingEvent(event, maxMessageLength, maxNDCLength));
+}
+
+bool AppenderSkeleton::isAccepted(const spi::LoggingEvent& event)
+{
+	if(!isAsSevereAsThreshold(event.getLevel()))
+	{
+		return false;
+	}
+
+	FilterPtr f = headFilter;
 
 	while(f != 0)
 	{
 		 switch(f->decide(event))
 		 {
 			 case Filter::DENY:
-				 return;
+				 return false;
 			 case Filter::ACCEPT:
 				 f = 0;
 				 break;
@@ -99,7 +125,7 @@ void AppenderSkeleton::doAppend(const spi::LoggingEvent& event)
 		 }
 	}
 
-	append(event);
+	return true;
 }
 
 void AppenderSkeleton::setErrorHandler(spi::ErrorHandlerPtr errorHandler)
@@ -117,3 +143,16 @@ void AppenderSkeleton::setErrorHandler(spi::ErrorHandlerPtr errorHandler)
 		this->errorHandler = errorHandler;
 	}
 }
+
+void AppenderSkeleton::setOption(const tstring& option,
+	const tstring& value)
+{
+	if (StringHelper::equalsIgnoreCase(option, _T("maxmessagelength")))
+	{
+		setMaxMessageLength(OptionConverter::toInt(value, 0));
+	}
+	else if (StringHelper::equalsIgnoreCase(option, _T("maxndclength")))
+	{
+		setMaxNDCLength(OptionConverter::toInt(value, 0));
+	}
+}
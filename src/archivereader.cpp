@@ -0,0 +1,371 @@
+/***************************************************************************
+                          archivereader.cpp  -  class ArchiveReader
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/helpers/archivereader.h>
+#include <log4cxx/helpers/loglog.h>
+#include <limits.h>
+#include <string.h>
+
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+
+using namespace log4cxx;
+using namespace log4cxx::helpers;
+
+/** magic number, block count and timestamps, bloom filter and the
+sizes and encoding of each column */
+#define BLOCK_HEADER_SIZE (4 + 4 + 8 + 8 + ArchiveWriter::BLOOM_BYTES \
+	+ ArchiveWriter::COLUMN_COUNT * 9)
+
+ArchiveReader::Query::Query()
+: from(0), to(0), minLevel(INT_MIN), columns(ALL_COLUMNS)
+{
+	// int64 has no portable limit macro
+	to = ~(uint64)0 >> 1;
+	from = -to - 1;
+}
+
+ArchiveReader::ArchiveReader()
+: file(0), blocksRead(0), blocksSkipped(0), eventCount(0), minTime(0),
+maxTime(0)
+{
+}
+
+ArchiveReader::~ArchiveReader()
+{
+	close();
+}
+
+bool ArchiveReader::open(const tstring& fileName)
+{
+	USES_CONVERSION;
+
+	close();
+
+	file = fopen(T2A(fileName.c_str()), "rb");
+	if (file == 0)
+	{
+		LogLog::error(_T("Could not open archive ") + fileName);
+		return false;
+	}
+
+	char header[5];
+	if (fread(header, 1, 5, file) != 5 || memcmp(header, "L4CA", 4) != 0
+		|| header[4] != ArchiveWriter::FORMAT_VERSION)
+	{
+		LogLog::error(fileName + _T(" is not a log archive."));
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+void ArchiveReader::close()
+{
+	if (file != 0)
+	{
+		fclose(file);
+		file = 0;
+	}
+}
+
+int64 ArchiveReader::readFixed(const unsigned char * buffer, int size)
+{
+	uint64 value = 0;
+	for (int i = size - 1; i >= 0; i--)
+	{
+		value = (value << 8) | buffer[i];
+	}
+
+	// sign extension of the shorter values is not needed: they are sizes
+	return (int64)value;
+}
+
+bool ArchiveReader::readVarInt(const std::string& column, size_t& pos,
+	int64& value)
+{
+	uint64 n = 0;
+	for (int shift = 0; shift < 64; shift += 7)
+	{
+		if (pos >= column.size())
+		{
+			return false;
+		}
+
+		unsigned char byte = (unsigned char)column[pos++];
+		n |= (uint64)(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+		{
+			value = (int64)(n >> 1) ^ -(int64)(n & 1);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool ArchiveReader::readString(const std::string& column, size_t& pos,
+	tstring& value)
+{
+	int64 length;
+	if (!readVarInt(column, pos, length) || length < 0 ||
+		(uint64)length * sizeof(TCHAR) > column.size() - pos)
+	{
+		return false;
+	}
+
+	value.assign((const TCHAR *)(column.data() + pos), (size_t)length);
+	pos += (size_t)length * sizeof(TCHAR);
+	return true;
+}
+
+bool ArchiveReader::readColumn(int index)
+{
+	std::string& column = columnData[index];
+	std::string& buffer =
+		(encodings[index] == ArchiveWriter::RAW) ? column : stored;
+
+	buffer.resize(storedSizes[index]);
+	if (storedSizes[index] > 0 &&
+		fread(&buffer[0], 1, buffer.size(), file) != buffer.size())
+	{
+		return false;
+	}
+
+	if (encodings[index] == ArchiveWriter::RAW)
+	{
+		return storedSizes[index] == sizes[index];
+	}
+
+#ifdef HAVE_LIBZ
+	uLongf size = sizes[index];
+	column.resize(size);
+	return ::uncompress((Bytef *)&column[0], &size,
+		(const Bytef *)stored.data(), stored.size()) == Z_OK
+		&& size == (uLongf)sizes[index];
+#else
+	LogLog::error(_T("log4cxx was built without zlib, ")
+		_T("the archive cannot be read."));
+	return false;
+#endif
+}
+
+bool ArchiveReader::scan(const Query& query, std::vector<Record>& records)
+{
+	blocksRead = 0;
+	blocksSkipped = 0;
+
+	if (file == 0)
+	{
+		return false;
+	}
+
+	fseek(file, 5, SEEK_SET);
+
+	Query all;
+	bool timeFilter = query.from != all.from || query.to != all.to;
+	bool levelFilter = query.minLevel != all.minLevel;
+	bool loggerFilter = !query.loggerName.empty();
+
+	int needed = query.columns;
+	if (timeFilter) needed |= TIMESTAMP;
+	if (levelFilter) needed |= LEVEL;
+	if (loggerFilter) needed |= LOGGER;
+
+	unsigned int bits[ArchiveWriter::BLOOM_HASHES];
+	if (loggerFilter)
+	{
+		ArchiveWriter::getBloomBits(query.loggerName, bits);
+	}
+
+	std::vector<tstring> dictionary;
+	unsigned char header[BLOCK_HEADER_SIZE];
+
+	while (true)
+	{
+		size_t read = fread(header, 1, BLOCK_HEADER_SIZE, file);
+		if (read == 0)
+		{
+			return true;
+		}
+
+		if (read != BLOCK_HEADER_SIZE || memcmp(header, "L4CB", 4) != 0)
+		{
+			LogLog::error(_T("Corrupted archive block."));
+			return false;
+		}
+
+		const unsigned char * p = header + 4;
+		eventCount = (int)readFixed(p, 4);
+		minTime = readFixed(p + 4, 8);
+		maxTime = readFixed(p + 12, 8);
+		memcpy(bloom, p + 20, sizeof(bloom));
+		p += 20 + sizeof(bloom);
+
+		long dataSize = 0;
+		int column;
+		for (column = 0; column < ArchiveWriter::COLUMN_COUNT; column++)
+		{
+			storedSizes[column] = (long)readFixed(p, 4);
+			sizes[column] = (long)readFixed(p + 4, 4);
+			encodings[column] = p[8];
+			dataSize += storedSizes[column];
+			p += 9;
+		}
+
+		// the header is enough to skip most of the blocks
+		bool skip = timeFilter && (maxTime < query.from || minTime > query.to);
+		for (int i = 0; loggerFilter && i < ArchiveWriter::BLOOM_HASHES; i++)
+		{
+			skip |= (bloom[bits[i] / 8] & (1 << (bits[i] % 8))) == 0;
+		}
+
+		if (skip)
+		{
+			blocksSkipped++;
+			fseek(file, dataSize, SEEK_CUR);
+			continue;
+		}
+
+		blocksRead++;
+		for (column = 0; column < ArchiveWriter::COLUMN_COUNT; column++)
+		{
+			if ((needed & (1 << column)) == 0)
+			{
+				fseek(file, storedSizes[column], SEEK_CUR);
+			}
+			else if (!readColumn(column))
+			{
+				LogLog::error(_T("Corrupted archive column."));
+				return false;
+			}
+		}
+
+		size_t pos[ArchiveWriter::COLUMN_COUNT] = { 0, 0, 0, 0, 0 };
+
+		int loggerIndex = -1;
+		if (needed & LOGGER)
+		{
+			int64 count;
+			bool valid = readVarInt(columnData[2], pos[2], count);
+			dictionary.resize(valid ? (size_t)count : 0);
+			for (int i = 0; valid && i < count; i++)
+			{
+				valid = readString(columnData[2], pos[2], dictionary[i]);
+				if (valid && loggerFilter && dictionary[i] == query.loggerName)
+				{
+					loggerIndex = i;
+				}
+			}
+
+			if (!valid)
+			{
+				LogLog::error(_T("Corrupted archive column."));
+				return false;
+			}
+
+			// the bloom filter gave a false positive
+			if (loggerFilter && loggerIndex < 0)
+			{
+				continue;
+			}
+		}
+
+		int64 time = 0, level = 0, levelRun = 0, logger = 0, thread = 0;
+		tstring message;
+		bool valid = true;
+
+		for (int i = 0; valid && i < eventCount; i++)
+		{
+			int64 delta;
+			if (needed & TIMESTAMP)
+			{
+				valid &= readVarInt(columnData[0], pos[0], delta);
+				time += delta;
+			}
+
+			if (needed & LEVEL)
+			{
+				if (levelRun == 0)
+				{
+					valid &= readVarInt(columnData[1], pos[1], level)
+						&& readVarInt(columnData[1], pos[1], levelRun)
+						&& levelRun > 0;
+				}
+				levelRun--;
+			}
+
+			if (needed & LOGGER)
+			{
+				valid &= readVarInt(columnData[2], pos[2], logger)
+					&& logger >= 0 && logger < (int64)dictionary.size();
+			}
+
+			if (needed & THREAD)
+			{
+				valid &= readVarInt(columnData[3], pos[3], thread);
+			}
+
+			bool match = valid && !(timeFilter &&
+				(time < query.from || time > query.to))
+				&& !(levelFilter && level < query.minLevel)
+				&& !(loggerFilter && logger != loggerIndex);
+
+			if (needed & MESSAGE)
+			{
+				if (match)
+				{
+					valid &= readString(columnData[4], pos[4], message);
+				}
+				else
+				{
+					// skipped without being copied
+					int64 length;
+					valid &= readVarInt(columnData[4], pos[4], length)
+						&& length >= 0 && (uint64)length * sizeof(TCHAR)
+						<= columnData[4].size() - pos[4];
+					pos[4] += valid ? (size_t)length * sizeof(TCHAR) : 0;
+				}
+			}
+
+			if (match && valid)
+			{
+				records.push_back(Record());
+				Record& record = records.back();
+				record.timeStamp = (query.columns & TIMESTAMP) ? time : 0;
+				record.level = (query.columns & LEVEL) ? (int)level : 0;
+				if (query.columns & LOGGER)
+				{
+					record.loggerName = dictionary[(size_t)logger];
+				}
+				record.threadId = (query.columns & THREAD) ?
+					(unsigned long)thread : 0;
+				if (query.columns & MESSAGE)
+				{
+					record.message.swap(message);
+				}
+			}
+		}
+
+		if (!valid)
+		{
+			LogLog::error(_T("Corrupted archive column."));
+			return false;
+		}
+	}
+}
@@ -0,0 +1,262 @@
+/***************************************************************************
+                          archivewriter.cpp  -  class ArchiveWriter
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/helpers/archivewriter.h>
+#include <log4cxx/helpers/loglog.h>
+#include <log4cxx/spi/loggingevent.h>
+#include <log4cxx/level.h>
+#include <string.h>
+
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+
+using namespace log4cxx;
+using namespace log4cxx::helpers;
+using namespace log4cxx::spi;
+
+int ArchiveWriter::DEFAULT_BLOCK_SIZE = 4096;
+
+ArchiveWriter::ArchiveWriter()
+: file(0), blockSize(DEFAULT_BLOCK_SIZE), eventCount(0), minTime(0),
+maxTime(0), lastTime(0), lastLevel(0), levelRun(0)
+{
+	memset(bloom, 0, sizeof(bloom));
+}
+
+ArchiveWriter::~ArchiveWriter()
+{
+	close();
+}
+
+bool ArchiveWriter::open(const tstring& fileName, bool append)
+{
+	USES_CONVERSION;
+
+	close();
+
+	file = fopen(T2A(fileName.c_str()), append ? "ab" : "wb");
+	if (file == 0)
+	{
+		return false;
+	}
+
+	// an appended archive keeps its header
+	fseek(file, 0, SEEK_END);
+	if (ftell(file) == 0)
+	{
+		std::string header("L4CA");
+		header += (char)FORMAT_VERSION;
+		fwrite(header.data(), 1, header.size(), file);
+	}
+
+	return true;
+}
+
+void ArchiveWriter::close()
+{
+	if (file != 0)
+	{
+		flush();
+		fclose(file);
+		file = 0;
+	}
+}
+
+void ArchiveWriter::getBloomBits(const tstring& loggerName,
+	unsigned int bits[BLOOM_HASHES])
+{
+	// FNV-1a, the second hash is derived from the first one
+	unsigned int h1 = 2166136261U;
+	const unsigned char * bytes = (const unsigned char *)loggerName.data();
+	size_t length = loggerName.size() * sizeof(TCHAR);
+	for (size_t i = 0; i < length; i++)
+	{
+		h1 = (h1 ^ bytes[i]) * 16777619U;
+	}
+	unsigned int h2 = (h1 >> 17) | (h1 << 15);
+
+	for (int i = 0; i < BLOOM_HASHES; i++)
+	{
+		bits[i] = (h1 + i * h2) % (BLOOM_BYTES * 8);
+	}
+}
+
+void ArchiveWriter::writeVarInt(std::string& column, int64 value)
+{
+	// zigzag encoding keeps the small negative values short
+	uint64 n = ((uint64)value << 1) ^ (uint64)(value >> 63);
+	while (n >= 0x80)
+	{
+		column += (char)((n & 0x7F) | 0x80);
+		n >>= 7;
+	}
+	column += (char)n;
+}
+
+void ArchiveWriter::writeString(std::string& column, const tstring& value)
+{
+	writeVarInt(column, (int64)value.size());
+	column.append((const char *)value.data(), value.size() * sizeof(TCHAR));
+}
+
+void ArchiveWriter::writeFixed(std::string& buffer, int64 value, int size)
+{
+	// little endian, whatever the platform
+	for (int i = 0; i < size; i++)
+	{
+		buffer += (char)(value & 0xFF);
+		value >>= 8;
+	}
+}
+
+void ArchiveWriter::write(const spi::LoggingEvent& event)
+{
+	if (file == 0)
+	{
+		return;
+	}
+
+	int64 time = (int64)event.getTimeStamp() * 1000000 +
+		event.getMicroseconds();
+	if (eventCount == 0)
+	{
+		// the first timestamp of a block is written in full
+		minTime = maxTime = time;
+		lastTime = 0;
+	}
+	else if (time < minTime)
+	{
+		minTime = time;
+	}
+	else if (time > maxTime)
+	{
+		maxTime = time;
+	}
+	writeVarInt(timestamps, time - lastTime);
+	lastTime = time;
+
+	int level = event.getLevel().level;
+	if (levelRun > 0 && level != lastLevel)
+	{
+		writeVarInt(levels, lastLevel);
+		writeVarInt(levels, levelRun);
+		levelRun = 0;
+	}
+	lastLevel = level;
+	levelRun++;
+
+	const tstring& loggerName = event.getLoggerName();
+	std::map<tstring, int>::iterator it = dictionary.find(loggerName);
+	if (it == dictionary.end())
+	{
+		it = dictionary.insert(std::map<tstring, int>::value_type(
+			loggerName, (int)loggerNames.size())).first;
+		loggerNames.push_back(&it->first);
+
+		unsigned int bits[BLOOM_HASHES];
+		getBloomBits(loggerName, bits);
+		for (int i = 0; i < BLOOM_HASHES; i++)
+		{
+			bloom[bits[i] / 8] |= (unsigned char)(1 << (bits[i] % 8));
+		}
+	}
+	writeVarInt(loggers, it->second);
+
+	writeVarInt(threads, (int64)event.getThreadId());
+	writeString(messages, event.getRenderedMessage());
+
+	if (++eventCount >= blockSize)
+	{
+		flush();
+	}
+}
+
+void ArchiveWriter::addColumn(std::string& header, const std::string& column)
+{
+	const std::string * stored = &column;
+	Encoding encoding = RAW;
+
+#ifdef HAVE_LIBZ
+	uLongf size = ::compressBound(column.size());
+	compressed.resize(size);
+	if (::compress2((Bytef *)&compressed[0], &size,
+		(const Bytef *)column.data(), column.size(), Z_BEST_SPEED) == Z_OK
+		&& size < column.size())
+	{
+		compressed.resize(size);
+		stored = &compressed;
+		encoding = DEFLATE;
+	}
+#endif
+
+	writeFixed(header, (int64)stored->size(), 4);
+	writeFixed(header, (int64)column.size(), 4);
+	header += (char)encoding;
+	data += *stored;
+}
+
+void ArchiveWriter::flush()
+{
+	if (file == 0 || eventCount == 0)
+	{
+		return;
+	}
+
+	writeVarInt(levels, lastLevel);
+	writeVarInt(levels, levelRun);
+
+	std::string loggerColumn;
+	writeVarInt(loggerColumn, (int64)loggerNames.size());
+	std::vector<const tstring *>::iterator it;
+	for (it = loggerNames.begin(); it != loggerNames.end(); it++)
+	{
+		writeString(loggerColumn, **it);
+	}
+	loggerColumn += loggers;
+
+	std::string header("L4CB");
+	writeFixed(header, eventCount, 4);
+	writeFixed(header, minTime, 8);
+	writeFixed(header, maxTime, 8);
+	header.append((const char *)bloom, BLOOM_BYTES);
+
+	data.erase();
+	addColumn(header, timestamps);
+	addColumn(header, levels);
+	addColumn(header, loggerColumn);
+	addColumn(header, threads);
+	addColumn(header, messages);
+
+	if (fwrite(header.data(), 1, header.size(), file) != header.size() ||
+		fwrite(data.data(), 1, data.size(), file) != data.size() ||
+		fflush(file) != 0)
+	{
+		LogLog::error(_T("Could not write archive block."));
+	}
+
+	// the columns keep their capacity for the next block
+	eventCount = 0;
+	levelRun = 0;
+	memset(bloom, 0, sizeof(bloom));
+	timestamps.erase();
+	levels.erase();
+	dictionary.clear();
+	loggerNames.clear();
+	loggers.erase();
+	threads.erase();
+	messages.erase();
+}
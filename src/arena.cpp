@@ -0,0 +1,160 @@
+/***************************************************************************
+                          arena.cpp  -  class Arena
+                             -------------------
+    begin                : mar mai 20 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/helpers/arena.h>
+
+using namespace log4cxx::helpers;
+
+namespace
+{
+	/**
+	Stored just before each block. A block starts on a cache line and
+	its header lies at the end of the previous line.
+	*/
+	struct BlockHeader
+	{
+		/** arena of the block, null for a block allocated from the heap */
+		Arena * arena;
+
+		union
+		{
+			/** size of the slot of a block allocated from an arena */
+			size_t slotSize;
+
+			/** address returned by the heap for the other blocks */
+			void * block;
+		};
+	};
+
+	inline char * alignUp(char * p)
+	{
+		size_t misalignment = (size_t)p % LOG4CXX_CACHE_LINE_SIZE;
+		return misalignment == 0 ? p : p + LOG4CXX_CACHE_LINE_SIZE - misalignment;
+	}
+
+	inline size_t roundUp(size_t size)
+	{
+		return (size + LOG4CXX_CACHE_LINE_SIZE - 1)
+			/ LOG4CXX_CACHE_LINE_SIZE * LOG4CXX_CACHE_LINE_SIZE;
+	}
+}
+
+Arena::Arena(size_t chunkSize)
+: chunkSize(chunkSize), current(0), end(0), closed(false)
+{
+}
+
+Arena::~Arena()
+{
+	std::vector<char *>::iterator it, itEnd = chunks.end();
+	for (it = chunks.begin(); it != itEnd; it++)
+	{
+		::operator delete(*it);
+	}
+}
+
+void * Arena::allocate(size_t size)
+{
+	// one cache line for the header, then the block itself
+	size_t slotSize = LOG4CXX_CACHE_LINE_SIZE + roundUp(size);
+	char * slot = 0;
+
+	{
+		synchronized sync(this);
+
+		FreeLists::iterator it = freeLists.find(slotSize);
+		if (it != freeLists.end() && it->second != 0)
+		{
+			// the next free slot is stored at the beginning of a free slot
+			slot = (char *)it->second;
+			it->second = *(void **)slot;
+		}
+		else
+		{
+			if (current == 0 || (size_t)(end - current) < slotSize)
+			{
+				size_t size = slotSize > chunkSize ? slotSize : chunkSize;
+				char * chunk = (char *)::operator new(
+					size + LOG4CXX_CACHE_LINE_SIZE);
+				chunks.push_back(chunk);
+				current = alignUp(chunk);
+				end = current + size;
+			}
+
+			slot = current;
+			current += slotSize;
+		}
+	}
+
+	addRef();
+
+	char * p = slot + LOG4CXX_CACHE_LINE_SIZE;
+	BlockHeader * header = (BlockHeader *)p - 1;
+	header->arena = this;
+	header->slotSize = slotSize;
+	return p;
+}
+
+void * Arena::allocateAligned(size_t size)
+{
+	char * block = (char *)::operator new(
+		size + sizeof(BlockHeader) + LOG4CXX_CACHE_LINE_SIZE);
+	char * p = alignUp(block + sizeof(BlockHeader));
+	BlockHeader * header = (BlockHeader *)p - 1;
+	header->arena = 0;
+	header->block = block;
+	return p;
+}
+
+void Arena::deallocate(void * p)
+{
+	if (p == 0)
+	{
+		return;
+	}
+
+	BlockHeader * header = (BlockHeader *)p - 1;
+	if (header->arena == 0)
+	{
+		::operator delete(header->block);
+	}
+	else
+	{
+		header->arena->release(p, header->slotSize);
+	}
+}
+
+void Arena::close()
+{
+	closed = true;
+}
+
+void Arena::release(void * p, size_t slotSize)
+{
+	// the block will not be reused: the chunks are released together
+	if (!closed)
+	{
+		synchronized sync(this);
+
+		void * slot = (char *)p - LOG4CXX_CACHE_LINE_SIZE;
+		void *& head = freeLists[slotSize];
+		*(void **)slot = head;
+		head = slot;
+	}
+
+	// may destroy this arena if this block was the last one
+	releaseRef();
+}
@@ -17,6 +17,15 @@
 #include <log4cxx/asyncappender.h>
 #include <log4cxx/helpers/loglog.h>
 #include <log4cxx/helpers/boundedfifo.h>
+#include <log4cxx/helpers/stringhelper.h>
+#include <log4cxx/helpers/optionconverter.h>
+#include <log4cxx/helpers/clock.h>
+#include <log4cxx/helpers/interlocked.h>
+#include <log4cxx/spi/loggingevent.h>
+#include <log4cxx/logger.h>
+#include <log4cxx/level.h>
+
+#include <algorithm>
 
 using namespace log4cxx;
 using namespace log4cxx::helpers;
@@ -26,7 +35,10 @@ using namespace log4cxx::spi;
 int AsyncAppender::DEFAULT_BUFFER_SIZE = 128;
 
 AsyncAppender::AsyncAppender()
-: locationInfo(false), interruptedWarningMessage(false)
+: locationInfo(false), interruptedWarningMessage(false), hybrid(false),
+waitStrategy(BLOCK), dispatcherParked(false), waitingProducers(0),
+highWaterMark(0), summaryInterval(0), nextSummary(0), fanOut(false),
+sinkBufferSize(DEFAULT_BUFFER_SIZE), overflowPolicy(WAIT_FOR_SPACE)
 {
 	bf = new BoundedFIFO(DEFAULT_BUFFER_SIZE);
 	
@@ -39,6 +51,23 @@ AsyncAppender::~AsyncAppender()
 	finalize();
 }
 
+void AsyncAppender::doAppend(const spi::LoggingEvent& event)
+{
+	if(closed)
+	{
+		LogLog::error(_T("Attempted to append to closed appender named [")
+			+name+_T("]."));
+		return;
+	}
+
+	if(!isAccepted(event))
+	{
+		return;
+	}
+
+	appendLimited(event);
+}
+
 void AsyncAppender::append(const spi::LoggingEvent& event)
 {
 	// Set the NDC and thread name for the calling thread as these
@@ -51,22 +80,339 @@ void AsyncAppender::append(const spi::LoggingEvent& event)
 	{
 		event.getLocationInformation();
 	}*/
-	
-	synchronized sync(bf);
 
-	while(bf->isFull())
+	// The dispatcher holds dispatchCs from before it removes an event
+	// until the event is appended: if we get it and the buffer is empty,
+	// no event can be written after this one.
+	if(hybrid && !fanOut && dispatchCs.tryLock())
 	{
-		//LOGLOG_DEBUG(_T("Waiting for free space in buffer, ")
-		//	 << bf->length());
-		bf->wait();
+		bool empty;
+		{
+			synchronized sync(bf);
+			empty = (bf->length() == 0);
+		}
+
+		if(empty)
+		{
+			int64 start = Clock::monotonicMicros();
+			appendLoopOnAppenders(event);
+			eventDispatched(start, start, Clock::monotonicMicros());
+			dispatchCs.unlock();
+			return;
+		}
+
+		dispatchCs.unlock();
 	}
-	
-	bf->put(event.copy());
-	if(bf->wasEmpty())
+
+	LoggingEvent * copy = event.copy();
+	int64 enqueued = Clock::monotonicMicros();
+
+	while(true)
+	{
+		{
+			synchronized sync(bf);
+
+			if(!bf->isFull())
+			{
+				bf->put(copy, enqueued);
+				if(bf->length() > highWaterMark)
+				{
+					highWaterMark = bf->length();
+				}
+				if(dispatcherParked)
+				{
+					//LogLog::debug(_T("Notifying dispatcher to process events."));
+					dispatcherParked = false;
+					eventAvailable.post();
+				}
+				return;
+			}
+
+			//LOGLOG_DEBUG(_T("Waiting for free space in buffer, ")
+			//	 << bf->length());
+			waitingProducers++;
+		}
+
+		// the buffer lock must not be held while waiting, or the
+		// dispatcher could never make room.
+		spaceAvailable.wait();
+	}
+}
+
+void AsyncAppender::notifyWaitingProducers()
+{
+	while(waitingProducers > 0)
+	{
+		waitingProducers--;
+		spaceAvailable.post();
+	}
+}
+
+void AsyncAppender::eventDispatched(int64 enqueued, int64 dispatched,
+	int64 written)
+{
+	dispatchDelay.record(dispatched - enqueued);
+	appendDuration.record(written - dispatched);
+
+	if(summaryInterval <= 0 || summaryLogger == 0)
+	{
+		return;
+	}
+
+	if(nextSummary == 0)
+	{
+		nextSummary = written + (int64)summaryInterval * 1000000;
+		return;
+	}
+
+	if(written < nextSummary)
+	{
+		return;
+	}
+
+	nextSummary = written + (int64)summaryInterval * 1000000;
+
+	tostringstream message;
+	message << _T("AsyncAppender [") << name
+		<< _T("] dispatch delay: ") << dispatchDelay.toString()
+		<< _T(", append duration: ") << appendDuration.toString()
+		<< _T(", buffer high-water mark: ") << getHighWaterMark()
+		<< _T("/") << getBufferSize();
+
+	if(fanOut)
+	{
+		std::vector<SinkStatistics> statistics = getSinkStatistics();
+		std::vector<SinkStatistics>::iterator it;
+		for(it = statistics.begin(); it != statistics.end(); it++)
+		{
+			message << _T(", sink [") << it->appenderName
+				<< _T("] pending: ") << it->pending
+				<< _T(", high-water mark: ") << it->highWaterMark
+				<< _T(", written: ") << it->written
+				<< _T(", discarded: ") << it->discarded;
+		}
+	}
+
+	LoggingEvent summary(summaryLogger, Level::INFO, message.str());
+
+	if(fanOut)
+	{
+		fanOutEvent(summary.copy());
+	}
+	else
+	{
+		appendLoopOnAppenders(summary);
+	}
+}
+
+void AsyncAppender::fanOutEvent(LoggingEvent * event)
+{
+	// targets is only used by the dispatcher: it keeps its capacity and
+	// the sinks are found without any allocation once created.
+	targets.clear();
+
+	{
+		synchronized sync(this);
+
+		AppenderList::iterator it, itEnd = appenderList.end();
+		for(it = appenderList.begin(); it != itEnd; it++)
+		{
+			SinkPtr sink;
+			std::vector<SinkPtr>::iterator itSink;
+			for(itSink = sinks.begin(); itSink != sinks.end(); itSink++)
+			{
+				if((*itSink)->appender == *it)
+				{
+					sink = *itSink;
+					break;
+				}
+			}
+
+			if(sink == 0)
+			{
+				OverflowPolicy policy = overflowPolicy;
+				std::map<tstring, OverflowPolicy>::iterator itPolicy =
+					overflowPolicies.find((*it)->getName());
+				if(itPolicy != overflowPolicies.end())
+				{
+					policy = itPolicy->second;
+				}
+
+				sink = new Sink(*it, sinkBufferSize, policy);
+				sink->start();
+				sinks.push_back(sink);
+			}
+
+			targets.push_back(sink);
+		}
+	}
+
+	if(targets.empty())
+	{
+		delete event;
+		return;
+	}
+
+	// a sink closed meanwhile by removeAppender releases the event
+	SharedEvent * shared = new SharedEvent;
+	shared->event = event;
+	shared->references = (long)targets.size();
+
+	std::vector<SinkPtr>::iterator it;
+	for(it = targets.begin(); it != targets.end(); it++)
+	{
+		(*it)->put(shared);
+	}
+}
+
+void AsyncAppender::closeSinks()
+{
+	std::vector<SinkPtr> closing;
+	{
+		synchronized sync(this);
+		closing.swap(sinks);
+	}
+
+	std::vector<SinkPtr>::iterator it;
+	for(it = closing.begin(); it != closing.end(); it++)
+	{
+		(*it)->close();
+	}
+}
+
+void AsyncAppender::closeDetachedSinks()
+{
+	std::vector<SinkPtr> closing;
+	{
+		synchronized sync(this);
+
+		std::vector<SinkPtr>::iterator it = sinks.begin();
+		while(it != sinks.end())
+		{
+			if(std::find(appenderList.begin(), appenderList.end(),
+				(*it)->appender) == appenderList.end())
+			{
+				closing.push_back(*it);
+				it = sinks.erase(it);
+			}
+			else
+			{
+				it++;
+			}
+		}
+	}
+
+	std::vector<SinkPtr>::iterator it;
+	for(it = closing.begin(); it != closing.end(); it++)
+	{
+		(*it)->close();
+	}
+}
+
+void AsyncAppender::removeAllAppenders()
+{
+	AppenderList appenders;
+	{
+		synchronized sync(this);
+		appenders.swap(appenderList);
+	}
+
+	// the appenders are closed once their sinks no longer use them
+	closeDetachedSinks();
+
+	AppenderList::iterator it;
+	for(it = appenders.begin(); it != appenders.end(); it++)
+	{
+		(*it)->close();
+	}
+}
+
+void AsyncAppender::removeAppender(AppenderPtr appender)
+{
+	AppenderAttachableImpl::removeAppender(appender);
+	closeDetachedSinks();
+}
+
+void AsyncAppender::removeAppender(const tstring& name)
+{
+	AppenderAttachableImpl::removeAppender(name);
+	closeDetachedSinks();
+}
+
+std::vector<AsyncAppender::SinkStatistics> AsyncAppender::getSinkStatistics()
+{
+	synchronized sync(this);
+
+	std::vector<SinkStatistics> statistics;
+	std::vector<SinkPtr>::iterator it;
+	for(it = sinks.begin(); it != sinks.end(); it++)
+	{
+		statistics.push_back((*it)->getStatistics());
+	}
+
+	return statistics;
+}
+
+void AsyncAppender::setOverflowPolicy(const tstring& appenderName,
+	OverflowPolicy policy)
+{
+	synchronized sync(this);
+	overflowPolicies[appenderName] = policy;
+}
+
+Histogram AsyncAppender::getDispatchDelay()
+{
+	dispatchCs.lock();
+	Histogram histogram = dispatchDelay;
+	dispatchCs.unlock();
+	return histogram;
+}
+
+Histogram AsyncAppender::getAppendDuration()
+{
+	dispatchCs.lock();
+	Histogram histogram = appendDuration;
+	dispatchCs.unlock();
+	return histogram;
+}
+
+int AsyncAppender::getHighWaterMark()
+{
+	synchronized sync(bf);
+	return highWaterMark;
+}
+
+void AsyncAppender::resetStatistics()
+{
+	dispatchCs.lock();
+	dispatchDelay.reset();
+	appendDuration.reset();
+	dispatchCs.unlock();
+
+	synchronized sync(bf);
+	highWaterMark = bf->length();
+}
+
+void AsyncAppender::activateOptions()
+{
+	LoggerPtr logger = Logger::getLogger(_T("log4cxx.AsyncAppender"));
+
+	dispatchCs.lock();
+	summaryLogger = logger;
+	dispatchCs.unlock();
+}
+
+void AsyncAppender::setSummaryInterval(int seconds)
+{
+	if(seconds > 0 && summaryLogger == 0)
 	{
-		//LogLog::debug(_T("Notifying dispatcher to process events."));
-		bf->notify();
+		activateOptions();
 	}
+
+	dispatchCs.lock();
+	summaryInterval = seconds;
+	nextSummary = 0;
+	dispatchCs.unlock();
 }
 
 void AsyncAppender::close()
@@ -87,10 +433,11 @@ void AsyncAppender::close()
 	// did synchronize we would systematically get deadlocks when
 	// close was called.
 	dispatcher->close();
-	
-	dispatcher->join();
+
+	// the dispatcher thread deletes itself when it ends: it cannot be
+	// joined, it tells when it is done instead.
+	dispatcherEnded.wait();
 	dispatcher = 0;
-	bf = 0;
 }
 
 void AsyncAppender::setBufferSize(int size)
@@ -103,8 +450,248 @@ int AsyncAppender::getBufferSize()
 	return bf->getMaxSize();
 }
 
+static AsyncAppender::OverflowPolicy toOverflowPolicy(const tstring& value)
+{
+	if (StringHelper::equalsIgnoreCase(value, _T("block")))
+	{
+		return AsyncAppender::WAIT_FOR_SPACE;
+	}
+	else if (StringHelper::equalsIgnoreCase(value, _T("discardnewest")))
+	{
+		return AsyncAppender::DISCARD_NEWEST;
+	}
+	else if (StringHelper::equalsIgnoreCase(value, _T("discardoldest")))
+	{
+		return AsyncAppender::DISCARD_OLDEST;
+	}
+
+	LogLog::warn(_T("Unknown overflow policy [") + value +
+		_T("], using Block."));
+	return AsyncAppender::WAIT_FOR_SPACE;
+}
+
+void AsyncAppender::setOption(const tstring& option, const tstring& value)
+{
+	static const tstring overflowPolicyPrefix = _T("overflowpolicy.");
+
+	if (StringHelper::equalsIgnoreCase(option, _T("buffersize")))
+	{
+		setBufferSize(OptionConverter::toInt(value, DEFAULT_BUFFER_SIZE));
+	}
+	else if (StringHelper::equalsIgnoreCase(option, _T("locationinfo")))
+	{
+		setLocationInfo(OptionConverter::toBoolean(value, false));
+	}
+	else if (StringHelper::equalsIgnoreCase(option, _T("hybrid")))
+	{
+		setHybrid(OptionConverter::toBoolean(value, false));
+	}
+	else if (StringHelper::equalsIgnoreCase(option, _T("summaryinterval")))
+	{
+		setSummaryInterval(OptionConverter::toInt(value, 0));
+	}
+	else if (StringHelper::equalsIgnoreCase(option, _T("fanout")))
+	{
+		setFanOut(OptionConverter::toBoolean(value, false));
+	}
+	else if (StringHelper::equalsIgnoreCase(option, _T("sinkbuffersize")))
+	{
+		setSinkBufferSize(OptionConverter::toInt(value, DEFAULT_BUFFER_SIZE));
+	}
+	else if (StringHelper::equalsIgnoreCase(option, _T("overflowpolicy")))
+	{
+		setOverflowPolicy(toOverflowPolicy(value));
+	}
+	else if (option.size() > overflowPolicyPrefix.size() &&
+		StringHelper::equalsIgnoreCase(
+		option.substr(0, overflowPolicyPrefix.size()), overflowPolicyPrefix))
+	{
+		// the appender name keeps its case
+		setOverflowPolicy(option.substr(overflowPolicyPrefix.size()),
+			toOverflowPolicy(value));
+	}
+	else if (StringHelper::equalsIgnoreCase(option, _T("waitstrategy")))
+	{
+		if (StringHelper::equalsIgnoreCase(value, _T("block")))
+		{
+			setWaitStrategy(BLOCK);
+		}
+		else if (StringHelper::equalsIgnoreCase(value, _T("spin")))
+		{
+			setWaitStrategy(SPIN);
+		}
+		else if (StringHelper::equalsIgnoreCase(value, _T("yield")))
+		{
+			setWaitStrategy(YIELD);
+		}
+		else if (StringHelper::equalsIgnoreCase(value, _T("park")))
+		{
+			setWaitStrategy(PARK);
+		}
+		else
+		{
+			LogLog::warn(_T("Unknown wait strategy [") + value +
+				_T("], using Block."));
+			setWaitStrategy(BLOCK);
+		}
+	}
+	else
+	{
+		AppenderSkeleton::setOption(option, value);
+	}
+}
+
+AsyncAppender::Sink::Sink(const AppenderPtr& appender, int bufferSize,
+	OverflowPolicy policy)
+: appender(appender), bufferSize(bufferSize), policy(policy),
+dispatcherWaiting(false), closing(false), highWaterMark(0), written(0),
+discarded(0)
+{
+}
+
+AsyncAppender::Sink::~Sink()
+{
+	while(!queue.empty())
+	{
+		release(queue.front());
+		queue.pop_front();
+	}
+}
+
+void AsyncAppender::Sink::start()
+{
+	// the thread deletes itself when run ends and holds a reference to
+	// the sink until then.
+	Thread * thread = new Thread(this);
+	thread->start();
+}
+
+void AsyncAppender::Sink::release(SharedEvent * event)
+{
+	if(Interlocked::decrement(&event->references) == 0)
+	{
+		delete event->event;
+		delete event;
+	}
+}
+
+void AsyncAppender::Sink::put(SharedEvent * event)
+{
+	cs.lock();
+
+	// nothing is queued once closing is set: the thread may have ended
+	while(!closing && (int)queue.size() >= bufferSize)
+	{
+		if(policy == DISCARD_NEWEST)
+		{
+			discarded++;
+			cs.unlock();
+			release(event);
+			return;
+		}
+		else if(policy == DISCARD_OLDEST)
+		{
+			SharedEvent * oldest = queue.front();
+			queue.pop_front();
+			discarded++;
+			release(oldest);
+			break;
+		}
+
+		// the lock must not be held while waiting, or the thread of
+		// the sink could never make room.
+		dispatcherWaiting = true;
+		cs.unlock();
+		space.wait();
+		cs.lock();
+	}
+
+	if(closing)
+	{
+		discarded++;
+		cs.unlock();
+		release(event);
+		return;
+	}
+
+	queue.push_back(event);
+	if((int)queue.size() > highWaterMark)
+	{
+		highWaterMark = (int)queue.size();
+	}
+
+	cs.unlock();
+	available.post();
+}
+
+void AsyncAppender::Sink::close()
+{
+	cs.lock();
+	closing = true;
+	cs.unlock();
+
+	available.post();
+	ended.wait();
+}
+
+AsyncAppender::SinkStatistics AsyncAppender::Sink::getStatistics()
+{
+	SinkStatistics statistics;
+	statistics.appenderName = appender->getName();
+
+	cs.lock();
+	statistics.pending = (int)queue.size();
+	statistics.highWaterMark = highWaterMark;
+	statistics.written = written;
+	statistics.discarded = discarded;
+	cs.unlock();
+
+	return statistics;
+}
+
+void AsyncAppender::Sink::run()
+{
+	while(true)
+	{
+		// posted once per queued event: an event discarded by
+		// DiscardOldest leaves an extra post, hence the empty check.
+		available.wait();
+
+		cs.lock();
+		if(queue.empty())
+		{
+			bool end = closing;
+			cs.unlock();
+			if(end)
+			{
+				break;
+			}
+			continue;
+		}
+
+		SharedEvent * event = queue.front();
+		queue.pop_front();
+		if(dispatcherWaiting)
+		{
+			dispatcherWaiting = false;
+			space.post();
+		}
+		cs.unlock();
+
+		appender->doAppend(*event->event);
+		release(event);
+
+		cs.lock();
+		written++;
+		cs.unlock();
+	}
+
+	ended.post();
+}
+
 Dispatcher::Dispatcher(helpers::BoundedFIFOPtr bf, AsyncAppender * container)
- : bf(bf), container(container), interrupted(false)
+ : bf(bf), container(container), interrupted(false),
+ spinCount(MIN_SPIN_COUNT)
 {
 	// set the dispatcher priority to lowest possible value
 	setPriority(Thread::MIN_PRIORITY);
@@ -115,48 +702,142 @@ void Dispatcher::close()
 	synchronized sync(bf);
 
 	interrupted = true;
-	// We have a waiting dispacther if and only if bf.length is
-	// zero.  In that case, we need to give it a death kiss.
-	if(bf->length() == 0)
+
+	// wake the dispatcher up if it is waiting for events; if it is not,
+	// it will go through its loop once more and find the buffer empty.
+	if(container->dispatcherParked)
+	{
+		container->dispatcherParked = false;
+		container->eventAvailable.post();
+	}
+}
+
+void Dispatcher::waitForEvents()
+{
+	AsyncAppender::WaitStrategy strategy = container->waitStrategy;
+
+	if(strategy != AsyncAppender::BLOCK)
+	{
+		// the number of events is read without the lock: a stale value
+		// only delays the check to the next iteration.
+		for(int i = 0; i < spinCount; i++)
+		{
+			if(bf->length() != 0 || interrupted)
+			{
+				// spinning was worth it: spin longer next time
+				if(strategy == AsyncAppender::PARK && spinCount < MAX_SPIN_COUNT)
+				{
+					spinCount *= 2;
+				}
+				return;
+			}
+		}
+
+		switch(strategy)
+		{
+		case AsyncAppender::SPIN:
+			return;
+
+		case AsyncAppender::YIELD:
+			Thread::yield();
+			return;
+
+		default:
+			for(int i = 0; i < YIELD_COUNT; i++)
+			{
+				Thread::yield();
+				if(bf->length() != 0 || interrupted)
+				{
+					return;
+				}
+			}
+
+			// going to park: spin less next time
+			if(spinCount > MIN_SPIN_COUNT)
+			{
+				spinCount /= 2;
+			}
+			break;
+		}
+	}
+
 	{
-		bf->notify();
+		synchronized sync(bf);
+
+		if(bf->length() != 0 || interrupted)
+		{
+			return;
+		}
+
+		container->dispatcherParked = true;
 	}
+
+	container->eventAvailable.wait();
 }
 
 void Dispatcher::run()
 {
 	LoggingEvent * event;
+	int64 enqueued = 0;
 
 	while(true)
 	{
+		bool empty;
 		{
 			synchronized sync(bf);
-			
-			if(bf->length() == 0)
+
+			empty = (bf->length() == 0);
+
+			// Exit loop if interrupted but only if
+			// the buffer is empty.
+			if(empty && interrupted)
 			{
-				// Exit loop if interrupted but only if
-				// the buffer is empty.
-				if(interrupted)
-				{
-					break;
-				}
-				bf->wait();
+				break;
 			}
+		} // synchronized
+
+		if(empty)
+		{
+			waitForEvents();
+			continue;
+		}
+
+		container->dispatchCs.lock();
+
+		{
+			synchronized sync(bf);
 			
-			event = bf->get();
-			if(bf->wasFull())
-			{
-				bf->notify();
-			}
+			event = bf->get(&enqueued);
+			container->notifyWaitingProducers();
 		} // synchronized
 
 		if(event != 0)
 		{
-			container->appendLoopOnAppenders(*event);
-			delete event;
+			int64 dispatched = Clock::monotonicMicros();
+			if(container->fanOut)
+			{
+				// the sinks delete the event once they have written it
+				container->fanOutEvent(event);
+			}
+			else
+			{
+				container->appendLoopOnAppenders(*event);
+				delete event;
+			}
+			container->eventDispatched(enqueued, dispatched,
+				Clock::monotonicMicros());
 		}
+
+		container->dispatchCs.unlock();
 	} // while
 
+	// write the events queued for each appender before closing them
+	if(container->fanOut)
+	{
+		container->closeSinks();
+	}
+
 	// close and remove all appenders
 	container->removeAllAppenders();
+	container->dispatcherEnded.post();
 }
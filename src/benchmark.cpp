@@ -0,0 +1,498 @@
+/***************************************************************************
+                          benchmark.cpp  -  description
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/logger.h>
+#include <log4cxx/level.h>
+#include <log4cxx/appenderskeleton.h>
+#include <log4cxx/asyncappender.h>
+#include <log4cxx/patternlayout.h>
+#include <log4cxx/fileappender.h>
+#include <log4cxx/spi/loggingevent.h>
+#include <log4cxx/helpers/performancecounters.h>
+#include <log4cxx/helpers/clock.h>
+#include <log4cxx/helpers/threadspecificdata.h>
+#include <log4cxx/helpers/thread.h>
+#include <log4cxx/helpers/semaphore.h>
+#include <iomanip>
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace log4cxx;
+using namespace log4cxx::helpers;
+using namespace log4cxx::spi;
+
+/** Appender which drops the events. */
+class NullAppender : public AppenderSkeleton
+{
+public:
+	void append(const LoggingEvent&) {}
+	void close() {}
+	bool requiresLayout() { return false; }
+};
+
+/** Allocations of a thread. */
+struct AllocationCounter
+{
+	long count;
+	long bytes;
+};
+
+/** Counter of the current thread, if its allocations are counted. */
+ThreadSpecificData * allocationCounter = 0;
+
+inline void * allocate(size_t size)
+{
+	if (allocationCounter != 0)
+	{
+		AllocationCounter * counter =
+			(AllocationCounter *)allocationCounter->GetData();
+		if (counter != 0)
+		{
+			counter->count++;
+			counter->bytes += (long)size;
+		}
+	}
+
+	return malloc(size == 0 ? 1 : size);
+}
+
+void * operator new(size_t size)
+{
+	void * p = allocate(size);
+	if (p == 0)
+	{
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void * operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void * operator new(size_t size, const std::nothrow_t&) throw()
+{
+	return allocate(size);
+}
+
+void * operator new[](size_t size, const std::nothrow_t&) throw()
+{
+	return allocate(size);
+}
+
+void operator delete(void * p) throw()
+{
+	free(p);
+}
+
+void operator delete[](void * p) throw()
+{
+	free(p);
+}
+
+// the sized forms are called instead of the ones above by the compilers
+// which enable sized deallocation
+void operator delete(void * p, size_t) throw()
+{
+	free(p);
+}
+
+void operator delete[](void * p, size_t) throw()
+{
+	free(p);
+}
+
+void operator delete(void * p, const std::nothrow_t&) throw()
+{
+	free(p);
+}
+
+void operator delete[](void * p, const std::nothrow_t&) throw()
+{
+	free(p);
+}
+
+typedef void (*Scenario)(int iterations);
+
+LoggerPtr disabledLogger;
+LoggerPtr nullLogger;
+LoggerPtr asyncLogger;
+LayoutPtr layout;
+LoggingEvent * layoutEvent;
+
+void disabledStatement(int iterations)
+{
+	for (int i = 0; i < iterations; i++)
+	{
+		LOG4CXX_DEBUG(disabledLogger, _T("message ") << i);
+	}
+}
+
+void nullAppender(int iterations)
+{
+	for (int i = 0; i < iterations; i++)
+	{
+		LOG4CXX_INFO(nullLogger, _T("message ") << i);
+	}
+}
+
+void patternLayout(int iterations)
+{
+	tostringstream output;
+	for (int i = 0; i < iterations; i++)
+	{
+		output.seekp(0);
+		layout->format(output, *layoutEvent);
+	}
+}
+
+void asyncEnqueue(int iterations)
+{
+	for (int i = 0; i < iterations; i++)
+	{
+		LOG4CXX_INFO(asyncLogger, _T("message ") << i);
+	}
+}
+
+/**
+Runs <code>scenario</code> once to warm up, then measures it and writes
+the time and the counters per operation.
+*/
+void run(const TCHAR * name, Scenario scenario, int iterations,
+	PerformanceCounters& counters)
+{
+	scenario(iterations / 10 + 1);
+
+	int64 begin = Clock::monotonicMicros();
+	counters.start();
+	scenario(iterations);
+	counters.stop();
+	int64 end = Clock::monotonicMicros();
+
+	tcout << std::left << std::setw(18) << name << std::right
+		<< std::fixed << std::setprecision(1)
+		<< std::setw(10) << (end - begin) * 1000.0 / iterations;
+
+	for (int c = 0; c < PerformanceCounters::COUNTER_COUNT; c++)
+	{
+		int64 value = counters.getValue((PerformanceCounters::Counter)c);
+		if (value < 0)
+		{
+			tcout << std::setw(15) << _T("n/a");
+		}
+		else
+		{
+			tcout << std::setw(15) << (double)value / iterations;
+		}
+	}
+
+	tcout << std::endl;
+}
+
+/** Runs a scenario in a thread once the start semaphore is posted. */
+class ScenarioRunner : public Runnable, public ObjectImpl
+{
+public:
+	ScenarioRunner(Scenario scenario, int iterations,
+		Semaphore& start, Semaphore& done)
+	: scenario(scenario), iterations(iterations), start(start), done(done)
+	{
+	}
+
+	void run()
+	{
+		start.wait();
+		scenario(iterations);
+		done.post();
+	}
+
+	Scenario scenario;
+	int iterations;
+	Semaphore& start;
+	Semaphore& done;
+};
+
+/**
+Runs <code>scenario</code> in <code>threads</code> threads at the same
+time, each one <code>iterations</code> times, and writes the time per
+operation and the number of operations per second of all the threads.
+*/
+void runThreads(const TCHAR * name, Scenario scenario, int iterations,
+	int threads)
+{
+	scenario(iterations / 10 + 1);
+
+	Semaphore start, done;
+	for (int t = 0; t < threads; t++)
+	{
+		Thread * thread = new Thread(
+			new ScenarioRunner(scenario, iterations, start, done));
+		thread->start();
+	}
+
+	int64 begin = Clock::monotonicMicros();
+	for (int t = 0; t < threads; t++)
+	{
+		start.post();
+	}
+	for (int t = 0; t < threads; t++)
+	{
+		done.wait();
+	}
+	int64 end = Clock::monotonicMicros();
+
+	tostringstream label;
+	label << name << _T(" x") << threads;
+	tcout << std::left << std::setw(18) << label.str() << std::right
+		<< std::fixed << std::setprecision(1)
+		<< std::setw(10) << (end - begin) * 1000.0 / iterations
+		<< std::setw(15)
+		<< (double)iterations * threads / (end - begin) << std::endl;
+}
+
+/** A stage of the pipeline of an audited configuration. */
+class Stage
+{
+public:
+	virtual ~Stage() {}
+	virtual void run(const LoggingEvent& event) = 0;
+};
+
+/** Creates the event, as Logger#forcedLog does. */
+class EventStage : public Stage
+{
+public:
+	EventStage(const LoggerPtr& logger, const tstring& message)
+	: logger(logger), message(message) {}
+	void run(const LoggingEvent&)
+		{ LoggingEvent event(logger, Level::INFO, message); }
+	LoggerPtr logger;
+	tstring message;
+};
+
+/** Passes the event to AppenderSkeleton#doAppend, without output. */
+class DoAppendStage : public Stage
+{
+public:
+	DoAppendStage(const AppenderPtr& appender) : appender(appender) {}
+	void run(const LoggingEvent& event)
+		{ appender->doAppend(event); }
+	AppenderPtr appender;
+};
+
+/** Formats the event into a reused stream. */
+class FormatStage : public Stage
+{
+public:
+	FormatStage(const LayoutPtr& layout) : layout(layout) {}
+	void run(const LoggingEvent& event)
+		{ output.seekp(0); layout->format(output, event); }
+	LayoutPtr layout;
+	tostringstream output;
+};
+
+/** Logs the message through the whole pipeline, which calls
+Logger#forcedLog. */
+class LoggerStage : public Stage
+{
+public:
+	LoggerStage(const LoggerPtr& logger, const tstring& message)
+	: logger(logger), message(message) {}
+	void run(const LoggingEvent&)
+		{ logger->info(message); }
+	LoggerPtr logger;
+	tstring message;
+};
+
+/**
+Runs <code>stage</code> once per event to warm up, then counts the
+allocations of the current thread while it runs again and writes them
+per event. Returns the number of allocations per event.
+*/
+double audit(const TCHAR * name, Stage& stage, const LoggingEvent& event,
+	int iterations)
+{
+	AllocationCounter counter = { 0, 0 };
+
+	for (int i = 0; i < iterations; i++)
+	{
+		stage.run(event);
+	}
+
+	allocationCounter->SetData(&counter);
+	for (int i = 0; i < iterations; i++)
+	{
+		stage.run(event);
+	}
+	allocationCounter->SetData(0);
+
+	double count = (double)counter.count / iterations;
+	tcout << _T("  ") << std::left << std::setw(16) << name << std::right
+		<< std::fixed << std::setprecision(2)
+		<< std::setw(10) << count
+		<< std::setw(12) << (double)counter.bytes / iterations << std::endl;
+
+	return count;
+}
+
+/**
+Counts the heap allocations per event of each stage of the pipeline
+Logger#forcedLog, AppenderSkeleton#doAppend, PatternLayout#format and
+FileAppender, for several patterns. Returns 1 if the whole pipeline of
+a configuration allocates more than <code>limit</code> times per
+event, <code>limit</code> being ignored if it is negative.
+*/
+int auditAllocations(int iterations, double limit)
+{
+	static const TCHAR * patterns[] =
+	{
+		_T("%m%n"),
+		_T("%-5p %c - %m%n"),
+		_T("%d %-5p [%t] %c - %m%n"),
+		_T("%d{ISO8601} %-5p [%t] %c{2} %x - %m%n")
+	};
+
+	allocationCounter = new ThreadSpecificData();
+
+	tstring message = _T("message of the allocation audit, longer than a short string");
+	LoggerPtr logger = Logger::getLogger(_T("benchmark.audit"));
+	logger->setLevel(Level::INFO);
+	logger->setAdditivity(false);
+
+	int status = 0;
+	for (size_t p = 0; p < sizeof(patterns) / sizeof(patterns[0]); p++)
+	{
+		LayoutPtr layout = new PatternLayout(patterns[p]);
+		AppenderPtr nullAppender = new NullAppender();
+		AppenderPtr fileAppender =
+			new FileAppender(layout, _T("benchmark.log"), false);
+
+		logger->removeAllAppenders();
+		logger->addAppender(fileAppender);
+
+		LoggingEvent event(logger, Level::INFO, message);
+
+		EventStage eventStage(logger, message);
+		DoAppendStage doAppendStage(nullAppender);
+		FormatStage formatStage(layout);
+		DoAppendStage fileStage(fileAppender);
+		LoggerStage loggerStage(logger, message);
+
+		tcout << patterns[p] << std::endl;
+		tcout << _T("  ") << std::left << std::setw(16) << _T("stage")
+			<< std::right << std::setw(10) << _T("allocs")
+			<< std::setw(12) << _T("bytes") << std::endl;
+		audit(_T("event"), eventStage, event, iterations);
+		audit(_T("doAppend"), doAppendStage, event, iterations);
+		audit(_T("format"), formatStage, event, iterations);
+		audit(_T("file"), fileStage, event, iterations);
+		double count =
+			audit(_T("logger"), loggerStage, event, iterations);
+
+		if (limit >= 0 && count > limit)
+		{
+			tcout << _T("  more than ") << limit
+				<< _T(" allocations per event") << std::endl;
+			status = 1;
+		}
+
+		logger->removeAllAppenders();
+	}
+
+	return status;
+}
+
+int main(int argc, char * argv[])
+{
+	if (argc > 1 && strcmp(argv[1], "-allocations") == 0)
+	{
+		double limit = argc > 2 ? strtod(argv[2], 0) : -1;
+		return auditAllocations(10000, limit);
+	}
+
+	int iterations = 1000000;
+	if (argc > 1)
+	{
+		iterations = strtol(argv[1], 0, 10);
+	}
+
+	int threads = 4;
+	if (argc > 2)
+	{
+		threads = strtol(argv[2], 0, 10);
+	}
+
+	if (iterations <= 0 || threads <= 0)
+	{
+		tcout << _T("Usage: benchmark [iterations [threads]]") << std::endl;
+		tcout << _T("       benchmark -allocations [limit]") << std::endl;
+		return 1;
+	}
+
+	disabledLogger = Logger::getLogger(_T("benchmark.disabled"));
+	disabledLogger->setLevel(Level::WARN);
+	disabledLogger->setAdditivity(false);
+
+	nullLogger = Logger::getLogger(_T("benchmark.null"));
+	nullLogger->setLevel(Level::INFO);
+	nullLogger->setAdditivity(false);
+	nullLogger->addAppender(new NullAppender());
+
+	AsyncAppender * asyncAppender = new AsyncAppender();
+	asyncAppender->addAppender(new NullAppender());
+	asyncAppender->activateOptions();
+	asyncLogger = Logger::getLogger(_T("benchmark.async"));
+	asyncLogger->setLevel(Level::INFO);
+	asyncLogger->setAdditivity(false);
+	asyncLogger->addAppender(asyncAppender);
+
+	layout = new PatternLayout(_T("%d %-5p [%t] %c - %m%n"));
+	layoutEvent = new LoggingEvent(nullLogger, Level::INFO,
+		_T("formatted message"));
+
+	// the counters count the events of this thread only: the dispatch
+	// thread of the AsyncAppender is not counted
+	PerformanceCounters counters;
+
+	tcout << std::left << std::setw(18) << _T("scenario") << std::right
+		<< std::setw(10) << _T("ns/op");
+	for (int c = 0; c < PerformanceCounters::COUNTER_COUNT; c++)
+	{
+		tcout << std::setw(15)
+			<< PerformanceCounters::getName((PerformanceCounters::Counter)c);
+	}
+	tcout << std::endl;
+
+	run(_T("disabled"), disabledStatement, iterations, counters);
+	run(_T("null appender"), nullAppender, iterations, counters);
+	run(_T("pattern layout"), patternLayout, iterations, counters);
+	run(_T("async enqueue"), asyncEnqueue, iterations, counters);
+
+	// the same statements from several threads: the disabled check and
+	// the appender snapshot of the logger are read without any lock
+	tcout << std::endl << std::left << std::setw(18) << _T("scenario")
+		<< std::right << std::setw(10) << _T("ns/op")
+		<< std::setw(15) << _T("M op/s") << std::endl;
+	runThreads(_T("disabled"), disabledStatement, iterations, threads);
+	runThreads(_T("null appender"), nullAppender, iterations, threads);
+
+	asyncAppender->close();
+	delete layoutEvent;
+
+	return 0;
+}
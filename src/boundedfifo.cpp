@@ -21,7 +21,8 @@
 using namespace log4cxx::helpers;
 using namespace log4cxx::spi;
 
-BoundedFIFO::BoundedFIFO(int maxSize) : numElements(0), first(0), next(0)
+BoundedFIFO::BoundedFIFO(int maxSize)
+: numElements(0), first(0), next(0), maxSize(maxSize)
 {
 	if(maxSize < 1)
 	{
@@ -31,9 +32,23 @@ BoundedFIFO::BoundedFIFO(int maxSize) : numElements(0), first(0), next(0)
 		throw new IllegalArgumentException(oss.str());
 	}
 	buf = new LoggingEvent *[maxSize];
+	stamps = new int64[maxSize];
 }
 
-LoggingEvent * BoundedFIFO::get()
+BoundedFIFO::~BoundedFIFO()
+{
+	// events which were never dispatched
+	LoggingEvent * event;
+	while((event = get()) != 0)
+	{
+		delete event;
+	}
+
+	delete [] buf;
+	delete [] stamps;
+}
+
+LoggingEvent * BoundedFIFO::get(int64 * stamp)
 {
 	if(numElements == 0)
 	{
@@ -42,6 +57,10 @@ LoggingEvent * BoundedFIFO::get()
 
 	LoggingEvent * r = buf[first];
 	buf[first] = 0;
+	if(stamp != 0)
+	{
+		*stamp = stamps[first];
+	}
 
 	if(++first == maxSize)
 	{
@@ -52,11 +71,12 @@ LoggingEvent * BoundedFIFO::get()
 	return r;
 }
 
-void BoundedFIFO::put(log4cxx::spi::LoggingEvent * o)
+void BoundedFIFO::put(log4cxx::spi::LoggingEvent * o, int64 stamp)
 {
 	if(numElements != maxSize)
 	{
 		buf[next] = o;
+		stamps[next] = stamp;
 		if(++next == maxSize)
 		{
 			next = 0;
@@ -75,34 +95,32 @@ void BoundedFIFO::resize(int newSize)
 	}
 
 	LoggingEvent * * tmp = new LoggingEvent *[newSize];
+	int64 * tmpStamps = new int64[newSize];
 
-	// we should not copy beyond the buf array
-	int len1 = maxSize - first;
-
-	// we should not copy beyond the tmp array
-	len1 = min(len1, newSize);
-
-	// er.. how much do we actually need to copy?
-	// We should not copy more than the actual number of elements.
-	len1 = min(len1, numElements);
-
-	// Copy from buf starting a first, to tmp, starting at position 0, len1
-	memcpy(tmp, buf + first, len1 * sizeof(LoggingEvent *));
-
-	// Are there any uncopied elements and
-	// is there still space in the new array?
-	int len2 = 0;
-	if((len1 < numElements) && (len1 < newSize))
+	// copy the oldest events first; the ones which do not fit in the new
+	// buffer are lost
+	int kept = min(numElements, newSize);
+	for(int i = 0; i < numElements; i++)
 	{
-		len2 = numElements - len1;
-		len2 = min(len2, newSize - len1);
-		memcpy(tmp, buf + len1, len2 * sizeof(LoggingEvent *));
+		int index = (first + i) % maxSize;
+		if(i < kept)
+		{
+			tmp[i] = buf[index];
+			tmpStamps[i] = stamps[index];
+		}
+		else
+		{
+			delete buf[index];
+		}
 	}
 
+	delete [] buf;
+	delete [] stamps;
 	this->buf = tmp;
+	this->stamps = tmpStamps;
 	this->maxSize = newSize;
 	this->first=0;
-	this->numElements = len1+len2;
+	this->numElements = kept;
 	this->next = this->numElements;
 
 	// this should never happen, but again, it just might.
@@ -0,0 +1,91 @@
+/***************************************************************************
+                          byterange.cpp  -  class ByteRange
+                             -------------------
+    begin                : sam mai 24 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/helpers/byterange.h>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+using namespace log4cxx::helpers;
+
+long ByteRange::write(int fd, const ByteRange * ranges, int count)
+{
+	long total = 0;
+
+#ifdef WIN32
+	for (int i = 0; i < count; i++)
+	{
+		const char * p = (const char *)ranges[i].data;
+		size_t left = ranges[i].length;
+		while (left > 0)
+		{
+			int written = ::_write(fd, p, (unsigned int)left);
+			if (written <= 0)
+			{
+				return -1;
+			}
+			p += written;
+			left -= written;
+			total += written;
+		}
+	}
+#else
+	// number of ranges passed to each writev call, under IOV_MAX
+	enum { VECTOR_SIZE = 64 };
+	struct iovec vector[VECTOR_SIZE];
+
+	// first range not completely written, and what is written of it
+	int index = 0;
+	size_t offset = 0;
+
+	while (index < count)
+	{
+		int n = 0;
+		for (int i = index; i < count && n < VECTOR_SIZE; i++, n++)
+		{
+			size_t skip = (i == index) ? offset : 0;
+			vector[n].iov_base = (char *)ranges[i].data + skip;
+			vector[n].iov_len = ranges[i].length - skip;
+		}
+
+		ssize_t written = ::writev(fd, vector, n);
+		if (written < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			return -1;
+		}
+
+		total += written;
+		offset += written;
+		while (index < count && offset >= ranges[index].length)
+		{
+			offset -= ranges[index].length;
+			index++;
+		}
+	}
+#endif
+
+	return total;
+}
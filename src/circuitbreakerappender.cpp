@@ -0,0 +1,427 @@
+/***************************************************************************
+                          circuitbreakerappender.cpp  -  class CircuitBreakerAppender
+                             -------------------
+    begin                : jeu mai 22 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/circuitbreakerappender.h>
+#include <log4cxx/helpers/loglog.h>
+#include <log4cxx/helpers/stringhelper.h>
+#include <log4cxx/helpers/optionconverter.h>
+#include <log4cxx/helpers/interlocked.h>
+#include <log4cxx/helpers/clock.h>
+#include <log4cxx/spi/loggingevent.h>
+
+using namespace log4cxx;
+using namespace log4cxx::helpers;
+using namespace log4cxx::spi;
+
+int CircuitBreakerAppender::DEFAULT_LATENCY_THRESHOLD = 1000;
+int CircuitBreakerAppender::DEFAULT_FAILURE_THRESHOLD = 3;
+int CircuitBreakerAppender::DEFAULT_PROBE_INTERVAL = 10000;
+
+/** Number of milliseconds from <code>from</code> to <code>to</code>,
+which may have wrapped around. */
+static inline long elapsed(long from, long to)
+{
+	return (long)((unsigned long)to - (unsigned long)from);
+}
+
+CircuitBreakerAppender::CircuitBreakerAppender()
+: latencyThreshold(DEFAULT_LATENCY_THRESHOLD),
+failureThreshold(DEFAULT_FAILURE_THRESHOLD),
+probeInterval(DEFAULT_PROBE_INTERVAL), state(HEALTHY), failures(0),
+busySince(0), nextProbe(0), trips(0), divertedEvents(0), droppedEvents(0)
+{
+	appendersPtr = new Appenders();
+	appenders = appendersPtr;
+}
+
+CircuitBreakerAppender::~CircuitBreakerAppender()
+{
+	finalize();
+}
+
+void CircuitBreakerAppender::doAppend(const spi::LoggingEvent& event)
+{
+	if(closed)
+	{
+		LogLog::error(_T("Attempted to append to closed appender named [")
+			+name+_T("]."));
+		return;
+	}
+
+	if(!isAccepted(event))
+	{
+		return;
+	}
+
+	appendLimited(event);
+}
+
+void CircuitBreakerAppender::append(const spi::LoggingEvent& event)
+{
+	// the appenders can be replaced while events are appended: the
+	// replaced ones are kept until this thread is done with them.
+	Reclaimer::Reader reader(reclaimer);
+	const Appenders& appenders = *this->appenders;
+	const AppenderPtr& appender = appenders.appender;
+
+	if(appender == 0)
+	{
+		divert(appenders, event);
+		return;
+	}
+
+	long now = currentTimeMillis();
+
+	switch(state)
+	{
+	case HEALTHY:
+		{
+			// an append which lasts too long blocks the other threads:
+			// do not join them.
+			long since = busySince;
+			if(since != 0 && elapsed(since, now) > latencyThreshold)
+			{
+				trip(appenders, now, _T("is blocked"));
+				divert(appenders, event);
+				return;
+			}
+
+			if(tryAppend(appenders, event, now))
+			{
+				// avoid writing to a shared variable when not needed
+				if(failures != 0)
+				{
+					failures = 0;
+				}
+			}
+			else if(Interlocked::increment(&failures) >= failureThreshold)
+			{
+				trip(appenders, currentTimeMillis(),
+					_T("is too slow or failing"));
+			}
+		}
+		break;
+
+	case TRIPPED:
+		// only one thread probes the protected appender
+		if(elapsed(nextProbe, now) >= 0 &&
+			Interlocked::compareExchange(&state, PROBING, TRIPPED) == TRIPPED)
+		{
+			if(tryAppend(appenders, event, now))
+			{
+				failures = 0;
+				state = HEALTHY;
+				LogLog::warn(_T("Appender [") + appender->getName() +
+					_T("] has recovered, circuit breaker [") + name +
+					_T("] reset."));
+			}
+			else
+			{
+				nextProbe = currentTimeMillis() + probeInterval;
+				state = TRIPPED;
+			}
+		}
+		else
+		{
+			divert(appenders, event);
+		}
+		break;
+
+	default:
+		divert(appenders, event);
+		break;
+	}
+}
+
+bool CircuitBreakerAppender::tryAppend(const Appenders& appenders,
+	const spi::LoggingEvent& event, long start)
+{
+	// 0 means that no append is in progress
+	long mark = (start != 0) ? start : 1;
+
+	// the oldest append in progress is the one which is watched
+	Interlocked::compareExchange(&busySince, mark, 0);
+
+	bool succeeded = true;
+	try
+	{
+		appenders.appender->doAppend(event);
+	}
+	catch(Exception&)
+	{
+		succeeded = false;
+	}
+
+	Interlocked::compareExchange(&busySince, 0, mark);
+
+	if(!succeeded)
+	{
+		divert(appenders, event);
+		return false;
+	}
+
+	return elapsed(start, currentTimeMillis()) <= latencyThreshold;
+}
+
+void CircuitBreakerAppender::trip(const Appenders& appenders, long now,
+	const tstring& reason)
+{
+	nextProbe = now + probeInterval;
+
+	if(Interlocked::compareExchange(&state, TRIPPED, HEALTHY) != HEALTHY)
+	{
+		return;
+	}
+
+	Interlocked::increment(&trips);
+
+	const AppenderPtr& backupAppender = appenders.backupAppender;
+
+	tostringstream message;
+	message << _T("Appender [") << appenders.appender->getName()
+		<< _T("] ") << reason << _T(", circuit breaker [") << name
+		<< _T("] diverts its events to ");
+	if(backupAppender != 0)
+	{
+		message << _T("appender [") << backupAppender->getName() << _T("].");
+	}
+	else
+	{
+		message << _T("nowhere.");
+	}
+	errorHandler->error(message.str());
+}
+
+void CircuitBreakerAppender::divert(const Appenders& appenders,
+	const spi::LoggingEvent& event)
+{
+	const AppenderPtr& backupAppender = appenders.backupAppender;
+
+	if(backupAppender != 0)
+	{
+		Interlocked::increment(&divertedEvents);
+		backupAppender->doAppend(event);
+	}
+	else
+	{
+		Interlocked::increment(&droppedEvents);
+	}
+}
+
+long CircuitBreakerAppender::currentTimeMillis()
+{
+	return (long)(Clock::monotonicMicros() / 1000);
+}
+
+void CircuitBreakerAppender::setAppenders(const AppenderPtr& appender,
+	const AppenderPtr& backupAppender)
+{
+	AppendersPtr previous = appendersPtr;
+	if (previous->appender == appender &&
+		previous->backupAppender == backupAppender)
+	{
+		return;
+	}
+
+	AppendersPtr replacement = new Appenders();
+	replacement->appender = appender;
+	replacement->backupAppender = backupAppender;
+
+	// published with a barrier, after the pair is complete
+	Interlocked::compareExchange((void * volatile *)&appenders,
+		(Appenders *)replacement, (Appenders *)previous);
+	appendersPtr = replacement;
+
+	// the previous pair may still be read by other threads
+	reclaimer.retire(previous);
+}
+
+void CircuitBreakerAppender::close()
+{
+	synchronized sync(this);
+
+	if(closed)
+	{
+		return;
+	}
+
+	closed = true;
+
+	if(appendersPtr->appender != 0)
+	{
+		appendersPtr->appender->close();
+	}
+
+	if(appendersPtr->backupAppender != 0)
+	{
+		appendersPtr->backupAppender->close();
+	}
+}
+
+void CircuitBreakerAppender::addAppender(AppenderPtr newAppender)
+{
+	synchronized sync(this);
+
+	const AppenderPtr& appender = appendersPtr->appender;
+	const AppenderPtr& backupAppender = appendersPtr->backupAppender;
+
+	if(newAppender == 0 || newAppender == appender ||
+		newAppender == backupAppender)
+	{
+		return;
+	}
+
+	if(appender == 0)
+	{
+		setAppenders(newAppender, backupAppender);
+	}
+	else if(backupAppender == 0)
+	{
+		setAppenders(appender, newAppender);
+	}
+	else
+	{
+		LogLog::warn(_T("Circuit breaker [") + name +
+			_T("] already has a backup appender, ignoring appender [") +
+			newAppender->getName() + _T("]."));
+	}
+}
+
+AppenderList CircuitBreakerAppender::getAllAppenders()
+{
+	synchronized sync(this);
+
+	AppenderList appenders;
+
+	if(appendersPtr->appender != 0)
+	{
+		appenders.push_back(appendersPtr->appender);
+	}
+
+	if(appendersPtr->backupAppender != 0)
+	{
+		appenders.push_back(appendersPtr->backupAppender);
+	}
+
+	return appenders;
+}
+
+AppenderPtr CircuitBreakerAppender::getAppender(const tstring& name)
+{
+	synchronized sync(this);
+
+	const AppenderPtr& appender = appendersPtr->appender;
+	const AppenderPtr& backupAppender = appendersPtr->backupAppender;
+
+	if(appender != 0 && appender->getName() == name)
+	{
+		return appender;
+	}
+
+	if(backupAppender != 0 && backupAppender->getName() == name)
+	{
+		return backupAppender;
+	}
+
+	return 0;
+}
+
+bool CircuitBreakerAppender::isAttached(AppenderPtr appender)
+{
+	synchronized sync(this);
+
+	return appender != 0 && (appender == appendersPtr->appender ||
+		appender == appendersPtr->backupAppender);
+}
+
+void CircuitBreakerAppender::removeAllAppenders()
+{
+	synchronized sync(this);
+
+	setAppenders(0, 0);
+}
+
+void CircuitBreakerAppender::removeAppender(AppenderPtr appender)
+{
+	synchronized sync(this);
+
+	if(appender == 0)
+	{
+		return;
+	}
+
+	if(appender == appendersPtr->appender)
+	{
+		setAppenders(0, appendersPtr->backupAppender);
+	}
+	else if(appender == appendersPtr->backupAppender)
+	{
+		setAppenders(appendersPtr->appender, 0);
+	}
+}
+
+void CircuitBreakerAppender::removeAppender(const tstring& name)
+{
+	removeAppender(getAppender(name));
+}
+
+void CircuitBreakerAppender::setAppender(AppenderPtr appender)
+{
+	synchronized sync(this);
+	setAppenders(appender, appendersPtr->backupAppender);
+}
+
+AppenderPtr CircuitBreakerAppender::getAppender()
+{
+	synchronized sync(this);
+	return appendersPtr->appender;
+}
+
+void CircuitBreakerAppender::setBackupAppender(AppenderPtr backupAppender)
+{
+	synchronized sync(this);
+	setAppenders(appendersPtr->appender, backupAppender);
+}
+
+AppenderPtr CircuitBreakerAppender::getBackupAppender()
+{
+	synchronized sync(this);
+	return appendersPtr->backupAppender;
+}
+
+void CircuitBreakerAppender::setOption(const tstring& option,
+	const tstring& value)
+{
+	if (StringHelper::equalsIgnoreCase(option, _T("latencythreshold")))
+	{
+		setLatencyThreshold(OptionConverter::toInt(value,
+			DEFAULT_LATENCY_THRESHOLD));
+	}
+	else if (StringHelper::equalsIgnoreCase(option, _T("failurethreshold")))
+	{
+		setFailureThreshold(OptionConverter::toInt(value,
+			DEFAULT_FAILURE_THRESHOLD));
+	}
+	else if (StringHelper::equalsIgnoreCase(option, _T("probeinterval")))
+	{
+		setProbeInterval(OptionConverter::toInt(value,
+			DEFAULT_PROBE_INTERVAL));
+	}
+	else
+	{
+		AppenderSkeleton::setOption(option, value);
+	}
+}
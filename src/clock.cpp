@@ -0,0 +1,58 @@
+/***************************************************************************
+                          clock.cpp  -  class Clock
+                             -------------------
+    begin                : mer mai 21 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/helpers/clock.h>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#include <time.h>
+#endif
+
+using namespace log4cxx::helpers;
+
+int64 Clock::monotonicMicros()
+{
+#ifdef WIN32
+	LARGE_INTEGER frequency, counter;
+	::QueryPerformanceFrequency(&frequency);
+	::QueryPerformanceCounter(&counter);
+	return counter.QuadPart / frequency.QuadPart * 1000000
+		+ counter.QuadPart % frequency.QuadPart * 1000000 / frequency.QuadPart;
+#elif defined(CLOCK_MONOTONIC)
+	timespec ts;
+	::clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#else
+	return currentTimeMicros();
+#endif
+}
+
+int64 Clock::currentTimeMicros()
+{
+#ifdef WIN32
+	// FILETIME counts 100 ns intervals since 01.01.1601
+	FILETIME ft;
+	::GetSystemTimeAsFileTime(&ft);
+	int64 t = ((int64)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+	return (t - 116444736000000000i64) / 10;
+#else
+	timeval tv;
+	::gettimeofday(&tv, 0);
+	return (int64)tv.tv_sec * 1000000 + tv.tv_usec;
+#endif
+}
@@ -16,9 +16,7 @@
 
 #include <log4cxx/helpers/criticalsection.h>
 
-#ifdef HAVE_PTHREAD_H
-#include <pthread.h>
-#elif defined(WIN32)
+#if !defined(HAVE_PTHREAD_H) && defined(WIN32)
 #include <windows.h>
 #endif
 
@@ -27,8 +25,7 @@ using namespace log4cxx::helpers;
 CriticalSection::CriticalSection()
 {
 #ifdef HAVE_PTHREAD_H
-	mutex = new pthread_mutex_t;
-	pthread_mutex_init((pthread_mutex_t*)mutex, NULL);
+	pthread_mutex_init(&mutex, NULL);
 #elif defined(WIN32)
 	mutex = new CRITICAL_SECTION;
 	InitializeCriticalSection((CRITICAL_SECTION *)mutex);
@@ -38,8 +35,7 @@ CriticalSection::CriticalSection()
 CriticalSection::~CriticalSection()
 {
 #ifdef HAVE_PTHREAD_H
-	pthread_mutex_destroy((pthread_mutex_t*)mutex);
-	delete (pthread_mutex_t*)mutex;
+	pthread_mutex_destroy(&mutex);
 #elif defined(WIN32)
 	DeleteCriticalSection((CRITICAL_SECTION *)mutex);
 	delete (CRITICAL_SECTION *)mutex;
@@ -49,16 +45,40 @@ CriticalSection::~CriticalSection()
 void CriticalSection::lock()
 {
 #ifdef HAVE_PTHREAD_H
-	pthread_mutex_lock((pthread_mutex_t*)mutex);
+	pthread_mutex_lock(&mutex);
 #elif defined(WIN32)
 	EnterCriticalSection((CRITICAL_SECTION *)mutex);
 #endif
 }
 
+bool CriticalSection::tryLock()
+{
+#ifdef HAVE_PTHREAD_H
+	return pthread_mutex_trylock(&mutex) == 0;
+#elif defined(WIN32)
+	if (!TryEnterCriticalSection((CRITICAL_SECTION *)mutex))
+	{
+		return false;
+	}
+
+	// a critical section can be entered again by its owner: leave it
+	// in this case, as a pthread mutex would fail.
+	if (((CRITICAL_SECTION *)mutex)->RecursionCount > 1)
+	{
+		LeaveCriticalSection((CRITICAL_SECTION *)mutex);
+		return false;
+	}
+
+	return true;
+#else
+	return true;
+#endif
+}
+
 void CriticalSection::unlock()
 {
 #ifdef HAVE_PTHREAD_H
-	pthread_mutex_unlock((pthread_mutex_t*)mutex);
+	pthread_mutex_unlock(&mutex);
 #elif defined(WIN32)
 	LeaveCriticalSection((CRITICAL_SECTION *)mutex);
 #endif
@@ -25,47 +25,270 @@ tstring AbsoluteTimeDateFormat::ISO8601_DATE_FORMAT = _T("ISO8601");
 tstring AbsoluteTimeDateFormat::ABS_TIME_DATE_FORMAT = _T("ABSOLUTE");
 tstring AbsoluteTimeDateFormat::DATE_AND_TIME_DATE_FORMAT = _T("DATE");
 
+/** "00" to "99" */
+static const char digitPairs[] =
+	"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+	"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+/** Writes <code>value</code> on <code>width</code> digits, zero padded. */
+static void writeNumber(TCHAR * p, long value, int width)
+{
+	p += width;
+	while (width >= 2)
+	{
+		const char * pair = digitPairs + (value % 100) * 2;
+		*--p = (TCHAR)pair[1];
+		*--p = (TCHAR)pair[0];
+		value /= 100;
+		width -= 2;
+	}
+
+	if (width > 0)
+	{
+		*--p = (TCHAR)(_T('0') + value % 10);
+	}
+}
+
+/** Appends <code>value</code> on <code>width</code> digits, zero padded. */
+static void appendNumber(tstring& s, long value, int width)
+{
+	TCHAR buffer[16];
+	writeNumber(buffer, value, width);
+	s.append(buffer, width);
+}
+
 DateFormat::DateFormat(const tstring& dateFormat, const tstring& timeZone)
- : dateFormat(dateFormat), timeZone(timeZone)
+ : dateFormat(dateFormat), timeZone(TimeZone::getTimeZone(timeZone)),
+ localeDependent(false), cachedTime(0), cacheValid(false)
 {
+	compile();
 }
 
-void DateFormat::format(tostream& os, time_t time)
+void DateFormat::compile()
+{
+	tstring::size_type i = 0;
+	while (i < dateFormat.length())
+	{
+		Field field;
+		field.type = LITERAL;
+
+		if (dateFormat[i] != _T('%') || i + 1 == dateFormat.length())
+		{
+			field.text = dateFormat[i++];
+		}
+		else
+		{
+			TCHAR c = dateFormat[i + 1];
+			i += 2;
+
+			// the composite conversions are expanded
+			const TCHAR * expansion = 0;
+			switch (c)
+			{
+			case _T('Y'): field.type = YEAR; break;
+			case _T('y'): field.type = YEAR_OF_CENTURY; break;
+			case _T('m'): field.type = MONTH; break;
+			case _T('d'): field.type = DAY; break;
+			case _T('e'): field.type = DAY_SPACE_PADDED; break;
+			case _T('j'): field.type = DAY_OF_YEAR; break;
+			case _T('H'): field.type = HOUR; break;
+			case _T('I'): field.type = HOUR_12; break;
+			case _T('M'): field.type = MINUTE; break;
+			case _T('S'): field.type = SECOND; break;
+			case _T('Q'): field.type = MILLISECOND; break;
+			case _T('f'): field.type = MICROSECOND; break;
+			case _T('N'): field.type = NANOSECOND; break;
+			case _T('z'): field.type = ZONE_OFFSET; break;
+			case _T('Z'): field.type = ZONE_NAME; break;
+			case _T('%'): field.text = _T('%'); break;
+			case _T('n'): field.text = _T('\n'); break;
+			case _T('t'): field.text = _T('\t'); break;
+			case _T('T'): expansion = _T("%H:%M:%S"); break;
+			case _T('R'): expansion = _T("%H:%M"); break;
+			case _T('F'): expansion = _T("%Y-%m-%d"); break;
+			case _T('D'): expansion = _T("%m/%d/%y"); break;
+			default:
+				field.type = LOCALE_DEPENDENT;
+				field.text = tstring(_T("%")) + c;
+
+				// E and O modify the next conversion
+				if ((c == _T('E') || c == _T('O')) && i < dateFormat.length())
+				{
+					field.text += dateFormat[i++];
+				}
+
+				localeDependent = true;
+				break;
+			}
+
+			if (expansion != 0)
+			{
+				dateFormat.replace(i - 2, 2, expansion);
+				i -= 2;
+				continue;
+			}
+		}
+
+		if (field.type == LITERAL && !fields.empty()
+			&& fields.back().type == LITERAL)
+		{
+			fields.back().text += field.text;
+		}
+		else
+		{
+			fields.push_back(field);
+		}
+	}
+}
+
+void DateFormat::toLocalTime(time_t time, struct tm& tm)
+{
+	// the offset of the time zone is cached until its next transition:
+	// the local time is computed as a time in UTC.
+	time_t localTime = time + timeZone->getOffset(time);
+
+#ifdef WIN32
+	tm = *gmtime(&localTime);
+#else
+	gmtime_r(&localTime, &tm);
+#endif
+	tm.tm_isdst = timeZone->inDaylightTime(time) ? 1 : 0;
+}
+
+void DateFormat::formatSecond(time_t time)
 {
 	typedef tostream::char_type char_type;
 	typedef tostream::traits_type traits_type;
 	typedef std::ostreambuf_iterator<char_type, traits_type> iterator_type;
 	typedef std::time_put< char_type, iterator_type > facet_type;
 
-	const tm * tm = gmtime(&time);
+	struct tm tm;
+	toLocalTime(time, tm);
+	std::locale loc = facetStream.getloc();
 
-	if (timeZone.empty())
-	{
-		std::locale loc = os.getloc();
+	cachedText.erase();
+	subSecondFields.clear();
 
+	std::vector<Field>::iterator it;
+	for (it = fields.begin(); it != fields.end(); it++)
+	{
+		switch (it->type)
+		{
+		case LITERAL:
+			cachedText += it->text;
+			break;
+		case YEAR:
+			appendNumber(cachedText, tm.tm_year + 1900, 4);
+			break;
+		case YEAR_OF_CENTURY:
+			appendNumber(cachedText, tm.tm_year % 100, 2);
+			break;
+		case MONTH:
+			appendNumber(cachedText, tm.tm_mon + 1, 2);
+			break;
+		case DAY:
+			appendNumber(cachedText, tm.tm_mday, 2);
+			break;
+		case DAY_SPACE_PADDED:
+			appendNumber(cachedText, tm.tm_mday, 2);
+			if (tm.tm_mday < 10)
+			{
+				cachedText[cachedText.length() - 2] = _T(' ');
+			}
+			break;
+		case DAY_OF_YEAR:
+			appendNumber(cachedText, tm.tm_yday + 1, 3);
+			break;
+		case HOUR:
+			appendNumber(cachedText, tm.tm_hour, 2);
+			break;
+		case HOUR_12:
+			appendNumber(cachedText, (tm.tm_hour + 11) % 12 + 1, 2);
+			break;
+		case MINUTE:
+			appendNumber(cachedText, tm.tm_min, 2);
+			break;
+		case SECOND:
+			appendNumber(cachedText, tm.tm_sec, 2);
+			break;
+		case ZONE_OFFSET:
+			{
+				long offset = timeZone->getOffset(time);
+				cachedText += (offset < 0) ? _T('-') : _T('+');
+				offset = (offset < 0) ? -offset : offset;
+				appendNumber(cachedText, offset / 3600, 2);
+				appendNumber(cachedText, offset / 60 % 60, 2);
+			}
+			break;
+		case ZONE_NAME:
+			cachedText += timeZone->getAbbreviation(time);
+			break;
+		case MILLISECOND:
+		case MICROSECOND:
+		case NANOSECOND:
+			// written for each date
+			subSecondFields.push_back(std::pair<size_t, FieldType>(
+				cachedText.length(), it->type));
+			cachedText.append((it->type == MILLISECOND) ? 3
+				: (it->type == MICROSECOND) ? 6 : 9, _T('0'));
+			break;
+		case LOCALE_DEPENDENT:
+			{
+				facetStream.str(tstring());
 #ifdef WIN32
-		const facet_type& facet = std::use_facet<facet_type>(loc, 0, true);
-		 facet.put(os,os,tm,dateFormat.c_str(), dateFormat.c_str() +
-			 dateFormat.size());
+				const facet_type& facet = std::use_facet<facet_type>(loc, 0, true);
+				facet.put(facetStream, facetStream, &tm, it->text.c_str(),
+					it->text.c_str() + it->text.size());
 #else
-		const facet_type& facet = std::use_facet<facet_type>(loc);
-		 facet.put(os,os,_T(' '),tm,dateFormat.c_str(), dateFormat.c_str() +
-			 dateFormat.size());
+				const facet_type& facet = std::use_facet<facet_type>(loc);
+				facet.put(facetStream, facetStream, _T(' '), &tm,
+					it->text.c_str(), it->text.c_str() + it->text.size());
 #endif
+				cachedText += facetStream.str();
+			}
+			break;
+		}
 	}
-	else
+
+	cachedTime = time;
+	cacheValid = true;
+}
+
+void DateFormat::format(tostream& os, time_t time, long microseconds)
+{
+	cacheCs.lock();
+
+	if (localeDependent && os.getloc() != facetStream.getloc())
 	{
-		USES_CONVERSION;
-		std::locale loc(T2A(timeZone.c_str()));
+		facetStream.imbue(os.getloc());
+		cacheValid = false;
+	}
 
-#ifdef WIN32
-		const facet_type& facet = std::use_facet<facet_type>(loc, 0, true);
-		 facet.put(os,os,tm,dateFormat.c_str(), dateFormat.c_str() +
-			 dateFormat.size());
-#else
-		const facet_type& facet = std::use_facet<facet_type>(loc);
-		 facet.put(os,os,_T(' '),tm,dateFormat.c_str(), dateFormat.c_str() +
-			 dateFormat.size());
-#endif
+	if (!cacheValid || time != cachedTime)
+	{
+		formatSecond(time);
 	}
+
+	std::vector< std::pair<size_t, FieldType> >::iterator it;
+	for (it = subSecondFields.begin(); it != subSecondFields.end(); it++)
+	{
+		TCHAR * p = &cachedText[it->first];
+		switch (it->second)
+		{
+		case MILLISECOND:
+			writeNumber(p, microseconds / 1000, 3);
+			break;
+		case MICROSECOND:
+			writeNumber(p, microseconds, 6);
+			break;
+		default:
+			writeNumber(p, microseconds * 1000, 9);
+			break;
+		}
+	}
+
+	os.write(cachedText.data(), cachedText.length());
+
+	cacheCs.unlock();
 }
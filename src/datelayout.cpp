@@ -103,7 +103,7 @@ void DateLayout::formatDate(tostream &os, const spi::LoggingEvent& event)
 {
 	if(dateFormat != 0)
 	{
-		dateFormat->format(os, event.getTimeStamp());
+		dateFormat->format(os, event.getTimeStamp(), event.getMicroseconds());
 		os << _T(' ');
 	}
 }
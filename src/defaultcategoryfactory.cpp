@@ -18,8 +18,13 @@
 #include <log4cxx/logger.h>
 
 using namespace log4cxx;
+using namespace log4cxx::helpers;
+
+DefaultCategoryFactory::DefaultCategoryFactory(ArenaPtr arena) : arena(arena)
+{
+}
 
 LoggerPtr DefaultCategoryFactory::makeNewLoggerInstance(const tstring& name)
 {
-    return new Logger(name);
+    return new (arena) Logger(name);
 }
@@ -24,7 +24,10 @@
 #include <log4cxx/net/socketappender.h>
 #include <log4cxx/net/sockethubappender.h>
 #include <log4cxx/net/telnetappender.h>
+#include <log4cxx/net/httpappender.h>
 #include <log4cxx/asyncappender.h>
+#include <log4cxx/statisticsappender.h>
+#include <log4cxx/circuitbreakerappender.h>
 #ifdef WIN32
 #include <log4cxx/nt/nteventlogappender.h>
 using namespace log4cxx::nt;
@@ -44,7 +47,9 @@ using namespace log4cxx::nt;
 
 // filter
 #include <log4cxx/spi/filter.h>
+#include <log4cxx/spi/loggingevent.h>
 #include <log4cxx/varia/denyallfilter.h>
+#include <log4cxx/varia/expressionfilter.h>
 #include <log4cxx/varia/levelmatchfilter.h>
 #include <log4cxx/varia/levelrangefilter.h>
 #include <log4cxx/varia/stringmatchfilter.h>
@@ -86,6 +91,9 @@ using namespace log4cxx::spi;
 #define ADDITIVITY_ATTR _T("additivity")
 #define THRESHOLD_ATTR _T("threshold")
 #define INTERNAL_DEBUG_ATTR _T("debug")
+#define MAX_MESSAGE_LENGTH_ATTR _T("maxmessagelength")
+#define MAX_NDC_LENGTH_ATTR _T("maxndclength")
+#define STACK_TRACE_LEVEL_ATTR _T("stacktracelevel")
 
 
 #define INHERITED _T("inherited")
@@ -237,6 +245,24 @@ void DOMConfigurator::BuildLog4cxxAttribute(const tstring& name, const tstring&
 			LogManager::getLoggerRepository()->setThreshold(value);
 		}
 	}
+
+	if (name == MAX_MESSAGE_LENGTH_ATTR)
+	{
+		LogLog::debug(_T("MaxMessageLength =\"") + value + _T("\"."));
+		LoggingEvent::setMaxMessageLength(OptionConverter::toInt(value, 0));
+	}
+
+	if (name == MAX_NDC_LENGTH_ATTR)
+	{
+		LogLog::debug(_T("MaxNDCLength =\"") + value + _T("\"."));
+		LoggingEvent::setMaxNDCLength(OptionConverter::toInt(value, 0));
+	}
+
+	if (name == STACK_TRACE_LEVEL_ATTR)
+	{
+		LogLog::debug(_T("StackTraceLevel =\"") + value + _T("\"."));
+		LoggingEvent::setStackTraceLevel(Level::toLevel(value, Level::OFF));
+	}
 }
 
 void DOMConfigurator::BuildAppenderAttribute(const tstring& name, const tstring& value)
@@ -493,12 +519,29 @@ AppenderPtr DOMConfigurator::BuildAppender(const tstring& className)
 	{
 		appender = new TelnetAppender();
 	}
+	else if (className == _T("httpappender"))
+	{
+		appender = new HTTPAppender();
+	}
 	else if (className == _T("asyncappender"))
 	{
 		AsyncAppender * asyncAppender = new AsyncAppender();
 		appender = asyncAppender;
 		currentAppenderAttachable = asyncAppender;
 	}
+	else if (className == _T("statisticsappender"))
+	{
+		StatisticsAppender * statisticsAppender = new StatisticsAppender();
+		appender = statisticsAppender;
+		currentAppenderAttachable = statisticsAppender;
+	}
+	else if (className == _T("circuitbreakerappender"))
+	{
+		CircuitBreakerAppender * circuitBreakerAppender =
+			new CircuitBreakerAppender();
+		appender = circuitBreakerAppender;
+		currentAppenderAttachable = circuitBreakerAppender;
+	}
 	else
 	{
 		LogLog::error(_T("Could not create Appender [") +className+ _T("]."));
@@ -516,6 +559,10 @@ FilterPtr DOMConfigurator::BuildFilter(const tstring& className)
 	{
 		filter = new DenyAllFilter();
 	}
+	else if (className == _T("expressionfilter"))
+	{
+		filter = new ExpressionFilter();
+	}
 	else if (className == _T("levelmatchfilter"))
 	{
 		filter = new LevelMatchFilter();
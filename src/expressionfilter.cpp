@@ -0,0 +1,684 @@
+/***************************************************************************
+                          expressionfilter.cpp  -  class ExpressionFilter
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/varia/expressionfilter.h>
+#include <log4cxx/spi/loggingevent.h>
+#include <log4cxx/helpers/stringhelper.h>
+#include <log4cxx/helpers/optionconverter.h>
+#include <log4cxx/helpers/exception.h>
+#include <log4cxx/helpers/loglog.h>
+#include <log4cxx/level.h>
+
+using namespace log4cxx;
+using namespace log4cxx::varia;
+using namespace log4cxx::spi;
+using namespace log4cxx::helpers;
+
+typedef ExpressionFilter::Node Node;
+
+namespace log4cxx
+{
+	namespace varia
+	{
+		/**
+		Compiles an expression of the ExpressionFilter into its nodes,
+		by recursive descent. Throws an IllegalArgumentException if the
+		expression is invalid.
+		*/
+		class ExpressionParser
+		{
+		public:
+			ExpressionParser(const tstring& expression,
+				std::vector<Node>& nodes);
+
+			/** Returns the index of the root node. */
+			int parse();
+
+		private:
+			enum Token
+			{
+				END, IDENTIFIER, STRING, NUMBER, OPERATOR, LEFT, RIGHT,
+				AND, OR, NOT
+			};
+
+			void next();
+			void error(const tstring& message);
+
+			int parseOr();
+			int parseAnd();
+			int parseUnary();
+			int parsePrimary();
+			int parseField(const tstring& name);
+
+			/** Reads the operator of a comparison, which must be between
+			<code>first</code> and <code>last</code> or one of the string
+			operators if <code>strings</code> is true. */
+			ExpressionFilter::Operator parseOperator(
+				ExpressionFilter::Operator first,
+				ExpressionFilter::Operator last, bool strings);
+
+			int add(const Node& node);
+			int constant(bool value);
+
+			const tstring& expression;
+			size_t position;
+			size_t tokenStart;
+			std::vector<Node>& nodes;
+
+			Token token;
+			tstring text;
+			double number;
+			ExpressionFilter::Operator op;
+		};
+	}; // namespace varia
+}; // namespace log4cxx
+
+/** Returns a node of type <code>type</code> with default operands. */
+static Node makeNode(ExpressionFilter::NodeType type)
+{
+	Node node;
+	node.type = type;
+	node.op = ExpressionFilter::EQ;
+	node.left = -1;
+	node.right = -1;
+	node.boolean = false;
+	node.attribute = ExpressionFilter::LOGGER;
+	node.level = 0;
+	node.number = 0;
+	return node;
+}
+
+template<class T>
+static inline bool compare(T value, ExpressionFilter::Operator op,
+	T constant)
+{
+	switch (op)
+	{
+	case ExpressionFilter::EQ: return value == constant;
+	case ExpressionFilter::NE: return value != constant;
+	case ExpressionFilter::LT: return value < constant;
+	case ExpressionFilter::LE: return value <= constant;
+	case ExpressionFilter::GT: return value > constant;
+	case ExpressionFilter::GE: return value >= constant;
+	default: return false;
+	}
+}
+
+static inline bool equals(const TCHAR * value, const tstring& constant)
+{
+	return std::char_traits<TCHAR>::compare(value, constant.data(),
+		constant.size()) == 0;
+}
+
+static inline bool matches(const TCHAR * value, size_t length,
+	ExpressionFilter::Operator op, const tstring& constant)
+{
+	size_t size = constant.size();
+
+	switch (op)
+	{
+	case ExpressionFilter::EQ:
+		return length == size && equals(value, constant);
+	case ExpressionFilter::NE:
+		return length != size || !equals(value, constant);
+	case ExpressionFilter::PREFIX:
+		return length >= size && equals(value, constant);
+	case ExpressionFilter::SUFFIX:
+		return length >= size && equals(value + length - size, constant);
+	case ExpressionFilter::CONTAINS:
+	{
+		if (size == 0)
+		{
+			return true;
+		}
+
+		// candidates are found by their first character
+		const TCHAR * p = value;
+		const TCHAR * last = value + length - size;
+		while (p <= last && length >= size)
+		{
+			p = std::char_traits<TCHAR>::find(p, last - p + 1, constant[0]);
+			if (p == 0)
+			{
+				return false;
+			}
+			if (equals(p, constant))
+			{
+				return true;
+			}
+			p++;
+		}
+		return false;
+	}
+	default:
+		return false;
+	}
+}
+
+ExpressionParser::ExpressionParser(const tstring& expression,
+	std::vector<Node>& nodes)
+: expression(expression), position(0), tokenStart(0), nodes(nodes),
+token(END), number(0), op(ExpressionFilter::EQ)
+{
+}
+
+int ExpressionParser::parse()
+{
+	next();
+	int root = parseOr();
+	if (token != END)
+	{
+		error(_T("unexpected ") + text);
+	}
+
+	return root;
+}
+
+void ExpressionParser::error(const tstring& message)
+{
+	tostringstream oss;
+	oss << message << _T(" at position ") << tokenStart;
+	throw IllegalArgumentException(oss.str());
+}
+
+void ExpressionParser::next()
+{
+	while (position < expression.size()
+		&& (expression[position] == _T(' ') || expression[position] == _T('\t')
+		|| expression[position] == _T('\r') || expression[position] == _T('\n')))
+	{
+		position++;
+	}
+
+	tokenStart = position;
+	text.erase();
+
+	if (position == expression.size())
+	{
+		token = END;
+		text = _T("end of expression");
+		return;
+	}
+
+	TCHAR c = expression[position];
+	TCHAR d = (position + 1 < expression.size()) ? expression[position + 1] : 0;
+
+	if (c == _T('"'))
+	{
+		token = STRING;
+		position++;
+		while (true)
+		{
+			if (position == expression.size())
+			{
+				error(_T("unterminated string"));
+			}
+
+			c = expression[position++];
+			if (c == _T('"'))
+			{
+				break;
+			}
+			else if (c == _T('\\') && position < expression.size())
+			{
+				c = expression[position++];
+			}
+			text += c;
+		}
+		return;
+	}
+
+	if ((c >= _T('0') && c <= _T('9'))
+		|| ((c == _T('-') || c == _T('.')) && d >= _T('0') && d <= _T('9')))
+	{
+		const TCHAR * begin = expression.c_str() + position;
+		TCHAR * end;
+		number = tcstod(begin, &end);
+		token = NUMBER;
+		text.assign(begin, end - begin);
+		position += end - begin;
+		return;
+	}
+
+	if ((c >= _T('a') && c <= _T('z')) || (c >= _T('A') && c <= _T('Z'))
+		|| c == _T('_'))
+	{
+		token = IDENTIFIER;
+		while (position < expression.size())
+		{
+			c = expression[position];
+			if (!((c >= _T('a') && c <= _T('z')) || (c >= _T('A') && c <= _T('Z'))
+				|| (c >= _T('0') && c <= _T('9')) || c == _T('_') || c == _T('.')))
+			{
+				break;
+			}
+			text += c;
+			position++;
+		}
+		return;
+	}
+
+	text = c;
+	position++;
+
+	if (c == _T('(')) { token = LEFT; return; }
+	if (c == _T(')')) { token = RIGHT; return; }
+
+	if (d == _T('=') || (c == _T('&') && d == _T('&'))
+		|| (c == _T('|') && d == _T('|')))
+	{
+		text += d;
+		position++;
+	}
+
+	token = OPERATOR;
+	if (text == _T("&&")) token = AND;
+	else if (text == _T("||")) token = OR;
+	else if (text == _T("!")) token = NOT;
+	else if (text == _T("==")) op = ExpressionFilter::EQ;
+	else if (text == _T("!=")) op = ExpressionFilter::NE;
+	else if (text == _T("<")) op = ExpressionFilter::LT;
+	else if (text == _T("<=")) op = ExpressionFilter::LE;
+	else if (text == _T(">")) op = ExpressionFilter::GT;
+	else if (text == _T(">=")) op = ExpressionFilter::GE;
+	else if (text == _T("^=")) op = ExpressionFilter::PREFIX;
+	else if (text == _T("$=")) op = ExpressionFilter::SUFFIX;
+	else if (text == _T("~=")) op = ExpressionFilter::CONTAINS;
+	else error(_T("unexpected ") + text);
+}
+
+int ExpressionParser::add(const Node& node)
+{
+	nodes.push_back(node);
+	return (int)nodes.size() - 1;
+}
+
+int ExpressionParser::constant(bool value)
+{
+	Node node = makeNode(ExpressionFilter::CONSTANT);
+	node.boolean = value;
+	return add(node);
+}
+
+int ExpressionParser::parseOr()
+{
+	int left = parseAnd();
+	while (token == OR)
+	{
+		next();
+		int right = parseAnd();
+
+		// the operands have no side effect: a constant decides
+		if (nodes[left].type == ExpressionFilter::CONSTANT)
+		{
+			left = nodes[left].boolean ? left : right;
+		}
+		else if (nodes[right].type == ExpressionFilter::CONSTANT)
+		{
+			left = nodes[right].boolean ? right : left;
+		}
+		else
+		{
+			Node node = makeNode(ExpressionFilter::OR);
+			node.left = left;
+			node.right = right;
+			left = add(node);
+		}
+	}
+
+	return left;
+}
+
+int ExpressionParser::parseAnd()
+{
+	int left = parseUnary();
+	while (token == AND)
+	{
+		next();
+		int right = parseUnary();
+
+		if (nodes[left].type == ExpressionFilter::CONSTANT)
+		{
+			left = nodes[left].boolean ? right : left;
+		}
+		else if (nodes[right].type == ExpressionFilter::CONSTANT)
+		{
+			left = nodes[right].boolean ? left : right;
+		}
+		else
+		{
+			Node node = makeNode(ExpressionFilter::AND);
+			node.left = left;
+			node.right = right;
+			left = add(node);
+		}
+	}
+
+	return left;
+}
+
+int ExpressionParser::parseUnary()
+{
+	if (token != NOT)
+	{
+		return parsePrimary();
+	}
+
+	next();
+	int operand = parseUnary();
+
+	if (nodes[operand].type == ExpressionFilter::CONSTANT)
+	{
+		return constant(!nodes[operand].boolean);
+	}
+	else if (nodes[operand].type == ExpressionFilter::NOT)
+	{
+		return nodes[operand].left;
+	}
+
+	Node node = makeNode(ExpressionFilter::NOT);
+	node.left = operand;
+	return add(node);
+}
+
+ExpressionFilter::Operator ExpressionParser::parseOperator(
+	ExpressionFilter::Operator first, ExpressionFilter::Operator last,
+	bool strings)
+{
+	if (token != OPERATOR || !((op >= first && op <= last)
+		|| (strings && op >= ExpressionFilter::PREFIX)))
+	{
+		error(_T("unexpected ") + text);
+	}
+
+	ExpressionFilter::Operator result = op;
+	next();
+	return result;
+}
+
+int ExpressionParser::parsePrimary()
+{
+	if (token == LEFT)
+	{
+		next();
+		int result = parseOr();
+		if (token != RIGHT)
+		{
+			error(_T("missing )"));
+		}
+		next();
+		return result;
+	}
+
+	if (token != IDENTIFIER)
+	{
+		error(_T("unexpected ") + text);
+	}
+
+	tstring name = text;
+	size_t start = tokenStart;
+	next();
+
+	if (name == _T("true") || name == _T("false"))
+	{
+		return constant(name == _T("true"));
+	}
+
+	if (name == _T("level"))
+	{
+		Node node = makeNode(ExpressionFilter::LEVEL);
+		node.op = parseOperator(ExpressionFilter::EQ, ExpressionFilter::GE,
+			false);
+
+		if (token == NUMBER)
+		{
+			node.level = (int)number;
+		}
+		else if (token == IDENTIFIER)
+		{
+			const Level& level = Level::toLevel(text, Level::OFF);
+			if (!StringHelper::equalsIgnoreCase(text, level.toString()))
+			{
+				error(_T("unknown level ") + text);
+			}
+			node.level = level.toInt();
+		}
+		else
+		{
+			error(_T("expected a level instead of ") + text);
+		}
+
+		next();
+		return add(node);
+	}
+
+	if (name == _T("logger") || name == _T("message") || name == _T("ndc"))
+	{
+		Node node = makeNode(ExpressionFilter::STRING);
+		node.attribute = (name == _T("logger")) ? ExpressionFilter::LOGGER
+			: (name == _T("message")) ? ExpressionFilter::MESSAGE
+			: ExpressionFilter::NDC;
+		node.op = parseOperator(ExpressionFilter::EQ, ExpressionFilter::NE,
+			true);
+
+		if (token != STRING)
+		{
+			error(_T("expected a string instead of ") + text);
+		}
+		node.string = text;
+		next();
+
+		// every string starts with, ends with and contains ""
+		if (node.string.empty() && node.op >= ExpressionFilter::PREFIX)
+		{
+			return constant(true);
+		}
+
+		return add(node);
+	}
+
+	if (name.compare(0, 6, _T("field.")) == 0 && name.size() > 6)
+	{
+		return parseField(name.substr(6));
+	}
+
+	if (name.compare(0, 4, _T("mdc.")) == 0 && name.size() > 4)
+	{
+		return parseField(name.substr(4));
+	}
+
+	tokenStart = start;
+	error(_T("unknown attribute ") + name);
+	return -1;
+}
+
+int ExpressionParser::parseField(const tstring& name)
+{
+	Node node = makeNode(ExpressionFilter::FIELD_EXISTS);
+	node.name = name;
+
+	if (token != OPERATOR)
+	{
+		return add(node);
+	}
+
+	ExpressionFilter::Operator comparison = op;
+	next();
+
+	if (token == STRING)
+	{
+		if (comparison >= ExpressionFilter::LT
+			&& comparison <= ExpressionFilter::GE)
+		{
+			error(_T("strings cannot be ordered"));
+		}
+		node.type = ExpressionFilter::FIELD_STRING;
+		node.string = text;
+	}
+	else if (token == NUMBER)
+	{
+		if (comparison > ExpressionFilter::GE)
+		{
+			error(_T("numbers cannot be compared as strings"));
+		}
+		node.type = ExpressionFilter::FIELD_NUMBER;
+		node.number = number;
+	}
+	else if (token == IDENTIFIER && (text == _T("true") || text == _T("false")))
+	{
+		if (comparison > ExpressionFilter::NE)
+		{
+			error(_T("booleans can only be compared with == and !="));
+		}
+		node.type = ExpressionFilter::FIELD_BOOL;
+		node.boolean = (text == _T("true"));
+	}
+	else
+	{
+		error(_T("expected a constant instead of ") + text);
+	}
+
+	node.op = comparison;
+	next();
+	return add(node);
+}
+
+tstring ExpressionFilter::EXPRESSION_OPTION = _T("Expression");
+tstring ExpressionFilter::ACCEPT_ON_MATCH_OPTION = _T("AcceptOnMatch");
+
+ExpressionFilter::ExpressionFilter() : acceptOnMatch(true), root(-1)
+{
+}
+
+void ExpressionFilter::setOption(const tstring& option,
+	const tstring& value)
+{
+	if (StringHelper::equalsIgnoreCase(option, EXPRESSION_OPTION))
+	{
+		setExpression(value);
+	}
+	else if (StringHelper::equalsIgnoreCase(option, ACCEPT_ON_MATCH_OPTION))
+	{
+		acceptOnMatch = OptionConverter::toBoolean(value, acceptOnMatch);
+	}
+}
+
+void ExpressionFilter::setExpression(const tstring& expression)
+{
+	this->expression = expression;
+	nodes.clear();
+	root = -1;
+
+	try
+	{
+		ExpressionParser parser(expression, nodes);
+		root = parser.parse();
+	}
+	catch(IllegalArgumentException& e)
+	{
+		LogLog::error(_T("Invalid expression [") + expression + _T("]: ")
+			+ e.getMessage() + _T("."));
+		nodes.clear();
+		root = -1;
+	}
+}
+
+int ExpressionFilter::decide(const spi::LoggingEvent& event)
+{
+	if (root == -1 || !evaluate(root, event))
+	{
+		return Filter::NEUTRAL;
+	}
+
+	return acceptOnMatch ? Filter::ACCEPT : Filter::DENY;
+}
+
+bool ExpressionFilter::evaluate(int index, const spi::LoggingEvent& event) const
+{
+	const Node& node = nodes[index];
+
+	switch (node.type)
+	{
+	case CONSTANT:
+		return node.boolean;
+
+	case NOT:
+		return !evaluate(node.left, event);
+
+	case AND:
+		return evaluate(node.left, event) && evaluate(node.right, event);
+
+	case OR:
+		return evaluate(node.left, event) || evaluate(node.right, event);
+
+	case LEVEL:
+		return compare(event.getLevel().level, node.op, node.level);
+
+	case STRING:
+	{
+		const tstring& value = (node.attribute == LOGGER)
+			? event.getLoggerName() : (node.attribute == MESSAGE)
+			? event.getRenderedMessage() : event.getNDC();
+		return matches(value.data(), value.size(), node.op, node.string);
+	}
+
+	default:
+		break;
+	}
+
+	// a field which is missing or of another type is only different
+	const Field * field = event.getFields().find(node.name);
+	bool typed;
+	switch (node.type)
+	{
+	case FIELD_EXISTS:
+		return field != 0;
+
+	case FIELD_STRING:
+		typed = field != 0 && field->type == Field::STRING;
+		if (node.op == NE)
+		{
+			return !typed || matches(field->string, field->stringLength,
+				NE, node.string);
+		}
+		return typed && matches(field->string, field->stringLength,
+			node.op, node.string);
+
+	case FIELD_NUMBER:
+	{
+		typed = field != 0 && (field->type == Field::INT64
+			|| field->type == Field::DOUBLE);
+		double value = !typed ? 0 : (field->type == Field::INT64)
+			? (double)field->value.int64Value : field->value.doubleValue;
+		if (node.op == NE)
+		{
+			return !typed || value != node.number;
+		}
+		return typed && compare(value, node.op, node.number);
+	}
+
+	case FIELD_BOOL:
+		typed = field != 0 && field->type == Field::BOOL;
+		if (node.op == NE)
+		{
+			return !typed || field->value.boolValue != node.boolean;
+		}
+		return typed && field->value.boolValue == node.boolean;
+
+	default:
+		return false;
+	}
+}
@@ -0,0 +1,235 @@
+/***************************************************************************
+                          fallbackerrorhandler.cpp  -  class FallbackErrorHandler
+                             -------------------
+    begin                : ven mai 23 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/varia/fallbackerrorhandler.h>
+#include <log4cxx/appender.h>
+#include <log4cxx/logger.h>
+#include <log4cxx/spi/loggingevent.h>
+#include <log4cxx/helpers/loglog.h>
+#include <log4cxx/helpers/stringhelper.h>
+#include <log4cxx/helpers/optionconverter.h>
+#include <log4cxx/helpers/interlocked.h>
+#include <log4cxx/helpers/clock.h>
+
+using namespace log4cxx;
+using namespace log4cxx::varia;
+using namespace log4cxx::spi;
+using namespace log4cxx::helpers;
+
+int FallbackErrorHandler::DEFAULT_RETRY_INTERVAL = 30000;
+int FallbackErrorHandler::DEFAULT_LATENCY_THRESHOLD = 1000;
+
+/** Number of milliseconds from <code>from</code> to <code>to</code>,
+which may have wrapped around. */
+static inline long elapsed(long from, long to)
+{
+	return (long)((unsigned long)to - (unsigned long)from);
+}
+
+FallbackErrorHandler::Redirector::Redirector(FallbackErrorHandler * handler,
+	AppenderPtr appender)
+: handler(handler), appender(appender),
+nextRetry(currentTimeMillis() + handler->retryInterval)
+{
+	name = appender->getName();
+}
+
+FallbackErrorHandler::Redirector::~Redirector()
+{
+	finalize();
+}
+
+void FallbackErrorHandler::Redirector::append(const spi::LoggingEvent& event)
+{
+	if(handler->retryInterval > 0)
+	{
+		long now = currentTimeMillis();
+
+		if(elapsed(nextRetry, now) >= 0 &&
+			Interlocked::compareExchange(&handler->probing, 1, 0) == 0)
+		{
+			nextRetry = now + handler->retryInterval;
+
+			long errors = handler->errors;
+			appender->doAppend(event);
+			Interlocked::compareExchange(&handler->probing, 0, 1);
+
+			if(handler->errors == errors)
+			{
+				if(elapsed(now, currentTimeMillis()) <=
+					handler->latencyThreshold)
+				{
+					handler->restore();
+				}
+
+				// the event has been appended, even if slowly
+				return;
+			}
+		}
+	}
+
+	AppenderPtr backupAppender = handler->getBackupAppender();
+	if(backupAppender != 0)
+	{
+		backupAppender->doAppend(event);
+	}
+}
+
+void FallbackErrorHandler::Redirector::close()
+{
+}
+
+FallbackErrorHandler::FallbackErrorHandler()
+: appender(0), retryInterval(DEFAULT_RETRY_INTERVAL),
+latencyThreshold(DEFAULT_LATENCY_THRESHOLD), errors(0), probing(0)
+{
+}
+
+void FallbackErrorHandler::setLogger(LoggerPtr)
+{
+}
+
+void FallbackErrorHandler::activateOptions()
+{
+}
+
+void FallbackErrorHandler::setOption(const tstring& option,
+	const tstring& value)
+{
+	if (StringHelper::equalsIgnoreCase(option, _T("retryinterval")))
+	{
+		setRetryInterval(OptionConverter::toInt(value,
+			DEFAULT_RETRY_INTERVAL));
+	}
+	else if (StringHelper::equalsIgnoreCase(option, _T("latencythreshold")))
+	{
+		setLatencyThreshold(OptionConverter::toInt(value,
+			DEFAULT_LATENCY_THRESHOLD));
+	}
+}
+
+void FallbackErrorHandler::error(const tstring& message, Exception& e,
+	int)
+{
+	Interlocked::increment(&errors);
+
+	if(redirect())
+	{
+		LogLog::error(message, e);
+	}
+}
+
+void FallbackErrorHandler::error(const tstring& message, Exception& e,
+	int, spi::LoggingEvent& event)
+{
+	Interlocked::increment(&errors);
+
+	// while retrying, the redirector passes the event to the backup
+	// appender itself
+	if(redirect())
+	{
+		LogLog::error(message, e);
+	}
+	else if(probing != 0)
+	{
+		return;
+	}
+
+	AppenderPtr backupAppender = getBackupAppender();
+	if(backupAppender != 0)
+	{
+		backupAppender->doAppend(event);
+	}
+}
+
+void FallbackErrorHandler::error(const tstring& message)
+{
+	Interlocked::increment(&errors);
+
+	if(redirect())
+	{
+		LogLog::error(message);
+	}
+}
+
+void FallbackErrorHandler::setAppender(AppenderPtr appender)
+{
+	restore();
+
+	synchronized sync(this);
+	this->appender = appender;
+}
+
+void FallbackErrorHandler::setBackupAppender(AppenderPtr backupAppender)
+{
+	synchronized sync(this);
+
+	this->backupAppender = backupAppender;
+}
+
+AppenderPtr FallbackErrorHandler::getBackupAppender()
+{
+	synchronized sync(this);
+
+	return backupAppender;
+}
+
+bool FallbackErrorHandler::isRedirected()
+{
+	synchronized sync(this);
+
+	return redirector != 0;
+}
+
+bool FallbackErrorHandler::redirect()
+{
+	synchronized sync(this);
+
+	if(redirector != 0 || appender == 0 || backupAppender == 0)
+	{
+		return false;
+	}
+
+	redirector = new Redirector(this, appender);
+	// the redirector forwards the events to the backup appender
+	Logger::redirectAppender(appender, redirector, backupAppender);
+
+	LogLog::warn(_T("Appender [") + appender->getName() +
+		_T("] replaced by appender [") + backupAppender->getName() +
+		_T("]."));
+	return true;
+}
+
+void FallbackErrorHandler::restore()
+{
+	synchronized sync(this);
+
+	if(redirector == 0)
+	{
+		return;
+	}
+
+	Logger::redirectAppender(appender, 0);
+	redirector = 0;
+
+	LogLog::warn(_T("Appender [") + appender->getName() +
+		_T("] has recovered."));
+}
+
+long FallbackErrorHandler::currentTimeMillis()
+{
+	return (long)(Clock::monotonicMicros() / 1000);
+}
@@ -0,0 +1,235 @@
+/***************************************************************************
+                          fields.cpp  -  class Fields
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/fields.h>
+
+using namespace log4cxx;
+using namespace log4cxx::helpers;
+
+bool Field::hasName(const tstring& name) const
+{
+	return name.size() == nameLength
+		&& name.compare(0, nameLength, this->name, nameLength) == 0;
+}
+
+void Field::format(tostream& output) const
+{
+	switch (type)
+	{
+	case INT64:
+		output << value.int64Value;
+		break;
+
+	case DOUBLE:
+	{
+		std::streamsize precision = output.precision(15);
+		output << value.doubleValue;
+		output.precision(precision);
+		break;
+	}
+
+	case STRING:
+		output.write(string, (std::streamsize)stringLength);
+		break;
+
+	case BOOL:
+		output << (value.boolValue ? _T("true") : _T("false"));
+		break;
+	}
+}
+
+Fields::Fields() : count(0)
+{
+}
+
+Fields::Fields(const Fields& fields) : count(0)
+{
+	*this = fields;
+}
+
+Fields& Fields::operator=(const Fields& fields)
+{
+	if (this != &fields)
+	{
+		view(fields);
+		own();
+	}
+
+	return *this;
+}
+
+Field * Fields::add(const TCHAR * name, Field::Type type)
+{
+	if (count == MAX_FIELDS)
+	{
+		return 0;
+	}
+
+	Field * field = &fields[count++];
+	field->name = name;
+	field->nameLength = std::char_traits<TCHAR>::length(name);
+	field->type = type;
+	field->string = 0;
+	field->stringLength = 0;
+	return field;
+}
+
+Fields& Fields::add(const TCHAR * name, int value)
+{
+	return add(name, (int64)value);
+}
+
+Fields& Fields::add(const TCHAR * name, long value)
+{
+	return add(name, (int64)value);
+}
+
+Fields& Fields::add(const TCHAR * name, unsigned int value)
+{
+	return add(name, (int64)value);
+}
+
+Fields& Fields::add(const TCHAR * name, unsigned long value)
+{
+	return add(name, (int64)value);
+}
+
+Fields& Fields::add(const TCHAR * name, int64 value)
+{
+	Field * field = add(name, Field::INT64);
+	if (field != 0)
+	{
+		field->value.int64Value = value;
+	}
+
+	return *this;
+}
+
+Fields& Fields::add(const TCHAR * name, double value)
+{
+	Field * field = add(name, Field::DOUBLE);
+	if (field != 0)
+	{
+		field->value.doubleValue = value;
+	}
+
+	return *this;
+}
+
+Fields& Fields::add(const TCHAR * name, bool value)
+{
+	Field * field = add(name, Field::BOOL);
+	if (field != 0)
+	{
+		field->value.boolValue = value;
+	}
+
+	return *this;
+}
+
+Fields& Fields::add(const TCHAR * name, const TCHAR * value)
+{
+	Field * field = add(name, Field::STRING);
+	if (field != 0)
+	{
+		field->string = value;
+		field->stringLength = std::char_traits<TCHAR>::length(value);
+	}
+
+	return *this;
+}
+
+Fields& Fields::add(const TCHAR * name, const tstring& value)
+{
+	Field * field = add(name, Field::STRING);
+	if (field != 0)
+	{
+		field->string = value.data();
+		field->stringLength = value.size();
+	}
+
+	return *this;
+}
+
+const Field * Fields::find(const tstring& name) const
+{
+	for (int i = 0; i < count; i++)
+	{
+		if (fields[i].hasName(name))
+		{
+			return &fields[i];
+		}
+	}
+
+	return 0;
+}
+
+void Fields::view(const Fields& fields)
+{
+	count = fields.count;
+	for (int i = 0; i < count; i++)
+	{
+		this->fields[i] = fields.fields[i];
+	}
+}
+
+void Fields::own()
+{
+	if (count == 0)
+	{
+		text.erase();
+		return;
+	}
+
+	// the strings may be in the current text
+	tstring copy;
+	for (int i = 0; i < count; i++)
+	{
+		copy.append(fields[i].name, fields[i].nameLength);
+		if (fields[i].type == Field::STRING)
+		{
+			copy.append(fields[i].string, fields[i].stringLength);
+		}
+	}
+	text.swap(copy);
+
+	const TCHAR * p = text.data();
+	for (int i = 0; i < count; i++)
+	{
+		fields[i].name = p;
+		p += fields[i].nameLength;
+		if (fields[i].type == Field::STRING)
+		{
+			fields[i].string = p;
+			p += fields[i].stringLength;
+		}
+	}
+}
+
+void Fields::format(tostream& output) const
+{
+	for (int i = 0; i < count; i++)
+	{
+		if (i > 0)
+		{
+			output << _T(" ");
+		}
+
+		output.write(fields[i].name, (std::streamsize)fields[i].nameLength);
+		output << _T("=");
+		fields[i].format(output);
+	}
+}
@@ -18,18 +18,29 @@
 #include <log4cxx/helpers/stringhelper.h>
 #include <log4cxx/helpers/loglog.h>
 #include <log4cxx/helpers/optionconverter.h>
+#include <log4cxx/spi/loggingevent.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 using namespace log4cxx;
 using namespace log4cxx::helpers;
 
 FileAppender::FileAppender()
-: fileAppend(true), bufferedIO(false), bufferSize(8*1024)
+: fileAppend(true), bufferedIO(false), bufferSize(8*1024), fd(-1)
 {
 }
 
 FileAppender::FileAppender(LayoutPtr layout, const tstring& fileName,
 	bool append, bool bufferedIO, int bufferSize)
-: fileName(fileName), fileAppend(append), bufferedIO(bufferedIO), bufferSize(bufferSize)
+: fileName(fileName), fileAppend(append), bufferedIO(bufferedIO), bufferSize(bufferSize),
+fd(-1)
 {
 	this->layout = layout;
 	activateOptions();
@@ -37,14 +48,16 @@ FileAppender::FileAppender(LayoutPtr layout, const tstring& fileName,
 
 FileAppender::FileAppender(LayoutPtr layout, const tstring& fileName,
 	bool append)
-: fileName(fileName), fileAppend(append), bufferedIO(false), bufferSize(8*1024)
+: fileName(fileName), fileAppend(append), bufferedIO(false), bufferSize(8*1024),
+fd(-1)
 {
 	this->layout = layout;
 	activateOptions();
 }
 
 FileAppender::FileAppender(LayoutPtr layout, const tstring& fileName)
-: fileName(fileName), fileAppend(true), bufferedIO(false), bufferSize(8*1024)
+: fileName(fileName), fileAppend(true), bufferedIO(false), bufferSize(8*1024),
+fd(-1)
 {
 	this->layout = layout;
 	activateOptions();
@@ -65,7 +78,95 @@ void FileAppender::setFile(const tstring& file)
 void FileAppender::closeWriter()
 {
 	ofs.close();
+	ofs.clear();
 	os = 0;
+
+	if (fd >= 0)
+	{
+#ifdef WIN32
+		::_close(fd);
+#else
+		::close(fd);
+#endif
+		fd = -1;
+	}
+}
+
+bool FileAppender::openFile(bool append)
+{
+	USES_CONVERSION;
+
+	// the file is truncated through the descriptor: the stream is
+	// always in append mode, so that both write at the end of the file.
+#ifdef WIN32
+	fd = ::_open(T2A(fileName.c_str()), _O_WRONLY | _O_CREAT | _O_APPEND
+		| _O_TEXT | (append ? 0 : _O_TRUNC), 0666);
+#else
+	fd = ::open(T2A(fileName.c_str()), O_WRONLY | O_CREAT | O_APPEND
+		| (append ? 0 : O_TRUNC), 0666);
+#endif
+
+	ofs.open(T2A(fileName.c_str()), (fd >= 0 || append ? std::ios::app :
+		std::ios::trunc)|std::ios::out);
+
+	if(!ofs.is_open())
+	{
+		closeWriter();
+		return false;
+	}
+
+	this->os = &ofs;
+	return true;
+}
+
+long FileAppender::getFileLength()
+{
+	if (fd < 0)
+	{
+		return ofs.tellp();
+	}
+
+	ofs.flush();
+#ifdef WIN32
+	struct _stat st;
+	if (::_fstat(fd, &st) != 0)
+#else
+	struct stat st;
+	if (::fstat(fd, &st) != 0)
+#endif
+	{
+		return 0;
+	}
+
+	return (long)st.st_size;
+}
+
+void FileAppender::subAppend(const spi::LoggingEvent& event)
+{
+#ifndef UNICODE
+	// the descriptor writes bytes: the characters of the wide stream
+	// would have to be converted first.
+	if (fd >= 0 && event.getRenderedMessage().size() >= ByteRange::MIN_GATHER_LENGTH)
+	{
+		gatherBuffer.reset();
+		if (layout->gather(gatherBuffer, event))
+		{
+			// what the stream buffers comes first
+			ofs.flush();
+
+			const std::vector<ByteRange>& ranges = gatherBuffer.getRanges();
+			if (ByteRange::write(fd, &ranges[0], (int)ranges.size()) < 0)
+			{
+				errorHandler->error(_T("Failed to write to file ") + fileName);
+			}
+
+			gatherBuffer.reset();
+			return;
+		}
+	}
+#endif
+
+	WriterAppender::subAppend(event);
 }
 
 void FileAppender::setBufferedIO(bool bufferedIO)
@@ -98,7 +199,7 @@ void FileAppender::setOption(const std::string& option,
 	}
 	else
 	{
-		WriterAppender::setOption(name, value);
+		WriterAppender::setOption(option, value);
 	}
 }
 
@@ -125,16 +226,12 @@ void FileAppender::activateOptions()
 			out.rdbuf()->setbuf(buffer, 0);
 		}*/
 
-		ofs.open(T2A(fileName.c_str()), (fileAppend ? std::ios::app :
-			std::ios::trunc)|std::ios::out);
-
-		if(!ofs.is_open())
+		if(!openFile(fileAppend))
 		{
 			errorHandler->error(_T("Unable to open file: ") + fileName);
 			return;
 		}
 
-		this->os = &ofs;
 		writeHeader();
 		LogLog::debug(_T("FileAppender::activateOptions ended"));	}
 	else
@@ -0,0 +1,71 @@
+/***************************************************************************
+                          gatherbuffer.cpp  -  class GatherBuffer
+                             -------------------
+    begin                : lun mai 26 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/helpers/gatherbuffer.h>
+
+using namespace log4cxx;
+using namespace log4cxx::helpers;
+
+GatherBuffer::GatherBuffer()
+{
+}
+
+void GatherBuffer::append(const tstring& value)
+{
+	if (value.size() * sizeof(TCHAR) < ByteRange::MIN_GATHER_LENGTH)
+	{
+		stream << value;
+		return;
+	}
+
+	references.push_back(std::pair<size_t, const tstring *>(
+		(size_t)stream.tellp(), &value));
+}
+
+const std::vector<ByteRange>& GatherBuffer::getRanges()
+{
+	text = stream.str();
+	ranges.clear();
+
+	size_t position = 0;
+	std::vector< std::pair<size_t, const tstring *> >::iterator it;
+	for (it = references.begin(); it != references.end(); it++)
+	{
+		if (it->first > position)
+		{
+			ranges.push_back(ByteRange(text.data() + position,
+				(it->first - position) * sizeof(TCHAR)));
+			position = it->first;
+		}
+
+		ranges.push_back(ByteRange(it->second->data(),
+			it->second->size() * sizeof(TCHAR)));
+	}
+
+	if (text.size() > position)
+	{
+		ranges.push_back(ByteRange(text.data() + position,
+			(text.size() - position) * sizeof(TCHAR)));
+	}
+
+	return ranges;
+}
+
+void GatherBuffer::reset()
+{
+	stream.str(tstring());
+	references.clear();
+}
@@ -41,16 +41,20 @@ namespace {
 }
 
 Hierarchy::Hierarchy(LoggerPtr root) : root(root),
-emittedNoAppenderWarning(false), emittedNoResourceBundleWarning(false)
+emittedNoAppenderWarning(false), emittedNoResourceBundleWarning(false),
+reclaimThreshold(0), nextReclaim(0)
 {
 	// Enable all level levels by default.
 	setThreshold(Level::ALL);
 	this->root->setHierarchy(this);
-	defaultFactory = new DefaultCategoryFactory();
+	arena = new Arena();
+	defaultFactory = new DefaultCategoryFactory(arena);
 }
 
 Hierarchy::~Hierarchy()
 {
+	// the loggers released from now on are not reused
+	arena->close();
 }
 
 void Hierarchy::addHierarchyEventListener(spi::HierarchyEventListenerPtr listener)
@@ -70,6 +74,7 @@ void Hierarchy::clear()
 	mapCs.lock();
 
 	loggers.clear();
+	Logger::invalidateDispatchState();
 	
 	mapCs.unlock();
 }
@@ -92,7 +97,30 @@ LoggerPtr Hierarchy::exists(const tstring& name)
 	mapCs.lock();
 	
 	LoggerMap::iterator it = loggers.find(name);
-	return (it != loggers.end()) ? it->second : 0;
+	LoggerPtr logger = (it != loggers.end()) ? it->second : 0;
+
+	mapCs.unlock();
+
+	return logger;
+}
+
+int Hierarchy::reclaimUnusedLoggers()
+{
+	mapCs.lock();
+
+	int removed = reclaim();
+
+	mapCs.unlock();
+
+	return removed;
+}
+
+void Hierarchy::setReclaimThreshold(int threshold)
+{
+	mapCs.lock();
+
+	reclaimThreshold = threshold;
+	nextReclaim = threshold;
 
 	mapCs.unlock();
 }
@@ -101,6 +129,7 @@ void Hierarchy::setThreshold(const Level& l)
 {
 	thresholdInt = l.level;
 	threshold = &l;
+	Logger::invalidateDispatchState();
 }
 
 void Hierarchy::setThreshold(const tstring& levelStr)
@@ -183,6 +212,17 @@ LoggerPtr Hierarchy::getLogger(const tstring& name, spi::LoggerFactoryPtr factor
 		}
 
 		updateParents(logger);
+
+		if (reclaimThreshold > 0 && (int)loggers.size() > nextReclaim)
+		{
+			reclaim();
+
+			nextReclaim = 2 * loggers.size();
+			if (nextReclaim < reclaimThreshold)
+			{
+				nextReclaim = reclaimThreshold;
+			}
+		}
 	}
 
 	mapCs.unlock();
@@ -288,12 +328,12 @@ void Hierarchy::updateParents(LoggerPtr logger)
 		if(it != loggers.end())
 		{
 			parentFound = true;
-			logger->parent = it->second;
+			logger->dispatch.parent = it->second;
 			break; // no need to update the ancestors of the closest ancestor
 		}
 		else
 		{
-			ProvisionNodeMap::iterator it2 = provisionNodes.find(name);
+			ProvisionNodeMap::iterator it2 = provisionNodes.find(substr);
 			if (it2 != provisionNodes.end())
 			{
 				it2->second.push_back(logger);
@@ -302,7 +342,7 @@ void Hierarchy::updateParents(LoggerPtr logger)
 			{
 				ProvisionNode node(logger);
 				provisionNodes.insert(
-					ProvisionNodeMap::value_type(name, node));
+					ProvisionNodeMap::value_type(substr, node));
 			}
 		}
 	}
@@ -310,8 +350,10 @@ void Hierarchy::updateParents(LoggerPtr logger)
 	// If we could not find any existing parents, then link with root.
 	if(!parentFound)
 	{
-		logger->parent = root;
+		logger->dispatch.parent = root;
 	}
+
+	Logger::invalidateDispatchState();
 }
 
 void Hierarchy::updateChildren(ProvisionNode& pn, LoggerPtr logger)
@@ -327,10 +369,102 @@ void Hierarchy::updateChildren(ProvisionNode& pn, LoggerPtr logger)
 		
 		// Unless this child already points to a correct (lower) parent,
 		// make cat.parent point to l.parent and l.parent to cat.
-		if(!startsWith(l->parent->name, logger->name))
+		if(!startsWith(l->dispatch.parent->name, logger->name))
 		{
-			logger->parent = l->parent;
-			l->parent = logger;
+			logger->dispatch.parent = l->dispatch.parent;
+			l->dispatch.parent = logger;
 		}
 	}
+
+	Logger::invalidateDispatchState();
+}
+
+int Hierarchy::reclaim()
+{
+	int removed = 0;
+
+	// children are visited before their parents, which sort before them:
+	// a parent can be reclaimed in the same pass once its last child
+	// is gone.
+	LoggerMap::iterator it = loggers.end();
+	while (it != loggers.begin())
+	{
+		LoggerMap::iterator previous = it;
+		--previous;
+
+		if (removeIfUnused(previous->second))
+		{
+			loggers.erase(previous);
+			removed++;
+		}
+		else
+		{
+			it = previous;
+		}
+	}
+
+	if (removed > 0)
+	{
+		LogLog::debug(_T("Reclaimed unused loggers."));
+	}
+
+	return removed;
+}
+
+bool Hierarchy::removeIfUnused(Logger * logger)
+{
+	if (logger->level != &Level::OFF || !logger->additive
+		|| !logger->appenderList.empty())
+	{
+		return false;
+	}
+
+	// the references held by this hierarchy are the one of the map and
+	// the ones of the provision nodes of the missing ancestors, see
+	// updateParents. Any other one comes from the application or from
+	// a child.
+	const tstring& name = logger->name;
+	std::vector<ProvisionNodeMap::iterator> nodes;
+
+	for(size_t i = name.find_last_of(_T('.')); i != tstring::npos;
+	i = name.find_last_of(_T('.'), i-1))
+	{
+		tstring substr = name.substr(0, i);
+
+		if (loggers.find(substr) != loggers.end())
+		{
+			break;
+		}
+
+		ProvisionNodeMap::iterator it = provisionNodes.find(substr);
+		if (it != provisionNodes.end() &&
+			std::find(it->second.begin(), it->second.end(), logger)
+			!= it->second.end())
+		{
+			nodes.push_back(it);
+		}
+
+		if (i == 0)
+		{
+			break;
+		}
+	}
+
+	if (logger->ref != 1 + (long)nodes.size())
+	{
+		return false;
+	}
+
+	std::vector<ProvisionNodeMap::iterator>::iterator it, itEnd = nodes.end();
+	for (it = nodes.begin(); it != itEnd; it++)
+	{
+		ProvisionNode& node = (*it)->second;
+		node.erase(std::find(node.begin(), node.end(), logger));
+		if (node.empty())
+		{
+			provisionNodes.erase(*it);
+		}
+	}
+
+	return true;
 }
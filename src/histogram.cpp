@@ -0,0 +1,92 @@
+/***************************************************************************
+                          histogram.cpp  -  class Histogram
+                             -------------------
+    begin                : mer mai 21 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/helpers/histogram.h>
+
+using namespace log4cxx::helpers;
+
+Histogram::Histogram()
+{
+	reset();
+}
+
+void Histogram::record(int64 micros)
+{
+	int bucket = 0;
+	while(micros >= ((int64)1 << bucket) && bucket < BUCKET_COUNT - 1)
+	{
+		bucket++;
+	}
+
+	buckets[bucket]++;
+	count++;
+	total += micros;
+	if(micros > max)
+	{
+		max = micros;
+	}
+}
+
+void Histogram::reset()
+{
+	for(int i = 0; i < BUCKET_COUNT; i++)
+	{
+		buckets[i] = 0;
+	}
+
+	count = 0;
+	total = 0;
+	max = 0;
+}
+
+int64 Histogram::getBucketLimit(int bucket)
+{
+	return (int64)1 << bucket;
+}
+
+int64 Histogram::getMean() const
+{
+	return (count == 0) ? 0 : total / count;
+}
+
+int64 Histogram::getPercentile(int percentile) const
+{
+	// number of durations at or below the percentile, rounded up
+	long rank = (long)(((int64)count * percentile + 99) / 100);
+	long seen = 0;
+
+	for(int i = 0; i < BUCKET_COUNT; i++)
+	{
+		seen += buckets[i];
+		if(seen >= rank && seen > 0)
+		{
+			return getBucketLimit(i);
+		}
+	}
+
+	return 0;
+}
+
+tstring Histogram::toString() const
+{
+	tostringstream oss;
+	oss << _T("count=") << count
+		<< _T(" mean=") << (long)getMean() << _T("us")
+		<< _T(" p50<") << (long)getPercentile(50) << _T("us")
+		<< _T(" p99<") << (long)getPercentile(99) << _T("us")
+		<< _T(" max=") << (long)max << _T("us");
+	return oss.str();
+}
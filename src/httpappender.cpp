@@ -0,0 +1,705 @@
+/***************************************************************************
+                          httpappender.cpp  -  class HTTPAppender
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/net/httpappender.h>
+#include <log4cxx/helpers/loglog.h>
+#include <log4cxx/helpers/optionconverter.h>
+#include <log4cxx/helpers/stringhelper.h>
+#include <log4cxx/helpers/interlocked.h>
+#include <log4cxx/spi/loggingevent.h>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+
+using namespace log4cxx;
+using namespace log4cxx::helpers;
+using namespace log4cxx::net;
+using namespace log4cxx::spi;
+
+int HTTPAppender::DEFAULT_BATCH_SIZE = 512;
+int HTTPAppender::DEFAULT_BATCH_BYTES = 1024 * 1024;
+int HTTPAppender::DEFAULT_LINGER_TIME = 1000;
+int HTTPAppender::DEFAULT_BUFFER_SIZE = 8192;
+int HTTPAppender::DEFAULT_MAX_RETRIES = 3;
+int HTTPAppender::DEFAULT_RETRY_DELAY = 100;
+int HTTPAppender::MAX_RETRY_DELAY = 30000;
+int HTTPAppender::DEFAULT_TIMEOUT = 10000;
+
+namespace
+{
+	/** Longest line accepted in the head of a response. */
+	const size_t MAX_LINE_LENGTH = 8192;
+
+	/** Reads a response, buffering what is received. */
+	class ResponseReader
+	{
+	public:
+		ResponseReader(SocketPtr socket) : socket(socket), start(0)
+		{
+		}
+
+		/** Returns the next line, without its CRLF. */
+		std::string readLine()
+		{
+			size_t end;
+			while ((end = data.find("\r\n", start)) == std::string::npos)
+			{
+				if (data.size() - start > MAX_LINE_LENGTH)
+				{
+					throw SocketException();
+				}
+				receive();
+			}
+
+			std::string line = data.substr(start, end - start);
+			start = end + 2;
+			return line;
+		}
+
+		/** Skips <code>length</code> bytes. */
+		void skip(size_t length)
+		{
+			while (data.size() - start < length)
+			{
+				length -= data.size() - start;
+				data.erase();
+				start = 0;
+				receive();
+			}
+			start += length;
+		}
+
+		/** Skips everything until the connection is closed. */
+		void skipToEnd()
+		{
+			char buffer[4096];
+			while (socket->readSome(buffer, sizeof(buffer)) != 0)
+			{
+			}
+		}
+
+	private:
+		void receive()
+		{
+			char buffer[4096];
+			size_t length = socket->readSome(buffer, sizeof(buffer));
+			if (length == 0)
+			{
+				// closed in the middle of the response
+				throw SocketException();
+			}
+
+			if (start == data.size())
+			{
+				data.erase();
+				start = 0;
+			}
+			data.append(buffer, length);
+		}
+
+		SocketPtr socket;
+		std::string data;
+		size_t start;
+	};
+
+	std::string toLowerCase(const std::string& s)
+	{
+		std::string result(s);
+		for (size_t i = 0; i < result.size(); i++)
+		{
+			result[i] = (char)tolower((unsigned char)result[i]);
+		}
+		return result;
+	}
+
+	std::string trim(const std::string& s)
+	{
+		size_t begin = s.find_first_not_of(" \t");
+		if (begin == std::string::npos)
+		{
+			return std::string();
+		}
+		size_t end = s.find_last_not_of(" \t");
+		return s.substr(begin, end - begin + 1);
+	}
+
+#ifdef UNICODE
+	/** Appends the multibyte form of <code>s</code> to <code>body</code>,
+	which T2A would truncate. */
+	void appendMultibyte(std::string& body, const tstring& s)
+	{
+		size_t length = ::wcstombs(0, s.c_str(), 0);
+		if (length == (size_t)-1)
+		{
+			return;
+		}
+
+		size_t offset = body.size();
+		body.resize(offset + length + 1);
+		::wcstombs(&body[offset], s.c_str(), length + 1);
+		body.resize(offset + length);
+	}
+#endif
+
+	/**
+	Reads a response and returns its status. <code>keepAlive</code> is
+	set to false if the server closes the connection after it.
+	*/
+	int readResponse(SocketPtr socket, bool& keepAlive)
+	{
+		ResponseReader reader(socket);
+		int status;
+		long contentLength;
+		bool chunked;
+
+		// the interim 1xx responses have no body
+		do
+		{
+			std::string line = reader.readLine();
+			if (line.size() < 12 || line.compare(0, 5, "HTTP/") != 0)
+			{
+				throw SocketException();
+			}
+
+			status = atoi(line.c_str() + 9);
+			keepAlive = line.compare(5, 3, "1.0") != 0;
+			contentLength = -1;
+			chunked = false;
+
+			while (!(line = reader.readLine()).empty())
+			{
+				size_t colon = line.find(':');
+				if (colon == std::string::npos)
+				{
+					continue;
+				}
+
+				std::string name = toLowerCase(line.substr(0, colon));
+				std::string value = toLowerCase(trim(line.substr(colon + 1)));
+				if (name == "content-length")
+				{
+					contentLength = atol(value.c_str());
+				}
+				else if (name == "transfer-encoding")
+				{
+					chunked = value.find("chunked") != std::string::npos;
+				}
+				else if (name == "connection")
+				{
+					if (value == "close")
+					{
+						keepAlive = false;
+					}
+					else if (value == "keep-alive")
+					{
+						keepAlive = true;
+					}
+				}
+			}
+		}
+		while (status >= 100 && status < 200);
+
+		if (status == 204 || status == 304)
+		{
+			return status;
+		}
+
+		if (chunked)
+		{
+			size_t size;
+			while ((size = strtoul(reader.readLine().c_str(), 0, 16)) != 0)
+			{
+				reader.skip(size);
+				reader.readLine();
+			}
+
+			// trailer
+			while (!reader.readLine().empty())
+			{
+			}
+		}
+		else if (contentLength >= 0)
+		{
+			reader.skip(contentLength);
+		}
+		else
+		{
+			reader.skipToEnd();
+			keepAlive = false;
+		}
+
+		return status;
+	}
+}
+
+HTTPAppender::HTTPAppender()
+: contentType(_T("application/x-ndjson")), batchSize(DEFAULT_BATCH_SIZE),
+batchBytes(DEFAULT_BATCH_BYTES), lingerTime(DEFAULT_LINGER_TIME),
+bufferSize(DEFAULT_BUFFER_SIZE), compression(false),
+maxRetries(DEFAULT_MAX_RETRIES), retryDelay(DEFAULT_RETRY_DELAY),
+timeout(DEFAULT_TIMEOUT), port(80), queueBytes(0), firstQueued(0),
+closing(false), senderStarted(false), zstream(0), failing(false),
+sentEvents(0), droppedEvents(0), retries(0), requests(0)
+{
+}
+
+HTTPAppender::HTTPAppender(LayoutPtr layout, const tstring& url)
+: url(url), contentType(_T("application/x-ndjson")),
+batchSize(DEFAULT_BATCH_SIZE), batchBytes(DEFAULT_BATCH_BYTES),
+lingerTime(DEFAULT_LINGER_TIME), bufferSize(DEFAULT_BUFFER_SIZE),
+compression(false), maxRetries(DEFAULT_MAX_RETRIES),
+retryDelay(DEFAULT_RETRY_DELAY), timeout(DEFAULT_TIMEOUT), port(80),
+queueBytes(0), firstQueued(0), closing(false), senderStarted(false),
+zstream(0), failing(false), sentEvents(0), droppedEvents(0), retries(0),
+requests(0)
+{
+	this->layout = layout;
+	activateOptions();
+}
+
+HTTPAppender::~HTTPAppender()
+{
+	finalize();
+
+#ifdef HAVE_LIBZ
+	if (zstream != 0)
+	{
+		::deflateEnd((z_stream *)zstream);
+		delete (z_stream *)zstream;
+	}
+#endif
+}
+
+void HTTPAppender::activateOptions()
+{
+	// http://host[:port][/path]
+	static const tstring scheme = _T("http://");
+	if (!StringHelper::equalsIgnoreCase(url.substr(0, scheme.length()), scheme))
+	{
+		LogLog::error(_T("Unsupported URL [") + url + _T("] for appender [")
+			+ name + _T("]."));
+		return;
+	}
+
+	tstring::size_type slash = url.find(_T('/'), scheme.length());
+	tstring authority = url.substr(scheme.length(),
+		slash == tstring::npos ? tstring::npos : slash - scheme.length());
+	path = (slash == tstring::npos) ? tstring(_T("/")) : url.substr(slash);
+
+	tstring::size_type colon = authority.find(_T(':'));
+	host = authority.substr(0, colon);
+	port = (colon == tstring::npos) ? 80
+		: OptionConverter::toInt(authority.substr(colon + 1), 80);
+
+	if (host.empty())
+	{
+		LogLog::error(_T("No host in URL [") + url + _T("] for appender [")
+			+ name + _T("]."));
+		return;
+	}
+
+	if (!senderStarted)
+	{
+		senderStarted = true;
+		Thread * thread = new Thread(new Sender(this));
+		thread->start();
+	}
+}
+
+void HTTPAppender::setOption(const tstring& option, const tstring& value)
+{
+	if (StringHelper::equalsIgnoreCase(option, _T("url")))
+	{
+		setURL(value);
+	}
+	else if (StringHelper::equalsIgnoreCase(option, _T("contenttype")))
+	{
+		setContentType(value);
+	}
+	else if (StringHelper::equalsIgnoreCase(option, _T("batchsize")))
+	{
+		setBatchSize(OptionConverter::toInt(value, DEFAULT_BATCH_SIZE));
+	}
+	else if (StringHelper::equalsIgnoreCase(option, _T("batchbytes")))
+	{
+		setBatchBytes((int)OptionConverter::toFileSize(value,
+			DEFAULT_BATCH_BYTES));
+	}
+	else if (StringHelper::equalsIgnoreCase(option, _T("lingertime")))
+	{
+		setLingerTime(OptionConverter::toInt(value, DEFAULT_LINGER_TIME));
+	}
+	else if (StringHelper::equalsIgnoreCase(option, _T("buffersize")))
+	{
+		setBufferSize(OptionConverter::toInt(value, DEFAULT_BUFFER_SIZE));
+	}
+	else if (StringHelper::equalsIgnoreCase(option, _T("compression")))
+	{
+		setCompression(StringHelper::equalsIgnoreCase(value, _T("gzip")));
+	}
+	else if (StringHelper::equalsIgnoreCase(option, _T("maxretries")))
+	{
+		setMaxRetries(OptionConverter::toInt(value, DEFAULT_MAX_RETRIES));
+	}
+	else if (StringHelper::equalsIgnoreCase(option, _T("retrydelay")))
+	{
+		setRetryDelay(OptionConverter::toInt(value, DEFAULT_RETRY_DELAY));
+	}
+	else if (StringHelper::equalsIgnoreCase(option, _T("timeout")))
+	{
+		setTimeout(OptionConverter::toInt(value, DEFAULT_TIMEOUT));
+	}
+	else
+	{
+		AppenderSkeleton::setOption(option, value);
+	}
+}
+
+void HTTPAppender::setCompression(bool compression)
+{
+#ifdef HAVE_LIBZ
+	this->compression = compression;
+#else
+	if (compression)
+	{
+		LogLog::warn(_T("log4cxx was built without zlib, appender [")
+			+ name + _T("] does not compress."));
+	}
+#endif
+}
+
+void HTTPAppender::close()
+{
+	{
+		synchronized sync(this);
+
+		if (closed)
+		{
+			return;
+		}
+
+		closed = true;
+	}
+
+	queueCs.lock();
+	closing = true;
+	queueCs.unlock();
+
+	if (senderStarted)
+	{
+		// the thread object deletes itself when it ends: it cannot be
+		// joined.
+		wakeUp.post();
+		senderEnded.wait();
+	}
+}
+
+void HTTPAppender::append(const spi::LoggingEvent& event)
+{
+	if (layout == 0)
+	{
+		errorHandler->error(_T("No layout set for the appender named [")
+			+ name + _T("]."));
+		return;
+	}
+
+	formatStream.str(_T(""));
+	layout->format(formatStream, event);
+	tstring text = formatStream.str();
+
+	queueCs.lock();
+	if ((int)queue.size() >= bufferSize)
+	{
+		queueCs.unlock();
+		Interlocked::increment(&droppedEvents);
+		return;
+	}
+
+	bool wasEmpty = queue.empty();
+	if (wasEmpty)
+	{
+		firstQueued = Clock::monotonicMicros();
+	}
+
+	size_t previousBytes = queueBytes;
+	queue.push_back(tstring());
+	queue.back().swap(text);
+	queueBytes += queue.back().size();
+
+	// the sender is woken up once per batch
+	bool complete = (int)queue.size() == batchSize
+		|| (previousBytes < (size_t)batchBytes
+		&& queueBytes >= (size_t)batchBytes);
+	queueCs.unlock();
+
+	if (wasEmpty || complete)
+	{
+		wakeUp.post();
+	}
+}
+
+bool HTTPAppender::nextBatch(std::vector<tstring>& batch)
+{
+	while (true)
+	{
+		queueCs.lock();
+
+		if (queue.empty())
+		{
+			bool ended = closing;
+			queueCs.unlock();
+
+			if (ended)
+			{
+				return false;
+			}
+
+			wakeUp.wait();
+			continue;
+		}
+
+		int64 waited = Clock::monotonicMicros() - firstQueued;
+		if (closing || (int)queue.size() >= batchSize
+			|| queueBytes >= (size_t)batchBytes
+			|| waited >= (int64)lingerTime * 1000)
+		{
+			size_t bytes = 0;
+			while (!queue.empty() && (int)batch.size() < batchSize
+				&& (batch.empty()
+				|| bytes + queue.front().size() <= (size_t)batchBytes))
+			{
+				bytes += queue.front().size();
+				batch.push_back(tstring());
+				batch.back().swap(queue.front());
+				queue.pop_front();
+			}
+			queueBytes -= bytes;
+
+			// the events left have waited at least as long
+			queueCs.unlock();
+			return true;
+		}
+
+		queueCs.unlock();
+
+		long remaining = (long)(((int64)lingerTime * 1000 - waited) / 1000);
+		wakeUp.wait(remaining > 0 ? remaining : 1);
+	}
+}
+
+void HTTPAppender::send(std::vector<tstring>& batch)
+{
+	size_t length = 0;
+	for (size_t i = 0; i < batch.size(); i++)
+	{
+		length += batch[i].size();
+	}
+
+	std::string body;
+	body.reserve(length);
+	for (size_t i = 0; i < batch.size(); i++)
+	{
+#ifdef UNICODE
+		appendMultibyte(body, batch[i]);
+#else
+		body.append(batch[i]);
+#endif
+	}
+
+	if (compression)
+	{
+		compress(body);
+	}
+
+	USES_CONVERSION;
+	std::ostringstream head;
+	head << "POST " << T2A(path.c_str()) << " HTTP/1.1\r\n"
+		<< "Host: " << T2A(host.c_str());
+	if (port != 80)
+	{
+		head << ":" << port;
+	}
+	head << "\r\n"
+		<< "User-Agent: log4cxx/" << VERSION << "\r\n"
+		<< "Content-Type: " << T2A(contentType.c_str()) << "\r\n"
+		<< "Content-Length: " << body.size() << "\r\n";
+	if (compression)
+	{
+		head << "Content-Encoding: gzip\r\n";
+	}
+	head << "\r\n";
+
+	// a single write, so that the request is not split in two segments
+	std::string request = head.str();
+	request.append(body);
+
+	long delay = retryDelay;
+	int attempts = failing ? 0 : maxRetries;
+	for (int attempt = 0; ; attempt++)
+	{
+		int status = 0;
+		try
+		{
+			bool reused = (socket != 0);
+			try
+			{
+				status = exchange(request);
+			}
+			catch (IOException&)
+			{
+				// a connection kept alive may have been closed by the
+				// server meanwhile: the request is sent again at once
+				disconnect();
+				if (!reused)
+				{
+					throw;
+				}
+				status = exchange(request);
+			}
+		}
+		catch (IOException&)
+		{
+			disconnect();
+		}
+
+		if (status >= 200 && status < 300)
+		{
+			failing = false;
+			Interlocked::add(&sentEvents, (long)batch.size());
+			Interlocked::increment(&requests);
+			return;
+		}
+
+		bool transient = status == 0 || status == 408 || status == 429
+			|| status >= 500;
+		if (!transient || attempt >= attempts)
+		{
+			failing = transient;
+			Interlocked::add(&droppedEvents, (long)batch.size());
+			tostringstream message;
+			message << _T("Could not send ") << batch.size()
+				<< _T(" events to [") << url << _T("]");
+			if (status != 0)
+			{
+				message << _T(", status ") << status;
+			}
+			errorHandler->error(message.str());
+			return;
+		}
+
+		LOGLOG_DEBUG(_T("Request to [") << url << _T("] failed (status ")
+			<< status << _T("), retrying in ") << delay << _T(" ms."));
+		Interlocked::increment(&retries);
+		Thread::sleep(delay);
+		delay = (2 * delay < MAX_RETRY_DELAY) ? 2 * delay : MAX_RETRY_DELAY;
+	}
+}
+
+int HTTPAppender::exchange(const std::string& request)
+{
+	if (socket == 0)
+	{
+		socket = new Socket(InetAddress::getByName(host), port);
+		socket->setSoTimeout(timeout);
+	}
+
+	socket->write(request.data(), request.size());
+
+	bool keepAlive;
+	int status = readResponse(socket, keepAlive);
+	if (!keepAlive)
+	{
+		disconnect();
+	}
+
+	return status;
+}
+
+void HTTPAppender::compress(std::string& body)
+{
+#ifdef HAVE_LIBZ
+	z_stream * zs = (z_stream *)zstream;
+	if (zs == 0)
+	{
+		// gzip format, the fastest compression
+		zs = new z_stream;
+		memset(zs, 0, sizeof(z_stream));
+		if (::deflateInit2(zs, Z_BEST_SPEED, Z_DEFLATED, 15 + 16, 8,
+			Z_DEFAULT_STRATEGY) != Z_OK)
+		{
+			delete zs;
+			compression = false;
+			LogLog::error(_T("Could not initialize compression for appender [")
+				+ name + _T("]."));
+			return;
+		}
+		zstream = zs;
+	}
+	else
+	{
+		::deflateReset(zs);
+	}
+
+	std::string compressed;
+	compressed.resize(::deflateBound(zs, body.size()));
+	zs->next_in = (Bytef *)body.data();
+	zs->avail_in = body.size();
+	zs->next_out = (Bytef *)&compressed[0];
+	zs->avail_out = compressed.size();
+
+	// the output buffer is large enough to finish at once
+	::deflate(zs, Z_FINISH);
+	compressed.resize(compressed.size() - zs->avail_out);
+	body.swap(compressed);
+#endif
+}
+
+void HTTPAppender::disconnect()
+{
+	if (socket != 0)
+	{
+		try
+		{
+			socket->close();
+		}
+		catch (IOException&)
+		{
+		}
+		socket = 0;
+	}
+}
+
+HTTPAppender::Sender::Sender(HTTPAppender * appender)
+: appender(appender)
+{
+}
+
+void HTTPAppender::Sender::run()
+{
+	std::vector<tstring> batch;
+	while (appender->nextBatch(batch))
+	{
+		appender->send(batch);
+		batch.clear();
+	}
+
+	appender->disconnect();
+	appender->senderEnded.post();
+}
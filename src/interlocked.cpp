@@ -0,0 +1,113 @@
+/***************************************************************************
+                          interlocked.cpp  -  class Interlocked
+                             -------------------
+    begin                : lun mai 19 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/helpers/interlocked.h>
+
+#ifdef WIN32
+#include <windows.h>
+#elif defined(HAVE_PTHREAD_H) && !defined(__GNUC__)
+#include <pthread.h>
+
+// compilers without atomic builtins fall back to a global mutex
+static pthread_mutex_t interlockedMutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+using namespace log4cxx::helpers;
+
+long Interlocked::increment(volatile long * value)
+{
+#ifdef WIN32
+	return ::InterlockedIncrement((long *)value);
+#elif defined(__GNUC__)
+	return __sync_add_and_fetch(value, 1);
+#else
+	return add(value, 1);
+#endif
+}
+
+long Interlocked::decrement(volatile long * value)
+{
+#ifdef WIN32
+	return ::InterlockedDecrement((long *)value);
+#elif defined(__GNUC__)
+	return __sync_sub_and_fetch(value, 1);
+#else
+	return add(value, -1);
+#endif
+}
+
+long Interlocked::add(volatile long * value, long delta)
+{
+#ifdef WIN32
+	return ::InterlockedExchangeAdd((long *)value, delta) + delta;
+#elif defined(__GNUC__)
+	return __sync_add_and_fetch(value, delta);
+#elif defined(HAVE_PTHREAD_H)
+	pthread_mutex_lock(&interlockedMutex);
+	long result = (*value += delta);
+	pthread_mutex_unlock(&interlockedMutex);
+	return result;
+#else
+	return (*value += delta);
+#endif
+}
+
+long Interlocked::compareExchange(volatile long * dest, long exchange,
+	long comparand)
+{
+#ifdef WIN32
+	return ::InterlockedCompareExchange((long *)dest, exchange, comparand);
+#elif defined(__GNUC__)
+	return __sync_val_compare_and_swap(dest, comparand, exchange);
+#else
+#ifdef HAVE_PTHREAD_H
+	pthread_mutex_lock(&interlockedMutex);
+#endif
+	long initial = *dest;
+	if (initial == comparand)
+	{
+		*dest = exchange;
+	}
+#ifdef HAVE_PTHREAD_H
+	pthread_mutex_unlock(&interlockedMutex);
+#endif
+	return initial;
+#endif
+}
+
+void * Interlocked::compareExchange(void * volatile * dest,
+	void * exchange, void * comparand)
+{
+#ifdef WIN32
+	return ::InterlockedCompareExchangePointer((void **)dest,
+		exchange, comparand);
+#elif defined(__GNUC__)
+	return __sync_val_compare_and_swap(dest, comparand, exchange);
+#else
+#ifdef HAVE_PTHREAD_H
+	pthread_mutex_lock(&interlockedMutex);
+#endif
+	void * initial = *dest;
+	if (initial == comparand)
+	{
+		*dest = exchange;
+	}
+#ifdef HAVE_PTHREAD_H
+	pthread_mutex_unlock(&interlockedMutex);
+#endif
+	return initial;
+#endif
+}
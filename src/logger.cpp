@@ -23,24 +23,64 @@
 #include <log4cxx/appender.h>
 #include <log4cxx/level.h>
 #include <log4cxx/helpers/loglog.h>
+#include <log4cxx/helpers/interlocked.h>
+#include <log4cxx/helpers/criticalsection.h>
+#include <map>
+#include <algorithm>
 
 using namespace log4cxx;
 using namespace log4cxx::helpers;
 using namespace log4cxx::spi;
 
+volatile long Logger::generation = 0;
+volatile long Logger::redirections = 0;
+
+/** Target of a redirected appender and the appender it is equivalent
+to. */
+typedef std::pair<AppenderPtr, AppenderPtr> Redirection;
+typedef std::map<Appender *, Redirection> RedirectionMap;
+
+/** Targets of the appenders redirected by Logger::redirectAppender. */
+static RedirectionMap redirectionMap;
+static CriticalSection redirectionCs;
+
 Logger::Logger(const tstring& name)
 : name(name), level(&Level::OFF), additive(true)
 {
-
+	dispatch.generation = -1;
+	dispatch.threshold = Level::ALL_INT;
+	dispatch.effectiveLevel = &Level::OFF;
+	dispatch.appenders = 0;
 }
 
 Logger::~Logger()
 {
 }
 
+void * Logger::operator new(size_t size)
+{
+	return Arena::allocateAligned(size);
+}
+
+void * Logger::operator new(size_t size, Arena * arena)
+{
+	return (arena != 0) ? arena->allocate(size) : Arena::allocateAligned(size);
+}
+
+void Logger::operator delete(void * p)
+{
+	Arena::deallocate(p);
+}
+
+void Logger::operator delete(void * p, Arena *)
+{
+	Arena::deallocate(p);
+}
+
 void Logger::addAppender(AppenderPtr newAppender)
 {
 	AppenderAttachableImpl::addAppender(newAppender);
+	invalidateDispatchState();
 	repository->fireAddAppenderEvent(this, newAppender);
 }
 
@@ -55,19 +95,19 @@ void Logger::assertLog(bool assertion, const tstring& msg)
 
 void Logger::callAppenders(const spi::LoggingEvent& event)
 {
-	int writes = 0;
-
-	for(LoggerPtr logger = this; logger != 0; logger = logger->parent)
+	// the snapshot is not released until the reader leaves, even if it
+	// is replaced meanwhile
+	Reclaimer::Reader reader(snapshots);
+	AppenderSnapshot * snapshot = getAppenderSnapshot();
+	AppenderList& appenders = snapshot->appenders;
+
+	AppenderList::iterator it, itEnd = appenders.end();
+	for(it = appenders.begin(); it != itEnd; it++)
 	{
-		writes += logger->appendLoopOnAppenders(event);
-
-		if(!logger->additive)
-		{
-			break;
-		}
+		(*it)->doAppend(event);
 	}
 
-	if(writes == 0)
+	if(appenders.empty())
 	{
 		repository->emitNoAppenderWarning(this);
 	}
@@ -75,9 +115,6 @@ void Logger::callAppenders(const spi::LoggingEvent& event)
 
 void Logger::closeNestedAppenders()
 {
-	synchronized sync(this);
-
-	
     AppenderList appenders = getAllAppenders();
     for(AppenderList::iterator it=appenders.begin(); it!=appenders.end(); ++it)
     {
@@ -87,12 +124,9 @@ void Logger::closeNestedAppenders()
 
 void Logger::debug(const tstring& message, const char* file, int line)
 {
-	if(repository->isDisabled(Level::DEBUG_INT))
-	{
-		return;
-	}
-	
-	if(Level::DEBUG.isGreaterOrEqual(getEffectiveLevel()))
+	checkDispatchState();
+
+	if(Level::DEBUG_INT >= dispatch.threshold)
 	{
 		 forcedLog(Level::DEBUG, message, file, line);
 	}
@@ -100,12 +134,9 @@ void Logger::debug(const tstring& message, const char* file, int line)
 
 void Logger::error(const tstring& message, const char* file, int line)
 {
-	if(repository->isDisabled(Level::ERROR_INT))
-	{
-		return;
-	}
+	checkDispatchState();
 
-	if(Level::ERROR.isGreaterOrEqual(getEffectiveLevel()))
+	if(Level::ERROR_INT >= dispatch.threshold)
 	{
 		 forcedLog(Level::ERROR, message, file, line);
 	}
@@ -113,12 +144,9 @@ void Logger::error(const tstring& message, const char* file, int line)
 
 void Logger::fatal(const tstring& message, const char* file, int line)
 {
-	if(repository->isDisabled(Level::FATAL_INT))
-	{
-		return;
-	}
+	checkDispatchState();
 
-	if(Level::FATAL.isGreaterOrEqual(getEffectiveLevel()))
+	if(Level::FATAL_INT >= dispatch.threshold)
 	{
 		 forcedLog(Level::FATAL, message, file, line);
 	}
@@ -130,6 +158,12 @@ void Logger::forcedLog(const Level& level, const tstring& message,
 	callAppenders(LoggingEvent(this, level, message, file, line));
 }
 
+void Logger::forcedLog(const Level& level, const tstring& message,
+	const Fields& fields, const char* file, int line)
+{
+	callAppenders(LoggingEvent(this, level, message, fields, file, line));
+}
+
 bool Logger::getAdditivity()
 {
 	return additive;
@@ -137,15 +171,9 @@ bool Logger::getAdditivity()
 
 const Level& Logger::getEffectiveLevel()
 {
-	for(Logger * l = this; l != 0; l=l->parent)
-	{
-		if(l->level != &Level::OFF)
-		{
-			return *l->level;
-		}
-	}
+	checkDispatchState();
 
-	return Level::OFF; // If reached will cause an NullPointerException.
+	return *dispatch.effectiveLevel;
 }
 
 LoggerRepositoryPtr Logger::getLoggerRepository()
@@ -155,7 +183,7 @@ LoggerRepositoryPtr Logger::getLoggerRepository()
 
 LoggerPtr Logger::getParent()
 {
-	return parent;
+	return dispatch.parent;
 }
 
 const Level& Logger::getLevel()
@@ -165,12 +193,9 @@ const Level& Logger::getLevel()
 
 void Logger::info(const tstring& message, const char* file, int line)
 {
-	if(repository->isDisabled(Level::INFO_INT))
-	{
-		return;
-	}
+	checkDispatchState();
 
-	if(Level::INFO.isGreaterOrEqual(getEffectiveLevel()))
+	if(Level::INFO_INT >= dispatch.threshold)
 	{
 		 forcedLog(Level::INFO, message, file, line);
 	}
@@ -178,53 +203,70 @@ void Logger::info(const tstring& message, const char* file, int line)
 
 bool Logger::isDebugEnabled()
 {
-	if(repository->isDisabled(Level::DEBUG_INT))
-	{
-		return false;
-	}
-	
-	return Level::DEBUG.isGreaterOrEqual(getEffectiveLevel());
+	checkDispatchState();
+
+	return Level::DEBUG_INT >= dispatch.threshold;
 }
 
 bool Logger::isEnabledFor(const Level& level)
 {
-	if(repository->isDisabled(level.level))
-	{
-		return false;
-	}
-	
-	return level.isGreaterOrEqual(getEffectiveLevel());
+	checkDispatchState();
+
+	return level.level >= dispatch.threshold;
 }
 
 bool Logger::isInfoEnabled()
 {
-	if(repository->isDisabled(Level::INFO_INT))
-	{
-		return false;
-	}
-
-	return Level::INFO.isGreaterOrEqual(getEffectiveLevel());
+	checkDispatchState();
 
+	return Level::INFO_INT >= dispatch.threshold;
 }
 
 void Logger::log(const Level& level, const tstring& message,
 	const char* file, int line)
 {
+	checkDispatchState();
 
-	if(repository->isDisabled(level.level))
+	if(level.level >= dispatch.threshold)
 	{
-		return;
+		forcedLog(level, message, file, line);
 	}
-	if(level.isGreaterOrEqual(getEffectiveLevel()))
+
+}
+
+void Logger::log(const Level& level, const tstring& message,
+	const Fields& fields, const char* file, int line)
+{
+	checkDispatchState();
+
+	if(level.level >= dispatch.threshold)
 	{
-		forcedLog(level, message, file, line);
+		forcedLog(level, message, fields, file, line);
 	}
+}
 
+void Logger::removeAllAppenders()
+{
+	AppenderAttachableImpl::removeAllAppenders();
+	invalidateDispatchState();
+}
+
+void Logger::removeAppender(AppenderPtr appender)
+{
+	AppenderAttachableImpl::removeAppender(appender);
+	invalidateDispatchState();
+}
+
+void Logger::removeAppender(const tstring& name)
+{
+	AppenderAttachableImpl::removeAppender(name);
+	invalidateDispatchState();
 }
 
 void Logger::setAdditivity(bool additive)
 {
 	this->additive = additive;
+	invalidateDispatchState();
 }
 
 void Logger::setHierarchy(spi::LoggerRepository * repository)
@@ -235,16 +277,168 @@ void Logger::setHierarchy(spi::LoggerRepository * repository)
 void Logger::setLevel(const Level& level)
 {
 	this->level = &level;
+	invalidateDispatchState();
 }
 
-void Logger::warn(const tstring& message, const char* file, int line)
+void Logger::invalidateDispatchState()
 {
-	if(repository->isDisabled(Level::WARN_INT))
+	Interlocked::increment(&generation);
+}
+
+void Logger::updateDispatchState()
+{
+	// the lock of the repository is used rather than the one of this
+	// logger, which would otherwise be created for each logger.
+	synchronized sync(repository);
+
+	long current = generation;
+	if (dispatch.generation == current)
+	{
+		return;
+	}
+
+	const Level * effectiveLevel = &Level::OFF;
+	for(Logger * l = this; l != 0; l = l->dispatch.parent)
+	{
+		if(l->level != &Level::OFF)
+		{
+			effectiveLevel = l->level;
+			break;
+		}
+	}
+
+	int threshold = effectiveLevel->level;
+	if (repository != 0 && repository->getThreshold().level > threshold)
+	{
+		threshold = repository->getThreshold().level;
+	}
+
+	// the generation is written last: a thread which reads the current
+	// generation will also read the values computed for it.
+	dispatch.effectiveLevel = effectiveLevel;
+	dispatch.threshold = threshold;
+	dispatch.generation = current;
+}
+
+Logger::AppenderSnapshot * Logger::updateAppenderSnapshot()
+{
+	synchronized sync(this);
+
+	long current = generation;
+	AppenderSnapshot * previous = dispatch.appenders;
+	if (previous != 0 && previous->generation == current)
+	{
+		return previous;
+	}
+
+	AppenderList appenders;
+
+	// the lock of this logger is already held: its appender list is read
+	// directly, the ones of the ancestors through getAllAppenders.
+	appenders.insert(appenders.end(), appenderList.begin(), appenderList.end());
+	if (additive)
+	{
+		for(LoggerPtr logger = dispatch.parent; logger != 0;
+			logger = logger->dispatch.parent)
+		{
+			AppenderList list = logger->getAllAppenders();
+			appenders.insert(appenders.end(), list.begin(), list.end());
+
+			if(!logger->additive)
+			{
+				break;
+			}
+		}
+	}
+
+	if (redirections != 0)
+	{
+		redirectAppenders(appenders);
+	}
+
+	// most changes of the configuration do not change the appenders:
+	// the snapshot being read by other threads is kept.
+	if (previous != 0 && previous->appenders == appenders)
+	{
+		previous->generation = current;
+		return previous;
+	}
+
+	AppenderSnapshotPtr snapshot = new AppenderSnapshot();
+	snapshot->appenders.swap(appenders);
+	snapshot->generation = current;
+
+	// published with a barrier, after the snapshot is complete
+	Interlocked::compareExchange((void * volatile *)&dispatch.appenders,
+		(AppenderSnapshot *)snapshot, previous);
+
+	// the previous snapshot may still be read by other threads
+	if (appenderSnapshot != 0)
+	{
+		snapshots.retire(appenderSnapshot);
+	}
+	appenderSnapshot = snapshot;
+	return snapshot;
+}
+
+void Logger::redirectAppender(AppenderPtr appender, AppenderPtr target,
+	AppenderPtr equivalent)
+{
+	if (appender == 0)
 	{
 		return;
 	}
 
-	if(Level::WARN.isGreaterOrEqual(getEffectiveLevel()))
+	redirectionCs.lock();
+
+	if (target != 0)
+	{
+		redirectionMap[appender] = Redirection(target,
+			(equivalent != 0) ? equivalent : target);
+	}
+	else
+	{
+		redirectionMap.erase(appender);
+	}
+
+	redirections = (long)redirectionMap.size();
+
+	redirectionCs.unlock();
+
+	invalidateDispatchState();
+}
+
+void Logger::redirectAppenders(AppenderList& appenders)
+{
+	redirectionCs.lock();
+
+	AppenderList::iterator it = appenders.begin();
+	while (it != appenders.end())
+	{
+		RedirectionMap::iterator redirection = redirectionMap.find(*it);
+		if (redirection == redirectionMap.end())
+		{
+			it++;
+		}
+		else if (std::find(appenders.begin(), appenders.end(),
+			redirection->second.second) != appenders.end())
+		{
+			it = appenders.erase(it);
+		}
+		else
+		{
+			*it++ = redirection->second.first;
+		}
+	}
+
+	redirectionCs.unlock();
+}
+
+void Logger::warn(const tstring& message, const char* file, int line)
+{
+	checkDispatchState();
+
+	if(Level::WARN_INT >= dispatch.threshold)
 	{
 		 forcedLog(Level::WARN, message, file, line);
 	}
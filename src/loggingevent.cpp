@@ -22,41 +22,154 @@
 #include <log4cxx/helpers/socketoutputstream.h>
 #include <log4cxx/helpers/socketinputstream.h>
 #include <log4cxx/helpers/loglog.h>
+#include <log4cxx/helpers/clock.h>
+#include <log4cxx/helpers/interlocked.h>
+#include <log4cxx/helpers/stringhelper.h>
+#include <log4cxx/helpers/socketimpl.h>
+#include <log4cxx/helpers/stacktrace.h>
 
 using namespace log4cxx;
 using namespace log4cxx::spi;
 using namespace log4cxx::helpers;
 
+/**
+Writes a string given by its characters as SocketOutputStream writes a
+tstring. The characters are copied: they may not outlive the call.
+*/
+static void writeChars(SocketOutputStreamPtr& os, const TCHAR * chars,
+	size_t length)
+{
+	tstring::size_type size = length;
+	if (size > SocketOutputStream::MAX_STRING_LENGTH)
+	{
+		size = SocketOutputStream::MAX_STRING_LENGTH;
+	}
+
+	os->write(&size, sizeof(tstring::size_type));
+	if (size > 0)
+	{
+		os->write(chars, size * sizeof(TCHAR));
+	}
+}
+
 // time at startup
 time_t LoggingEvent::startTime = time(0);
 
+int LoggingEvent::maxMessageLength = 0;
+int LoggingEvent::maxNDCLength = 0;
+int LoggingEvent::stackTraceLevel = Level::OFF_INT;
+volatile long LoggingEvent::truncatedMessages = 0;
+volatile long LoggingEvent::truncatedNDCs = 0;
+
 LoggingEvent::LoggingEvent()
-: timeStamp(0), level(&Level::OFF), ndcLookupRequired(true), line(0)
+: level(&Level::OFF), timeStamp(0), microseconds(0), line(0),
+ndcLookupRequired(true), stackTrace(0)
 {
 }
 
 LoggingEvent::LoggingEvent(const LoggerPtr& logger, const Level& level,
 	const tstring& message, const char* file, int line)
-: logger(logger), level(&level), message(message), file((char*)file), 
-line(line), timeStamp(time(0)), ndcLookupRequired(true)
+: logger(logger), level(&level), file((char*)file),
+line(line), ndcLookupRequired(true), stackTrace(0)
 {
+	init(message);
+}
+
+LoggingEvent::LoggingEvent(const LoggerPtr& logger, const Level& level,
+	const tstring& message, const Fields& fields, const char* file, int line)
+: logger(logger), level(&level), file((char*)file),
+line(line), ndcLookupRequired(true), stackTrace(0)
+{
+	// the strings of the fields are copied only with the event
+	this->fields.view(fields);
+	init(message);
+}
+
+void LoggingEvent::init(const tstring& message)
+{
+	// only what is kept of a long message is copied
+	if (maxMessageLength > 0 && message.size() > (size_t)maxMessageLength)
+	{
+		StringHelper::truncate(message, maxMessageLength, this->message);
+		Interlocked::increment(&truncatedMessages);
+	}
+	else
+	{
+		this->message = message;
+	}
+
+	int64 now = Clock::currentTimeMicros();
+	timeStamp = (time_t)(now / 1000000);
+	microseconds = (long)(now % 1000000);
 	threadId = Thread::getCurrentThreadId();
+
+	// only the addresses are captured here, they are symbolized by the
+	// thread which formats the event.
+	if (level->level >= stackTraceLevel)
+	{
+		stackTrace = new StackTrace();
+		stackTrace->capture(2);
+	}
 }
 
 LoggingEvent::LoggingEvent(const LoggingEvent& event)
 : logger(event.logger), level(event.level), message(event.message),
-file(event.file), line(event.line), timeStamp(event.timeStamp),
+timeStamp(event.timeStamp), microseconds(event.microseconds),
+file(event.file), line(event.line),
 ndcLookupRequired(event.ndcLookupRequired), ndc(event.ndc),
-threadId(event.threadId)
+threadId(event.threadId), fields(event.fields),
+stackTrace(event.stackTrace ? new StackTrace(*event.stackTrace) : 0)
 {
 }
 
+LoggingEvent::LoggingEvent(const LoggingEvent& event, int maxMessageLength,
+	int maxNDCLength)
+: logger(event.logger), level(event.level),
+timeStamp(event.timeStamp), microseconds(event.microseconds),
+file(event.file), line(event.line), ndcLookupRequired(false),
+threadId(event.threadId), fields(event.fields),
+stackTrace(event.stackTrace ? new StackTrace(*event.stackTrace) : 0)
+{
+	const tstring& ndc = event.getNDC();
+
+	if (maxMessageLength > 0 && event.message.size() > (size_t)maxMessageLength)
+	{
+		StringHelper::truncate(event.message, maxMessageLength, message);
+	}
+	else
+	{
+		message = event.message;
+	}
+
+	if (maxNDCLength > 0 && ndc.size() > (size_t)maxNDCLength)
+	{
+		StringHelper::truncate(ndc, maxNDCLength, this->ndc);
+	}
+	else
+	{
+		this->ndc = ndc;
+	}
+}
+
+LoggingEvent::~LoggingEvent()
+{
+	delete stackTrace;
+}
+
 const tstring& LoggingEvent::getNDC() const
 {
 	if(ndcLookupRequired)
 	{
 		((LoggingEvent *)this)->ndcLookupRequired = false;
 		((LoggingEvent *)this)->ndc = NDC::get();
+
+		if (maxNDCLength > 0 && ndc.size() > (size_t)maxNDCLength)
+		{
+			tstring truncated;
+			StringHelper::truncate(ndc, maxNDCLength, truncated);
+			((LoggingEvent *)this)->ndc = truncated;
+			Interlocked::increment(&truncatedNDCs);
+		}
 	}
 
 	return ndc;
@@ -86,6 +199,44 @@ void LoggingEvent::write(helpers::SocketOutputStreamPtr os) const
 
 	// threadId
 	os->write(threadId);
+
+	// fields
+	os->write(fields.size());
+	for (int i = 0; i < fields.size(); i++)
+	{
+		const Field& field = fields[i];
+		writeChars(os, field.name, field.nameLength);
+		os->write((int)field.type);
+
+		switch (field.type)
+		{
+		case Field::INT64:
+			os->write(&field.value.int64Value, sizeof(int64));
+			break;
+
+		case Field::DOUBLE:
+			os->write(&field.value.doubleValue, sizeof(double));
+			break;
+
+		case Field::STRING:
+			writeChars(os, field.string, field.stringLength);
+			break;
+
+		case Field::BOOL:
+			os->write(field.value.boolValue ? 1 : 0);
+			break;
+		}
+	}
+
+	// stack trace, symbolized here since the addresses are only
+	// meaningful in this process. The text is temporary: it is copied,
+	// while the stream would reference a long string until it is flushed.
+	tstring trace;
+	if (stackTrace != 0)
+	{
+		trace = stackTrace->toString();
+	}
+	writeChars(os, trace.c_str(), trace.size());
 }
 
 void LoggingEvent::read(helpers::SocketInputStreamPtr is)
@@ -105,6 +256,7 @@ void LoggingEvent::read(helpers::SocketInputStreamPtr is)
 
 	// timeStamp
 	is->read(timeStamp);
+	microseconds = 0;
 
 	// file
 	file = 0;
@@ -112,11 +264,74 @@ void LoggingEvent::read(helpers::SocketInputStreamPtr is)
 	// line
 	is->read(line);
 
-	// ndc
+	// ndc, which is the one of the sender and not of this thread
 	is->read(ndc);
+	ndcLookupRequired = false;
 
 	// threadId
 	is->read(threadId);
+
+	// fields, whose strings are read before they are copied
+	int count;
+	is->read(count);
+	if (count < 0 || count > Fields::MAX_FIELDS)
+	{
+		throw SocketException();
+	}
+
+	tstring names[Fields::MAX_FIELDS];
+	tstring strings[Fields::MAX_FIELDS];
+	Fields received;
+	for (int i = 0; i < count; i++)
+	{
+		is->read(names[i]);
+
+		int type;
+		is->read(type);
+
+		switch (type)
+		{
+		case Field::INT64:
+		{
+			int64 value;
+			is->read(&value, sizeof(value));
+			received.add(names[i].c_str(), value);
+			break;
+		}
+
+		case Field::DOUBLE:
+		{
+			double value;
+			is->read(&value, sizeof(value));
+			received.add(names[i].c_str(), value);
+			break;
+		}
+
+		case Field::STRING:
+			is->read(strings[i]);
+			received.add(names[i].c_str(), strings[i]);
+			break;
+
+		case Field::BOOL:
+		{
+			int value;
+			is->read(value);
+			received.add(names[i].c_str(), value != 0);
+			break;
+		}
+
+		default:
+			throw SocketException();
+		}
+	}
+
+	fields = received;
+
+	// stack trace
+	tstring trace;
+	is->read(trace);
+	delete stackTrace;
+	stackTrace = trace.empty() ? 0 : new StackTrace(trace);
 }
 
 LoggingEvent * LoggingEvent::copy() const
@@ -124,5 +339,23 @@ LoggingEvent * LoggingEvent::copy() const
 	return new LoggingEvent(*this);
 }
 
+bool LoggingEvent::exceeds(int maxMessageLength, int maxNDCLength) const
+{
+	return (maxMessageLength > 0 && message.size() > (size_t)maxMessageLength)
+		|| (maxNDCLength > 0 && getNDC().size() > (size_t)maxNDCLength);
+}
 
+void LoggingEvent::setMaxMessageLength(int maxMessageLength)
+{
+	LoggingEvent::maxMessageLength = (maxMessageLength > 0) ? maxMessageLength : 0;
+}
 
+void LoggingEvent::setStackTraceLevel(const Level& level)
+{
+	stackTraceLevel = level.level;
+}
+
+void LoggingEvent::setMaxNDCLength(int maxNDCLength)
+{
+	LoggingEvent::maxNDCLength = (maxNDCLength > 0) ? maxNDCLength : 0;
+}
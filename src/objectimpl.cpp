@@ -15,74 +15,104 @@
  ***************************************************************************/
  
 #include <log4cxx/helpers/objectimpl.h>
-
-#ifdef WIN32
-#include <windows.h>
-#endif
+#include <log4cxx/helpers/interlocked.h>
 
 using namespace log4cxx::helpers;
 
-ObjectImpl::ObjectImpl() : ref(0)
+ObjectImpl::ObjectImpl() : ref(0), cs(0), sem(0)
+{
+}
+
+ObjectImpl::ObjectImpl(const ObjectImpl&) : ref(0), cs(0), sem(0)
 {
 }
 
 ObjectImpl::~ObjectImpl()
 {
+	delete cs;
+	delete sem;
+}
+
+ObjectImpl& ObjectImpl::operator=(const ObjectImpl&)
+{
+	// the reference count and the synchronization objects are never
+	// shared between two instances.
+	return *this;
 }
 
 void ObjectImpl::addRef()
 {
-#ifdef HAVE_PTHREAD_H
-	refCs.lock();
-	ref++;
-	refCs.unlock();
-#elif defined(WIN32)
-	::InterlockedIncrement((long *)&ref);
-#else
-	ref++;
-#endif
+	Interlocked::increment(&ref);
 }
 
 void ObjectImpl::releaseRef()
 {
-#ifdef HAVE_PTHREAD_H
-	refCs.lock();
-	ref--;
-	if (ref <= 0)
-	{
-		delete this;
-	}
-	refCs.unlock();
-#elif defined(WIN32)
-	if (::InterlockedDecrement((long *)&ref) <= 0)
-	{
-		delete this;
-	}
-#else
-	ref--;
-	if (ref <= 0)
+	if (Interlocked::decrement(&ref) <= 0)
 	{
 		delete this;
 	}
-#endif
 }
 
 void ObjectImpl::lock()
 {
-	cs.lock();
+	getCriticalSection()->lock();
 }
 
 void ObjectImpl::unlock()
 {
-	cs.unlock();
+	getCriticalSection()->unlock();
 }
 
 void ObjectImpl::wait()
 {
-	sem.wait();
+	getSemaphore()->wait();
 }
 
 void ObjectImpl::notify()
 {
-	sem.post();
+	getSemaphore()->post();
+}
+
+CriticalSection * ObjectImpl::getCriticalSection()
+{
+	CriticalSection * current = cs;
+	if (current == 0)
+	{
+		// several threads may race here: the first one to publish its
+		// critical section wins, the others delete theirs.
+		CriticalSection * created = new CriticalSection();
+		current = (CriticalSection *)Interlocked::compareExchange(
+			(void * volatile *)&cs, created, 0);
+		if (current == 0)
+		{
+			current = created;
+		}
+		else
+		{
+			delete created;
+		}
+	}
+
+	return current;
+}
+
+Semaphore * ObjectImpl::getSemaphore()
+{
+	Semaphore * current = sem;
+	if (current == 0)
+	{
+		Semaphore * created = new Semaphore();
+		current = (Semaphore *)Interlocked::compareExchange(
+			(void * volatile *)&sem, created, 0);
+		if (current == 0)
+		{
+			current = created;
+		}
+		else
+		{
+			delete created;
+		}
+	}
+
+	return current;
 }
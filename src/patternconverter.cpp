@@ -16,15 +16,18 @@
 
 #include <log4cxx/helpers/patternconverter.h>
 #include <log4cxx/helpers/formattinginfo.h>
+#include <log4cxx/helpers/gatherbuffer.h>
+#include <log4cxx/helpers/transform.h>
 
 using namespace log4cxx;
 using namespace log4cxx::helpers;
 
-PatternConverter::PatternConverter() : min(-1), max(0x7FFFFFFF), leftAlign(false)
+PatternConverter::PatternConverter() : min(-1), max(0x7FFFFFFF), leftAlign(false),
+sanitize(false)
 {
 }
 
-PatternConverter::PatternConverter(const FormattingInfo& fi)
+PatternConverter::PatternConverter(const FormattingInfo& fi) : sanitize(false)
 {
 	min = fi.min;
 	max = fi.max;
@@ -51,9 +54,20 @@ void PatternConverter::format(tostream& sbuf, const spi::LoggingEvent& e)
 	
 	if(len > max)
 	{
-		sbuf << (s.substr(len-max));
+		s.erase(0, len-max);
+		len = max;
 	}
-	else if(len < min)
+
+	// after the truncation, which could cut an escape sequence
+	if(sanitize && Transform::scanSafe(s.data(), len) != (size_t)len)
+	{
+		tostringstream sanitized;
+		Transform::appendSanitized(sanitized, s);
+		s = sanitized.str();
+		len = s.size();
+	}
+
+	if(len < min)
 	{
 		if(leftAlign)
 		{	
@@ -70,6 +84,11 @@ void PatternConverter::format(tostream& sbuf, const spi::LoggingEvent& e)
 		sbuf << s;
 }	
 
+void PatternConverter::gather(GatherBuffer& output, const spi::LoggingEvent& e)
+{
+	format(output.getStream(), e);
+}
+
 tstring PatternConverter::SPACES[] = {" ", "  ", "    ", "        ", //1,2,4,8 spaces
 "                ", // 16 spaces
 "                                " }; // 32 spaces
@@ -18,6 +18,8 @@
 #include <log4cxx/helpers/patternparser.h>
 #include <log4cxx/helpers/patternconverter.h>
 #include <log4cxx/helpers/stringhelper.h>
+#include <log4cxx/helpers/optionconverter.h>
+#include <log4cxx/helpers/gatherbuffer.h>
 
 using namespace log4cxx;
 using namespace log4cxx::helpers;
@@ -35,14 +37,15 @@ tstring PatternLayout::TTCC_CONVERSION_PATTERN = _T("%r [%t] %p %c %x - %m%n");
 int PatternLayout::BUF_SIZE = 256;
 int PatternLayout::MAX_CAPACITY = 1024;
 
-PatternLayout::PatternLayout()
+PatternLayout::PatternLayout() : sanitize(false)
 {
 }
 
 /**
 Constructs a PatternLayout using the supplied conversion pattern.
 */
-PatternLayout::PatternLayout(const tstring& pattern) : pattern(pattern)
+PatternLayout::PatternLayout(const tstring& pattern)
+: pattern(pattern), sanitize(false)
 {
 	activateOptions();
 }
@@ -53,6 +56,19 @@ void PatternLayout::setConversionPattern(const tstring& conversionPattern)
 	activateOptions();
 }
 
+void PatternLayout::setSanitize(bool sanitize)
+{
+	this->sanitize = sanitize;
+
+	PatternConverterPtr c = head;
+	
+	while(c != 0)
+	{
+		c->sanitize = sanitize;
+		c = c->next;
+	}
+}
+
 void PatternLayout::format(tostream& output, const spi::LoggingEvent& event)
 {
 	PatternConverterPtr c = head;
@@ -64,6 +80,19 @@ void PatternLayout::format(tostream& output, const spi::LoggingEvent& event)
 	}
 }
 
+bool PatternLayout::gather(GatherBuffer& output, const spi::LoggingEvent& event)
+{
+	PatternConverterPtr c = head;
+	
+	while(c != 0)
+	{
+		c->gather(output, event);
+		c = c->next;
+	}
+
+	return true;
+}
+
 PatternConverterPtr PatternLayout::createPatternParser(const tstring& pattern)
 {
 	return PatternParser(pattern).parse();
@@ -75,6 +104,10 @@ void PatternLayout::setOption(const tstring& option, const tstring& value)
 	{
 		pattern = value;
 	}
+	else if (StringHelper::equalsIgnoreCase(option, _T("sanitize")))
+	{
+		sanitize = OptionConverter::toBoolean(value, false);
+	}
 }
 
 void PatternLayout::activateOptions()
@@ -85,6 +118,7 @@ void PatternLayout::activateOptions()
 	}
 
 	head = createPatternParser(pattern);
+	setSanitize(sanitize);
 }
 
 
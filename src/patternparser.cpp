@@ -20,6 +20,9 @@
 #include <log4cxx/helpers/iso8601dateformat.h>
 #include <log4cxx/helpers/datetimedateformat.h>
 #include <log4cxx/helpers/stringhelper.h>
+#include <log4cxx/helpers/gatherbuffer.h>
+#include <log4cxx/helpers/transform.h>
+#include <log4cxx/helpers/stacktrace.h>
 #include <log4cxx/spi/loggingevent.h>
 #include <log4cxx/helpers/loglog.h>
 #include <log4cxx/level.h>
@@ -310,6 +313,11 @@ void PatternParser::finalizeConverter(TCHAR c)
 		//formattingInfo.dump();
 		currentLiteral.str(_T(""));
 		break;
+	case _T('s'):
+		pc = new StackTracePatternConverter(formattingInfo,
+			extractPrecisionOption());
+		currentLiteral.str(_T(""));
+		break;
 	case _T('t'):
 		pc = new BasicPatternConverter(formattingInfo, THREAD_CONVERTER);
 		//LogLog.debug("THREAD converter.");
@@ -338,7 +346,7 @@ void PatternParser::finalizeConverter(TCHAR c)
 	case _T('X'):
 	{
 		tstring xOpt = extractOption();
-		pc = new MDCPatternConverter(formattingInfo, xOpt);
+		pc = new FieldPatternConverter(formattingInfo, xOpt);
 		currentLiteral.str(_T(""));
 		break;
 	}
@@ -393,12 +401,30 @@ void PatternParser::BasicPatternConverter::convert(tostream& sbuf, const spi::Lo
 	}
 }
 
+void PatternParser::BasicPatternConverter::gather(GatherBuffer& output, const spi::LoggingEvent& event)
+{
+	const tstring& message = event.getRenderedMessage();
+
+	// the message is referenced unless it has to be padded, truncated
+	// or sanitized
+	if (type == MESSAGE_CONVERTER && (int)message.size() >= min
+		&& (int)message.size() <= max && (!sanitize ||
+		Transform::scanSafe(message.data(), message.size()) == message.size()))
+	{
+		output.append(message);
+	}
+	else
+	{
+		PatternConverter::gather(output, event);
+	}
+}
+
 PatternParser::LiteralPatternConverter::LiteralPatternConverter(const tstring& value)
 : literal(value)
 {
 }
 
-void PatternParser::LiteralPatternConverter::format(tostringstream& sbuf, const spi::LoggingEvent& e) 
+void PatternParser::LiteralPatternConverter::format(tostream& sbuf, const spi::LoggingEvent&)
 {
 	sbuf << literal;
 }
@@ -420,19 +446,44 @@ PatternParser::DatePatternConverter::~DatePatternConverter()
 
 void PatternParser::DatePatternConverter::convert(tostream& sbuf, const spi::LoggingEvent& event)
 {
-	df->format(sbuf, event.getTimeStamp());
+	df->format(sbuf, event.getTimeStamp(), event.getMicroseconds());
 }
 
-PatternParser::MDCPatternConverter::MDCPatternConverter(const FormattingInfo& formattingInfo, const tstring& key)
+PatternParser::FieldPatternConverter::FieldPatternConverter(const FormattingInfo& formattingInfo, const tstring& key)
 : PatternConverter(formattingInfo), key(key)
 {
 }
 
-void PatternParser::MDCPatternConverter::convert(tostream& sbuf, const spi::LoggingEvent& event)
+void PatternParser::FieldPatternConverter::convert(tostream& sbuf, const spi::LoggingEvent& event)
+{
+	const Fields& fields = event.getFields();
+
+	if (key.empty())
+	{
+		fields.format(sbuf);
+		return;
+	}
+
+	const Field * field = fields.find(key);
+	if (field != 0)
+	{
+		field->format(sbuf);
+	}
+}
+
+PatternParser::StackTracePatternConverter::StackTracePatternConverter(const FormattingInfo& formattingInfo, int maxFrames)
+: PatternConverter(formattingInfo), maxFrames(maxFrames)
 {
-	sbuf << event.getNDC();
 }
 
+void PatternParser::StackTracePatternConverter::convert(tostream& sbuf, const spi::LoggingEvent& event)
+{
+	const StackTrace * stackTrace = event.getStackTrace();
+	if (stackTrace != 0)
+	{
+		stackTrace->format(sbuf, maxFrames);
+	}
+}
 
 PatternParser::LocationPatternConverter::LocationPatternConverter(const FormattingInfo& formattingInfo, int type)
 : PatternConverter(formattingInfo), type(type)
@@ -0,0 +1,139 @@
+/***************************************************************************
+                          performancecounters.cpp  -  class PerformanceCounters
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/helpers/performancecounters.h>
+
+#ifdef HAVE_LINUX_PERF_EVENT_H
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <string.h>
+#endif
+
+using namespace log4cxx::helpers;
+
+static const TCHAR * names[] =
+{
+	_T("cycles"), _T("instructions"), _T("branch-misses"), _T("cache-misses")
+};
+
+#ifdef HAVE_LINUX_PERF_EVENT_H
+static const unsigned long long configs[] =
+{
+	PERF_COUNT_HW_CPU_CYCLES,
+	PERF_COUNT_HW_INSTRUCTIONS,
+	PERF_COUNT_HW_BRANCH_MISSES,
+	PERF_COUNT_HW_CACHE_MISSES
+};
+#endif
+
+PerformanceCounters::PerformanceCounters()
+{
+	for (int i = 0; i < COUNTER_COUNT; i++)
+	{
+		fds[i] = -1;
+		values[i] = -1;
+
+#ifdef HAVE_LINUX_PERF_EVENT_H
+		struct perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = configs[i];
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED
+			| PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		// calling thread, any processor
+		fds[i] = (int)::syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+		if (fds[i] < 0)
+		{
+			fds[i] = -1;
+		}
+#endif
+	}
+}
+
+PerformanceCounters::~PerformanceCounters()
+{
+#ifdef HAVE_LINUX_PERF_EVENT_H
+	for (int i = 0; i < COUNTER_COUNT; i++)
+	{
+		if (fds[i] != -1)
+		{
+			::close(fds[i]);
+		}
+	}
+#endif
+}
+
+void PerformanceCounters::start()
+{
+#ifdef HAVE_LINUX_PERF_EVENT_H
+	for (int i = 0; i < COUNTER_COUNT; i++)
+	{
+		if (fds[i] != -1)
+		{
+			::ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+			::ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+		}
+	}
+#endif
+}
+
+void PerformanceCounters::stop()
+{
+#ifdef HAVE_LINUX_PERF_EVENT_H
+	for (int i = 0; i < COUNTER_COUNT; i++)
+	{
+		if (fds[i] != -1)
+		{
+			::ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+		}
+	}
+
+	for (int i = 0; i < COUNTER_COUNT; i++)
+	{
+		values[i] = -1;
+
+		// value, time enabled, time running
+		unsigned long long data[3];
+		if (fds[i] == -1
+			|| ::read(fds[i], data, sizeof(data)) != (ssize_t)sizeof(data)
+			|| data[2] == 0)
+		{
+			continue;
+		}
+
+		if (data[2] < data[1])
+		{
+			values[i] = (int64)((double)data[0] * data[1] / data[2]);
+		}
+		else
+		{
+			values[i] = (int64)data[0];
+		}
+	}
+#endif
+}
+
+const TCHAR * PerformanceCounters::getName(Counter counter)
+{
+	return names[counter];
+}
@@ -0,0 +1,53 @@
+/***************************************************************************
+                          reclaimer.cpp  -  class Reclaimer
+                             -------------------
+    begin                : mer mai 21 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/helpers/reclaimer.h>
+
+using namespace log4cxx;
+using namespace log4cxx::helpers;
+
+Reclaimer::Reclaimer() : readers(0), retiredCount(0)
+{
+}
+
+void Reclaimer::retire(Object * snapshot)
+{
+	cs.lock();
+	retired.push_back(snapshot);
+	retiredCount = (long)retired.size();
+	cs.unlock();
+
+	reclaim();
+}
+
+void Reclaimer::reclaim()
+{
+	std::vector< ObjectPtr<Object> > released;
+
+	// the snapshots were retired before this point: a reader which
+	// enters afterwards reads the published one, and the readers which
+	// may use them have left if there is none.
+	cs.lock();
+	if (readers == 0)
+	{
+		released.swap(retired);
+		retiredCount = 0;
+	}
+	cs.unlock();
+
+	// released without the lock: they may hold the last reference to an
+	// appender
+}
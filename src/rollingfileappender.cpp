@@ -24,32 +24,59 @@ using namespace log4cxx;
 using namespace log4cxx::helpers;
 
 RollingFileAppender::RollingFileAppender()
-: maxFileSize(10*1024*1024), maxBackupIndex(1)
+: maxFileSize(10*1024*1024), maxBackupIndex(1), archive(false),
+maxArchiveIndex(10)
 {
 }
 
 
 RollingFileAppender::RollingFileAppender(LayoutPtr layout, const tstring& fileName, bool append)
 : FileAppender(layout, fileName, append),
-maxFileSize(10*1024*1024), maxBackupIndex(1)
+maxFileSize(10*1024*1024), maxBackupIndex(1), archive(false),
+maxArchiveIndex(10)
 {
 }
 
 RollingFileAppender::RollingFileAppender(LayoutPtr layout, const tstring& 
 fileName) : FileAppender(layout, fileName),
-maxFileSize(10*1024*1024), maxBackupIndex(1)
+maxFileSize(10*1024*1024), maxBackupIndex(1), archive(false),
+maxArchiveIndex(10)
 {
 }
 
+void RollingFileAppender::activateOptions()
+{
+	FileAppender::activateOptions();
+
+	if (archive && os != 0)
+	{
+		openArchive(fileAppend);
+	}
+}
+
+void RollingFileAppender::closeWriter()
+{
+	archiveWriter.close();
+	FileAppender::closeWriter();
+}
+
+void RollingFileAppender::openArchive(bool append)
+{
+	if (!archiveWriter.open(fileName + _T(".lca"), append))
+	{
+		LogLog::error(_T("Unable to open archive: ") + fileName
+			+ _T(".lca"));
+	}
+}
+
 // synchronization not necessary since doAppend is alreasy synched
 void RollingFileAppender::rollOver()
 {
-	LOGLOG_DEBUG(_T("rolling over count=") << ofs.tellp());
+	LOGLOG_DEBUG(_T("rolling over count=") << getFileLength());
 	LOGLOG_DEBUG(_T("maxBackupIndex=") << maxBackupIndex);
 
 	// close and reset the current file
-	ofs.close();
-	ofs.clear();
+	closeWriter();
 
 	// If maxBackups <= 0, then there is no file renaming to be done.
 	if(maxBackupIndex > 0)
@@ -79,18 +106,54 @@ void RollingFileAppender::rollOver()
 		rename(T2A(fileName.c_str()), T2A(target.str().c_str()));
 	}
 
+	// The archives have their own number of backups
+	if(archive)
+	{
+		tstring archiveName = fileName + _T(".lca");
+
+		if(maxArchiveIndex > 0)
+		{
+			tostringstream file;
+			file << archiveName << _T(".") << maxArchiveIndex;
+			remove(T2A(file.str().c_str()));
+
+			for (int i = maxArchiveIndex - 1; i >= 1; i--)
+			{
+				tostringstream file;
+				tostringstream target;
+
+				file << archiveName << _T(".") << i;
+				target << archiveName << _T(".") << (i + 1);
+				rename(T2A(file.str().c_str()), T2A(target.str().c_str()));
+			}
+
+			tostringstream target;
+			target << archiveName << _T(".") << 1;
+
+			LogLog::debug(_T("Renaming file ") + archiveName + _T(" to ") + target.str());
+			rename(T2A(archiveName.c_str()), T2A(target.str().c_str()));
+		}
+	}
+
 	// Open the current file up again in truncation mode
-	ofs.open(T2A(fileName.c_str()), std::ios::out|std::ios::trunc);
-	if(!ofs.is_open())
+	if(!openFile(false))
 	{
 		LogLog::error(_T("Unable to open file: ") + fileName);
 	}
+	else if(archive)
+	{
+		openArchive(false);
+	}
 }
 
 void RollingFileAppender::subAppend(const spi::LoggingEvent& event)
 {
 	FileAppender::subAppend(event);
-	if(!fileName.empty() && ofs.tellp() >= maxFileSize)
+	if(archiveWriter.isOpen())
+	{
+		archiveWriter.write(event);
+	}
+	if(!fileName.empty() && getFileLength() >= maxFileSize)
 	{
 		rollOver();
 	}
@@ -109,6 +172,14 @@ void RollingFileAppender::setOption(const std::string& option,
 	{
 		maxBackupIndex = ttol(value.c_str());
 	}
+	else if (StringHelper::equalsIgnoreCase(option, _T("archive")))
+	{
+		archive = OptionConverter::toBoolean(value, false);
+	}
+	else if (StringHelper::equalsIgnoreCase(option, _T("maxarchiveindex")))
+	{
+		maxArchiveIndex = ttol(value.c_str());
+	}
 	else
 	{
 		FileAppender::setOption(option, value);
@@ -44,6 +44,7 @@ void RootCategory::setLevel(const Level& level)
 	{
 
 		this->level = &level;
+		invalidateDispatchState();
 	}
 }
 
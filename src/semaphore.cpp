@@ -18,6 +18,8 @@
 
 #ifdef HAVE_PTHREAD_H
 #include <semaphore.h>
+#include <time.h>
+#include <errno.h>
 #elif defined(WIN32)
 #include <windows.h>
 #include <limits.h>
@@ -65,6 +67,51 @@ void Semaphore::wait()
 #endif
 }
 
+#if defined(HAVE_PTHREAD_H) || defined(WIN32)
+bool Semaphore::wait(long timeout)
+#else
+bool Semaphore::wait(long)
+#endif
+{
+#ifdef HAVE_PTHREAD_H
+	// sem_timedwait takes an absolute time of the real-time clock
+	timespec deadline;
+	::clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += timeout / 1000;
+	deadline.tv_nsec += (timeout % 1000) * 1000000;
+	if (deadline.tv_nsec >= 1000000000)
+	{
+		deadline.tv_sec++;
+		deadline.tv_nsec -= 1000000000;
+	}
+
+	while (::sem_timedwait(&semaphore, &deadline) != 0)
+	{
+		if (errno == ETIMEDOUT)
+		{
+			return false;
+		}
+		else if (errno != EINTR)
+		{
+			throw SemaphoreException();
+		}
+	}
+	return true;
+#elif defined(WIN32)
+	switch(::WaitForSingleObject(semaphore, (DWORD)timeout))
+	{
+	case WAIT_OBJECT_0:
+		return true;
+	case WAIT_TIMEOUT:
+		return false;
+	default:
+		throw SemaphoreException();
+	}
+#else
+	return true;
+#endif
+}
+
 bool Semaphore::tryWait()
 {
 #ifdef HAVE_PTHREAD_H
@@ -18,10 +18,13 @@
 #include <log4cxx/helpers/serversocket.h>
 #include <log4cxx/helpers/socket.h>
 #include <log4cxx/net/socketnode.h>
+#include <log4cxx/net/socketrelaynode.h>
 #include <log4cxx/xml/domconfigurator.h>
 #include <log4cxx/helpers/thread.h>
 #include <log4cxx/logmanager.h>
 #include <log4cxx/level.h>
+#include <log4cxx/consoleappender.h>
+#include <log4cxx/simplelayout.h>
 
 #ifdef WIN32
 #include <windows.h>
@@ -34,10 +37,14 @@ using namespace log4cxx::helpers;
 
 int port = 0;
 
+/** In relay mode, the events are forwarded undecoded to this relay. */
+SocketRelayPtr relay;
+
 void usage(const tstring& msg)
 {
 	tcout << msg << std::endl;
 	tcout << _T("Usage: simpleocketServer port configFile") << std::endl;
+	tcout << _T("       simpleocketServer port relayHost relayPort") << std::endl;
 }
 
 void init(const tstring& portStr, const tstring& configFile)
@@ -56,9 +63,30 @@ void init(const tstring& portStr, const tstring& configFile)
 #endif
 }
 
+void initRelay(const tstring& portStr, const tstring& relayHost,
+	const tstring& relayPortStr)
+{
+	USES_CONVERSION;
+	port = strtol(T2A(portStr.c_str()), 0, 10);
+	int relayPort = strtol(T2A(relayPortStr.c_str()), 0, 10);
+
+	// the messages of the server itself go to the console
+	Logger::getRootLogger()->addAppender(
+		new ConsoleAppender(new SimpleLayout()));
+
+	relay = new SocketRelay();
+	relay->addRoute(_T(""), Level::ALL,
+		new SocketRelay::SocketTarget(relayHost, relayPort));
+}
+
 int main(int argc, char * argv[])
 {
-	if(argc == 3)
+	if(argc == 4)
+	{
+		USES_CONVERSION;
+		initRelay(A2T(argv[1]), A2T(argv[2]), A2T(argv[3]));
+	}
+	else if(argc == 3)
 	{
 		USES_CONVERSION;
 		init(A2T(argv[1]), A2T(argv[2]));
@@ -87,8 +115,16 @@ int main(int argc, char * argv[])
 				<< socket->getInetAddress().toString());
 			LOG4CXX_INFO(logger, _T("Starting new socket node."));
 			
-			Thread * thread = new Thread(new SocketNode(socket,
-				LogManager::getLoggerRepository()));
+			Thread * thread;
+			if(relay != 0)
+			{
+				thread = new Thread(new SocketRelayNode(socket, relay));
+			}
+			else
+			{
+				thread = new Thread(new SocketNode(socket,
+					LogManager::getLoggerRepository()));
+			}
 			thread->start();
 		}
 	}
@@ -86,7 +86,7 @@ void SocketAppender::setOption(const std::string& option,
 	}
 	else
 	{
-		AppenderSkeleton::setOption(name, value);
+		AppenderSkeleton::setOption(option, value);
 	}
 }
 
@@ -21,6 +21,9 @@
 #include <log4cxx/helpers/optionconverter.h>
 #include <log4cxx/helpers/stringhelper.h>
 #include <log4cxx/helpers/serversocket.h>
+#include <log4cxx/helpers/interlocked.h>
+#include <log4cxx/spi/loggingevent.h>
+#include <log4cxx/level.h>
 
 using namespace log4cxx;
 using namespace log4cxx::helpers;
@@ -28,20 +31,137 @@ using namespace log4cxx::net;
 using namespace log4cxx::spi;
 
 int SocketHubAppender::DEFAULT_PORT = 4560;
+int SocketHubAppender::MAX_SUBSCRIPTIONS = 1024;
+
+/** Longest logger name accepted in a subscription, as in
+SocketInputStream. */
+#define MAX_NAME_LENGTH 1024
+
+SocketHubAppender::Subscription::Subscription(const tstring& loggerName,
+	const Level& level)
+: loggerName(loggerName), level(level.toInt())
+{
+}
+
+SocketHubAppender::Subscription::Subscription(const tstring& loggerName,
+	int level)
+: loggerName(loggerName), level(level)
+{
+}
+
+void SocketHubAppender::subscribe(helpers::SocketPtr socket,
+	const SubscriptionList& subscriptions)
+{
+	SocketOutputStreamPtr os = new SocketOutputStream(socket);
+
+	os->write((int)subscriptions.size());
+
+	SubscriptionList::const_iterator it;
+	for (it = subscriptions.begin(); it != subscriptions.end(); it++)
+	{
+		os->write(it->loggerName);
+		os->write(it->level);
+	}
+
+	os->flush();
+}
+
+SocketHubAppender::Client::Client(helpers::SocketPtr socket,
+	const GenerationPtr& generation)
+: socket(socket), generation(generation), subscribed(false)
+{
+}
+
+void SocketHubAppender::Client::run()
+{
+	// the subscriptions are read with Socket::read rather than with a
+	// SocketInputStream, which reads ahead and would wait for data the
+	// client never sends.
+	try
+	{
+		while (true)
+		{
+			int count;
+			if (socket->read(&count, sizeof(count)) != sizeof(count))
+			{
+				break;
+			}
+
+			if (count < 0 || count > MAX_SUBSCRIPTIONS)
+			{
+				throw SocketException();
+			}
+
+			SubscriptionList list;
+			for (int i = 0; i < count; i++)
+			{
+				tstring::size_type size;
+				if (socket->read(&size, sizeof(size)) != sizeof(size)
+					|| size > MAX_NAME_LENGTH)
+				{
+					throw SocketException();
+				}
+
+				TCHAR * buffer = (TCHAR *)alloca((size + 1) * sizeof(TCHAR));
+				buffer[size] = _T('\0');
+				if (size > 0 &&
+					socket->read(buffer, size * sizeof(TCHAR)) != size * sizeof(TCHAR))
+				{
+					throw SocketException();
+				}
+
+				int level;
+				if (socket->read(&level, sizeof(level)) != sizeof(level))
+				{
+					throw SocketException();
+				}
+
+				list.push_back(Subscription(buffer, level));
+			}
+
+			{
+				synchronized sync(this);
+				subscriptions = list;
+				subscribed = true;
+			}
+
+			Interlocked::increment(&generation->value);
+			LOGLOG_DEBUG(_T("client subscribed to ") << count << _T(" loggers"));
+		}
+	}
+	catch (SocketException& e)
+	{
+		LOGLOG_DEBUG(_T("client connection closed"));
+	}
+}
+
+SocketHubAppender::TrieNode::~TrieNode()
+{
+	std::map<tstring, TrieNode *>::iterator it;
+	for (it = children.begin(); it != children.end(); it++)
+	{
+		delete it->second;
+	}
+}
 
 SocketHubAppender::~SocketHubAppender()
 {
 	finalize();
+	delete trie;
 }
 
 SocketHubAppender::SocketHubAppender()
- : port(DEFAULT_PORT), locationInfo(false)
+ : port(DEFAULT_PORT), locationInfo(false), trie(0), trieGeneration(-1),
+generation(new Generation())
 {
+	eventBuffer = new SocketOutputStream(0);
 }
 
 SocketHubAppender::SocketHubAppender(int port)
- : port(port), locationInfo(false)
+ : port(port), locationInfo(false), trie(0), trieGeneration(-1),
+generation(new Generation())
 {
+	eventBuffer = new SocketOutputStream(0);
 	startServer();
 }
 
@@ -63,22 +183,27 @@ void SocketHubAppender::setOption(const std::string& option,
 	}
 	else
 	{
-		AppenderSkeleton::setOption(name, value);
+		AppenderSkeleton::setOption(option, value);
 	}
 }
 
 
 void SocketHubAppender::close()
 {
-	synchronized sync(this);
-
-	if(closed)
 	{
-		return;
+		synchronized sync(this);
+
+		if(closed)
+		{
+			return;
+		}
+
+		LOGLOG_DEBUG(_T("closing SocketHubAppender ") << getName());
+		closed = true;
 	}
-	
-	LOGLOG_DEBUG(_T("closing SocketHubAppender ") << getName());
-	closed = true;
+
+	// the lock is not held while the monitor stops: it may be adding a
+	// client.
 	cleanUp();
 	LOGLOG_DEBUG(_T("SocketHubAppender ") << getName() << _T(" closed"));
 }
@@ -87,81 +212,262 @@ void SocketHubAppender::cleanUp()
 {
 	// stop the monitor thread
 	LOGLOG_DEBUG(_T("stopping ServerSocket"));
-	serverMonitor->stopMonitor();
-	serverMonitor = 0;
-	
+	if (serverMonitor != 0)
+	{
+		serverMonitor->stopMonitor();
+		serverMonitor = 0;
+	}
+
+	synchronized sync(this);
+
 	// close all of the connections
 	LOGLOG_DEBUG(_T("closing client connections"));
-	while (!oosList.empty())
+	std::vector<ClientPtr>::iterator it;
+	for (it = clients.begin(); it != clients.end(); it++)
 	{
-		SocketOutputStreamPtr oos = oosList.at(0);
-		if(oos != 0)
+		try
 		{
-			try
-			{
-				oos->close();
-			}
-			catch(SocketException& e)
-			{
-				LogLog::error(_T("could not close oos: "), e);
-			}
-			
-			oosList.erase(oosList.begin());     
+			(*it)->socket->close();
+		}
+		catch(SocketException& e)
+		{
+			LogLog::error(_T("could not close client connection: "), e);
 		}
 	}
+
+	clients.clear();
+	Interlocked::increment(&generation->value);
 }
 
 void SocketHubAppender::append(const spi::LoggingEvent& event)
 {
-
 	// if no open connections, exit now
-	if(oosList.empty())
+	if(clients.empty())
 	{
 		return;
 	}
-	
+
 /*	// set up location info if requested
 	if (locationInfo)
 	{
 		event.getLocationInformation();	
 	} */
-	
-	// loop through the current set of open connections, appending the event to each
-	std::vector<SocketOutputStreamPtr>::iterator it, itEnd = oosList.end();
-	while(it != itEnd)
-	{ 	
-		SocketOutputStreamPtr oos = *it;
-		
-		// list size changed unexpectedly? Just exit the append.
-		if (oos == 0)
+
+	if (trieGeneration != generation->value)
+	{
+		update();
+	}
+
+	const ClientSet& clientSet = getClientSet(event.getLoggerName());
+	int level = event.getLevel().toInt();
+	bool serialized = false;
+	std::vector<Client *> failed;
+
+	ClientSet::const_iterator it;
+	for (it = clientSet.begin(); it != clientSet.end(); it++)
+	{
+		if (level < it->second)
 		{
-			break;
+			continue;
 		}
-		
-		try 
+
+		// the event is serialized once for all the clients
+		if (!serialized)
+		{
+			eventBuffer->reset();
+			event.write(eventBuffer);
+			serialized = true;
+		}
+
+		try
 		{
-			event.write(oos);
-			oos->flush();
-			it++;
+			eventBuffer->writeTo(it->first->socket);
 		}
 		catch(SocketException& e)
 		{
-			// there was an io exception so just drop the connection
-			it = oosList.erase(it);
-			LOGLOG_DEBUG(_T("dropped connection"));
+			failed.push_back(it->first);
+		}
+	}
+
+	if (failed.empty())
+	{
+		return;
+	}
+
+	// there was an io exception so just drop the connections
+	std::vector<Client *>::iterator itFailed;
+	for (itFailed = failed.begin(); itFailed != failed.end(); itFailed++)
+	{
+		std::vector<ClientPtr>::iterator itClient;
+		for (itClient = clients.begin(); itClient != clients.end(); itClient++)
+		{
+			if ((*itClient).operator->() == *itFailed)
+			{
+				try
+				{
+					(*itClient)->socket->close();
+				}
+				catch(SocketException& e)
+				{
+				}
+
+				clients.erase(itClient);
+				LOGLOG_DEBUG(_T("dropped connection"));
+				break;
+			}
+		}
+	}
+
+	Interlocked::increment(&generation->value);
+}
+
+void SocketHubAppender::update()
+{
+	// read first: a change made while the trie is built will cause
+	// another update.
+	trieGeneration = generation->value;
+
+	delete trie;
+	trie = new TrieNode();
+	clientSets.clear();
+
+	std::vector<ClientPtr>::iterator it;
+	for (it = clients.begin(); it != clients.end(); it++)
+	{
+		Client * client = *it;
+		synchronized sync(client);
+
+		if (!client->subscribed)
+		{
+			merge(trie->clients, client, Level::ALL_INT);
+			continue;
+		}
+
+		SubscriptionList::iterator itSub;
+		for (itSub = client->subscriptions.begin();
+			itSub != client->subscriptions.end(); itSub++)
+		{
+			TrieNode * node = trie;
+			const tstring& name = itSub->loggerName;
+
+			tstring::size_type begin = 0;
+			while (begin < name.length())
+			{
+				tstring::size_type end = name.find(_T('.'), begin);
+				if (end == tstring::npos)
+				{
+					end = name.length();
+				}
+
+				TrieNode *& child = node->children[name.substr(begin, end - begin)];
+				if (child == 0)
+				{
+					child = new TrieNode();
+				}
+
+				node = child;
+				begin = end + 1;
+			}
+
+			merge(node->clients, client, itSub->level);
 		}
 	}
 }
 
+const SocketHubAppender::ClientSet& SocketHubAppender::getClientSet(
+	const tstring& loggerName)
+{
+	std::map<tstring, ClientSet>::iterator it = clientSets.find(loggerName);
+	if (it != clientSets.end())
+	{
+		return it->second;
+	}
+
+	ClientSet& clientSet = clientSets[loggerName];
+
+	// the subscriptions of the logger and of its ancestors
+	TrieNode * node = trie;
+	tstring::size_type begin = 0;
+	while (node != 0)
+	{
+		ClientSet::iterator itClient;
+		for (itClient = node->clients.begin();
+			itClient != node->clients.end(); itClient++)
+		{
+			merge(clientSet, itClient->first, itClient->second);
+		}
+
+		if (begin >= loggerName.length())
+		{
+			break;
+		}
+
+		tstring::size_type end = loggerName.find(_T('.'), begin);
+		if (end == tstring::npos)
+		{
+			end = loggerName.length();
+		}
+
+		std::map<tstring, TrieNode *>::iterator child =
+			node->children.find(loggerName.substr(begin, end - begin));
+		node = (child != node->children.end()) ? child->second : 0;
+		begin = end + 1;
+	}
+
+	return clientSet;
+}
+
+void SocketHubAppender::merge(ClientSet& set, Client * client, int level)
+{
+	ClientSet::iterator it;
+	for (it = set.begin(); it != set.end(); it++)
+	{
+		if (it->first == client)
+		{
+			if (level < it->second)
+			{
+				it->second = level;
+			}
+			return;
+		}
+	}
+
+	set.push_back(std::pair<Client *, int>(client, level));
+}
+
+void SocketHubAppender::addClient(helpers::SocketPtr socket)
+{
+	ClientPtr client = new Client(socket, generation);
+
+	{
+		synchronized sync(this);
+
+		if (closed)
+		{
+			socket->close();
+			return;
+		}
+
+		clients.push_back(client);
+	}
+
+	Interlocked::increment(&generation->value);
+
+	// reads the subscriptions of the client until it disconnects
+	Thread * thread = new Thread((Client *)client);
+	thread->start();
+}
+
 void SocketHubAppender::startServer()
 {
-	serverMonitor = new ServerMonitor(port, oosList);
+	serverMonitor = new ServerMonitor(port, this);
 }
 
-SocketHubAppender::ServerMonitor::ServerMonitor(int port, const std::vector<helpers::SocketOutputStreamPtr>& oosList)
-: port(port), oosList(oosList), keepRunning(true)
+SocketHubAppender::ServerMonitor::ServerMonitor(int port,
+	SocketHubAppender * hub)
+: port(port), hub(hub), keepRunning(true)
 {
-	monitorThread = new Thread(this);
+	Thread * monitorThread = new Thread(this);
 	monitorThread->start();
 }
 
@@ -173,17 +479,10 @@ void SocketHubAppender::ServerMonitor::stopMonitor()
 	{	
 		LogLog::debug(_T("server monitor thread shutting down"));
 		keepRunning = false;
-		try
-		{	
-			monitorThread->join();
-		}
-		catch (InterruptedException e)
-		{
-			// do nothing?
-		}
-		
-		// release the thread
-		monitorThread = 0;
+
+		// the thread object deletes itself when it ends: it cannot be
+		// joined.
+		ended.wait();
 		LogLog::debug(_T("server monitor thread shut down"));
 	}
 }
@@ -201,19 +500,10 @@ void SocketHubAppender::ServerMonitor::run()
 	{
 		LogLog::error(_T("exception setting timeout, shutting down server socket."), e);
 		keepRunning = false;
+		ended.post();
 		return;
 	}
-	
-	try
-	{
-		serverSocket->setSoTimeout(1000);
-	}
-	catch (SocketException& e)
-	{
-		LogLog::error(_T("exception setting timeout, shutting down server socket."), e);
-		return;
-	}
-	
+
 	while (keepRunning)
 	{
 		SocketPtr socket;
@@ -238,25 +528,14 @@ void SocketHubAppender::ServerMonitor::run()
 		// if there was a socket accepted
 		if (socket != 0)
 		{
-			try
-			{
-				InetAddress remoteAddress = socket->getInetAddress();
-				LOGLOG_DEBUG(_T("accepting connection from ") << remoteAddress.getHostName() 
-					<< _T(" (") + remoteAddress.getHostAddress() + _T(")"));
-				
-				// create an ObjectOutputStream
-				SocketOutputStreamPtr oos = socket->getOutputStream();
-				
-				// add it to the oosList.  OK since Vector is synchronized.
-				oosList.push_back(oos);
-			}
-			catch (IOException& e)
-			{
-				LogLog::error(_T("exception creating output stream on socket."), e);
-			}
+			InetAddress remoteAddress = socket->getInetAddress();
+			LOGLOG_DEBUG(_T("accepting connection from ") << remoteAddress.getHostName() 
+				<< _T(" (") + remoteAddress.getHostAddress() + _T(")"));
+
+			hub->addClient(socket);
 		}
 	}
 
 	delete serverSocket;
+	ended.post();
 }
-
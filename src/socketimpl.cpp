@@ -29,6 +29,7 @@ using namespace log4cxx::helpers;
 #include <netdb.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <errno.h>
 #endif
 
 #include <string.h>
@@ -189,6 +190,10 @@ void SocketImpl::close()
 	if (fd != 0)
 	{
 		LOGLOG_DEBUG(_T("closing socket"));
+
+		// wakes up a thread blocked reading or writing this socket
+		::shutdown(fd, 2);
+
 #ifdef WIN32
 		if (::closesocket(fd) == -1)
 #else
@@ -301,6 +306,10 @@ size_t SocketImpl::write(const void * buf, size_t len)
 	{
 #ifdef WIN32
 		len_written = ::send(fd, (const char *)p, len - (p - (const unsigned char *)buf), 0);
+#elif defined(MSG_NOSIGNAL)
+		// a connection reset by the peer must not raise SIGPIPE
+		len_written = ::send(fd, p, len - (p - (const unsigned char *)buf),
+			MSG_NOSIGNAL);
 #else
 		len_written = ::write(fd, p, len - (p - (const unsigned char *)buf));
 #endif
@@ -318,6 +327,70 @@ size_t SocketImpl::write(const void * buf, size_t len)
 	return (p - (const unsigned char *)buf);
 }
 
+size_t SocketImpl::readSome(void * buf, size_t len)
+{
+	int len_read;
+
+	if (timeout > 0)
+	{
+		// convert timeout in milliseconds to struct timeval
+		timeval tv;
+		tv.tv_sec = timeout / 1000;
+		tv.tv_usec = (timeout % 1000) * 1000;
+
+		fd_set rfds;
+		FD_ZERO(&rfds);
+		FD_SET(this->fd, &rfds);
+
+		int retval = ::select(this->fd+1, &rfds, NULL, NULL, &tv);
+		if (retval == 0)
+		{
+			throw InterruptedIOException();
+		}
+	}
+
+	do
+	{
+#ifdef WIN32
+		len_read = ::recv(fd, (char *)buf, len, 0);
+#else
+		len_read = ::read(fd, buf, len);
+#endif
+	}
+#ifdef WIN32
+	while (false);
+#else
+	while (len_read < 0 && errno == EINTR);
+#endif
+
+	if (len_read < 0)
+	{
+		throw SocketException();
+	}
+
+	return len_read;
+}
+
+size_t SocketImpl::write(const ByteRange * ranges, int count)
+{
+#ifdef WIN32
+	// a winsock socket is not a file descriptor
+	size_t total = 0;
+	for (int i = 0; i < count; i++)
+	{
+		total += write(ranges[i].data, ranges[i].length);
+	}
+	return total;
+#else
+	long total = ByteRange::write(fd, ranges, count);
+	if (total < 0)
+	{
+		throw SocketException();
+	}
+	return total;
+#endif
+}
+
 /** Retrive setting for SO_TIMEOUT.
 */
 int SocketImpl::getSoTimeout()
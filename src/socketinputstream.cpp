@@ -17,11 +17,16 @@
 #include <log4cxx/helpers/socketinputstream.h>
 #include <log4cxx/helpers/socket.h>
 #include <log4cxx/helpers/loglog.h>
+#include <vector>
 
 using namespace log4cxx;
 using namespace log4cxx::helpers ;
 
 size_t SocketInputStream::DEFAULT_BUFFER_SIZE = 32;
+size_t SocketInputStream::MAX_STRING_LENGTH = 1024 * 1024;
+
+/** size from which a temporary buffer is allocated on the heap */
+#define MAX_STACK_BUFFER_SIZE (64 * 1024)
 
 SocketInputStream::SocketInputStream(SocketPtr socket)
 : socket(socket), bufferSize(DEFAULT_BUFFER_SIZE),
@@ -61,10 +66,21 @@ void SocketInputStream::read(void * buf, int len)
 //		LOGLOG_DEBUG(_T("tmpBuffer=alloca(")
 //			<< len - maxPos + currentPos + bufferSize << _T(")"));
 			
-		unsigned char * tmpBuffer
- 			= (unsigned char *) alloca(len - maxPos + currentPos + bufferSize);
+		// the large strings are not read on the stack
+		size_t tmpSize = len - maxPos + currentPos + bufferSize;
+		std::vector<unsigned char> heapBuffer;
+		unsigned char * tmpBuffer;
+		if (tmpSize > MAX_STACK_BUFFER_SIZE)
+		{
+			heapBuffer.resize(tmpSize);
+			tmpBuffer = &heapBuffer[0];
+		}
+		else
+		{
+			tmpBuffer = (unsigned char *) alloca(tmpSize);
+		}
 
-		size_t read = socket->read(tmpBuffer, len - maxPos + currentPos + bufferSize);
+		size_t read = socket->read(tmpBuffer, tmpSize);
 
 		if (read == 0)
 		{
@@ -144,16 +160,17 @@ void SocketInputStream::read(tstring& value)
 
 	if (size > 0)
 	{
-		if (size > 1024)
+		if (size > MAX_STRING_LENGTH)
 		{
 			throw SocketException();
 		}
 		
-		TCHAR * buffer;
-		buffer = (TCHAR *)alloca((size + 1)* sizeof(TCHAR));
-		buffer[size] = _T('\0');
-		read(buffer, size * sizeof(TCHAR));
-		value = buffer;
+		value.resize(size);
+		read(&value[0], size * sizeof(TCHAR));
+	}
+	else
+	{
+		value.erase();
 	}
 	
 //	LOGLOG_DEBUG(_T("string read:") << value);
@@ -17,12 +17,15 @@
 #include <log4cxx/helpers/socketoutputstream.h>
 #include <log4cxx/helpers/socket.h>
 #include <log4cxx/helpers/loglog.h>
+#include <log4cxx/helpers/stringhelper.h>
 
 using namespace log4cxx;
 using namespace log4cxx::helpers;
 
 #define INCREMENT 512
 
+size_t SocketOutputStream::MAX_STRING_LENGTH = 1024 * 1024;
+
 SocketOutputStream::SocketOutputStream(SocketPtr socket)
 : socket(socket), beg(0), cur(0), end(0)
 {
@@ -88,16 +91,30 @@ void SocketOutputStream::write(const tstring& value)
 {
 	tstring::size_type size;
 
+	if (value.size() > MAX_STRING_LENGTH)
+	{
+		// the truncated string is temporary: it is copied
+		tstring truncated;
+		StringHelper::truncate(value, MAX_STRING_LENGTH, truncated);
+		size = truncated.size();
+		write(&size, sizeof(tstring::size_type));
+		write(truncated.c_str(), size * sizeof(TCHAR));
+		return;
+	}
+
 	size = value.size();
 	write(&size, sizeof(tstring::size_type));
 	if (size > 0)
 	{
-		if (size > 1024)
+		if (size * sizeof(TCHAR) >= ByteRange::MIN_GATHER_LENGTH)
 		{
-			size = 1024;
+			references.push_back(std::pair<size_t, ByteRange>(cur - beg,
+				ByteRange(value.c_str(), size * sizeof(TCHAR))));
+		}
+		else
+		{
+			write(value.c_str(), size * sizeof(TCHAR));
 		}
-		
-		write(value.c_str(), size * sizeof(TCHAR));
 	}
 }
 
@@ -105,15 +122,71 @@ void SocketOutputStream::close()
 {
 	// seek to begin
 	cur = beg;
+	references.clear();
 
 	// dereference socket
 	socket = 0;
 }
 
+void SocketOutputStream::getRanges(std::vector<ByteRange>& ranges)
+{
+	size_t position = 0;
+	std::vector< std::pair<size_t, ByteRange> >::iterator it;
+	for (it = references.begin(); it != references.end(); it++)
+	{
+		if (it->first > position)
+		{
+			ranges.push_back(ByteRange(beg + position, it->first - position));
+			position = it->first;
+		}
+
+		ranges.push_back(it->second);
+	}
+
+	if ((size_t)(cur - beg) > position)
+	{
+		ranges.push_back(ByteRange(beg + position, (cur - beg) - position));
+	}
+}
+
+void SocketOutputStream::writeTo(SocketPtr socket)
+{
+	if (references.empty())
+	{
+		socket->write(beg, cur - beg);
+	}
+	else
+	{
+		std::vector<ByteRange> ranges;
+		getRanges(ranges);
+		socket->write(&ranges[0], (int)ranges.size());
+	}
+}
+
+void SocketOutputStream::reset()
+{
+	cur = beg;
+	references.clear();
+}
+
 void SocketOutputStream::flush()
 {
-	// write to socket
-	socket->write(beg, cur - beg);
+	if (references.empty())
+	{
+		// write to socket
+		socket->write(beg, cur - beg);
+	}
+	else
+	{
+		std::vector<ByteRange> ranges;
+		getRanges(ranges);
+
+		// the references must not outlive the flush, even if the write
+		// fails
+		references.clear();
+		cur = beg;
+		socket->write(&ranges[0], (int)ranges.size());
+	}
 
 	// seek to begin
 	cur = beg;
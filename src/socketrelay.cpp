@@ -0,0 +1,393 @@
+/***************************************************************************
+                          socketrelay.cpp  -  class SocketRelay
+                             -------------------
+    begin                : sam mai 24 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/net/socketrelay.h>
+#include <log4cxx/level.h>
+#include <log4cxx/helpers/loglog.h>
+#include <log4cxx/helpers/interlocked.h>
+#include <log4cxx/helpers/clock.h>
+#include <log4cxx/helpers/socketinputstream.h>
+#include <log4cxx/fields.h>
+#include <time.h>
+#include <fcntl.h>
+#include <string.h>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace log4cxx;
+using namespace log4cxx::net;
+using namespace log4cxx::helpers;
+
+/** Returns the current time, in milliseconds. */
+static long currentTimeMillis()
+{
+	return (long)(Clock::monotonicMicros() / 1000);
+}
+
+/** Skips <code>size</code> bytes. Returns false if the frame is not
+complete. */
+static inline bool skip(const unsigned char *& p, const unsigned char * end,
+	size_t size)
+{
+	if ((size_t)(end - p) < size)
+	{
+		return false;
+	}
+
+	p += size;
+	return true;
+}
+
+/** Skips a string written by SocketOutputStream, and returns the
+position and the number of characters of the string. */
+static inline bool skipString(const unsigned char *& p,
+	const unsigned char * end, const unsigned char *& chars, size_t& length)
+{
+	tstring::size_type size;
+	if ((size_t)(end - p) < sizeof(size))
+	{
+		return false;
+	}
+
+	memcpy(&size, p, sizeof(size));
+	// the strings are accepted as by SocketInputStream
+	if (size > SocketInputStream::MAX_STRING_LENGTH)
+	{
+		throw SocketException();
+	}
+
+	chars = p + sizeof(size);
+	length = size;
+	return skip(p, end, sizeof(size) + size * sizeof(TCHAR));
+}
+
+/** Skips the typed fields written by LoggingEvent::write. */
+static inline bool skipFields(const unsigned char *& p,
+	const unsigned char * end)
+{
+	int count;
+	if ((size_t)(end - p) < sizeof(count))
+	{
+		return false;
+	}
+
+	memcpy(&count, p, sizeof(count));
+	p += sizeof(count);
+	if (count < 0 || count > Fields::MAX_FIELDS)
+	{
+		throw SocketException();
+	}
+
+	const unsigned char * chars;
+	size_t length;
+	for (int i = 0; i < count; i++)
+	{
+		int type;
+		if (!skipString(p, end, chars, length) ||
+			(size_t)(end - p) < sizeof(type))
+		{
+			return false;
+		}
+
+		memcpy(&type, p, sizeof(type));
+		p += sizeof(type);
+
+		bool complete;
+		switch (type)
+		{
+		case Field::INT64:
+			complete = skip(p, end, sizeof(int64));
+			break;
+		case Field::DOUBLE:
+			complete = skip(p, end, sizeof(double));
+			break;
+		case Field::STRING:
+			complete = skipString(p, end, chars, length);
+			break;
+		case Field::BOOL:
+			complete = skip(p, end, sizeof(int));
+			break;
+		default:
+			throw SocketException();
+		}
+
+		if (!complete)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+SocketRelay::SocketTarget::SocketTarget(const tstring& host, int port,
+	int reconnectionDelay)
+: host(host), port(port), reconnectionDelay(reconnectionDelay),
+nextConnection(currentTimeMillis())
+{
+	connect();
+}
+
+void SocketRelay::SocketTarget::connect()
+{
+	nextConnection = currentTimeMillis() + reconnectionDelay;
+
+	try
+	{
+		socket = new Socket(host, port);
+	}
+	catch(SocketException& e)
+	{
+		LogLog::error(_T("Could not connect to ") + toString() + _T("."), e);
+	}
+}
+
+void SocketRelay::SocketTarget::write(const ByteRange * ranges, int count)
+{
+	if (socket == 0)
+	{
+		if ((long)((unsigned long)currentTimeMillis() -
+			(unsigned long)nextConnection) < 0)
+		{
+			return;
+		}
+
+		connect();
+		if (socket == 0)
+		{
+			return;
+		}
+	}
+
+	try
+	{
+		socket->write(ranges, count);
+	}
+	catch(SocketException&)
+	{
+		socket->close();
+		socket = 0;
+		throw;
+	}
+}
+
+tstring SocketRelay::SocketTarget::toString() const
+{
+	tostringstream s;
+	s << _T("log server ") << host << _T(":") << port;
+	return s.str();
+}
+
+SocketRelay::FileTarget::FileTarget(const tstring& fileName)
+: fileName(fileName)
+{
+	USES_CONVERSION;
+#ifdef WIN32
+	fd = ::_open(T2A(fileName.c_str()),
+		_O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, 0666);
+#else
+	fd = ::open(T2A(fileName.c_str()), O_WRONLY | O_CREAT | O_APPEND, 0666);
+#endif
+
+	if (fd < 0)
+	{
+		LogLog::error(_T("Could not open ") + toString() + _T("."));
+		throw IOException();
+	}
+}
+
+SocketRelay::FileTarget::~FileTarget()
+{
+#ifdef WIN32
+	::_close(fd);
+#else
+	::close(fd);
+#endif
+}
+
+void SocketRelay::FileTarget::write(const ByteRange * ranges, int count)
+{
+	if (ByteRange::write(fd, ranges, count) < 0)
+	{
+		throw IOException();
+	}
+}
+
+tstring SocketRelay::FileTarget::toString() const
+{
+	return _T("file ") + fileName;
+}
+
+SocketRelay::SocketRelay() : eventCount(0)
+{
+}
+
+void SocketRelay::addRoute(const tstring& loggerName, const Level& threshold,
+	TargetPtr target)
+{
+	Route route;
+	route.loggerName = (loggerName == _T("root")) ? tstring() : loggerName;
+	route.threshold = threshold.toInt();
+	route.target = -1;
+
+	for (int i = 0; i < (int)targets.size(); i++)
+	{
+		if (targets[i] == target)
+		{
+			route.target = i;
+		}
+	}
+
+	if (route.target < 0)
+	{
+		route.target = targets.size();
+		targets.push_back(target);
+	}
+
+	routes.push_back(route);
+}
+
+bool SocketRelay::matches(const Route& route, const unsigned char * name,
+	size_t nameLength, int level) const
+{
+	if (level < route.threshold)
+	{
+		return false;
+	}
+
+	size_t length = route.loggerName.length();
+	if (length == 0)
+	{
+		return true;
+	}
+
+	if (nameLength < length ||
+		memcmp(name, route.loggerName.data(), length * sizeof(TCHAR)) != 0)
+	{
+		return false;
+	}
+
+	if (nameLength == length)
+	{
+		return true;
+	}
+
+	// the characters may not be aligned in the buffer
+	TCHAR next;
+	memcpy(&next, name + length * sizeof(TCHAR), sizeof(TCHAR));
+	return next == _T('.');
+}
+
+size_t SocketRelay::relay(const unsigned char * buffer, size_t length)
+{
+	std::vector< std::vector<ByteRange> > batches(targets.size());
+
+	const unsigned char * p = buffer, * end = buffer + length;
+	const unsigned char * consumed = buffer;
+	const unsigned char * chars;
+	size_t charCount;
+	long events = 0;
+
+	// the fields of the frames are the ones of LoggingEvent::write
+	while (true)
+	{
+		const unsigned char * frame = p;
+
+		const unsigned char * name;
+		size_t nameLength;
+		if (!skipString(p, end, name, nameLength))
+		{
+			break;
+		}
+
+		int level;
+		if ((size_t)(end - p) < sizeof(level))
+		{
+			break;
+		}
+		memcpy(&level, p, sizeof(level));
+		p += sizeof(level);
+
+		// message, timeStamp, line, ndc, threadId, fields, stack trace
+		if (!skipString(p, end, chars, charCount) ||
+			!skip(p, end, sizeof(time_t) + sizeof(int)) ||
+			!skipString(p, end, chars, charCount) ||
+			!skip(p, end, sizeof(unsigned long)) ||
+			!skipFields(p, end) ||
+			!skipString(p, end, chars, charCount))
+		{
+			break;
+		}
+
+		std::vector<Route>::const_iterator it;
+		for (it = routes.begin(); it != routes.end(); it++)
+		{
+			if (!matches(*it, name, nameLength, level))
+			{
+				continue;
+			}
+
+			std::vector<ByteRange>& batch = batches[it->target];
+			const unsigned char * last = batch.empty() ? 0 :
+				(const unsigned char *)batch.back().data + batch.back().length;
+
+			if (last == p)
+			{
+				// already sent to this target by another route
+			}
+			else if (last == frame)
+			{
+				// follows the previous event sent to this target
+				batch.back().length += p - frame;
+			}
+			else
+			{
+				batch.push_back(ByteRange(frame, p - frame));
+			}
+		}
+
+		consumed = p;
+		events++;
+	}
+
+	for (int i = 0; i < (int)targets.size(); i++)
+	{
+		std::vector<ByteRange>& batch = batches[i];
+		if (batch.empty())
+		{
+			continue;
+		}
+
+		TargetPtr target = targets[i];
+		try
+		{
+			synchronized sync(target);
+			target->write(&batch[0], batch.size());
+		}
+		catch(IOException& e)
+		{
+			LogLog::error(_T("Could not relay events to ") +
+				target->toString() + _T("."), e);
+		}
+	}
+
+	Interlocked::add(&eventCount, events);
+	return consumed - buffer;
+}
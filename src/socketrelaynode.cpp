@@ -0,0 +1,113 @@
+/***************************************************************************
+                          socketrelaynode.cpp  -  class SocketRelayNode
+                             -------------------
+    begin                : sam mai 24 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/net/socketrelaynode.h>
+#include <log4cxx/helpers/socket.h>
+#include <log4cxx/helpers/socketinputstream.h>
+#include <log4cxx/fields.h>
+#include <log4cxx/helpers/loglog.h>
+#include <string.h>
+
+using namespace log4cxx;
+using namespace log4cxx::net;
+using namespace log4cxx::helpers;
+
+size_t SocketRelayNode::BUFFER_SIZE = 64 * 1024;
+
+SocketRelayNode::SocketRelayNode(helpers::SocketPtr socket,
+	SocketRelayPtr relay)
+ : socket(socket), relay(relay)
+{
+}
+
+void SocketRelayNode::run()
+{
+	size_t size = BUFFER_SIZE;
+	unsigned char * buffer = new unsigned char[size];
+	size_t length = 0;
+
+	// the name, message and NDC of an event, the names and strings of
+	// its typed fields, plus its other fields
+	size_t maxSize = (3 + 2 * Fields::MAX_FIELDS) * (sizeof(tstring::size_type)
+		+ SocketInputStream::MAX_STRING_LENGTH * sizeof(TCHAR))
+		+ 64 + 16 * Fields::MAX_FIELDS;
+
+	try
+	{
+		while(true)
+		{
+			size_t read = socket->readSome(buffer + length,
+				size - length);
+			if (read == 0)
+			{
+				if (length != 0)
+				{
+					LogLog::warn(_T("Connection closed in the middle of an event."));
+				}
+				break;
+			}
+
+			length += read;
+
+			// the incomplete event at the end of the buffer is kept
+			// for the next read
+			size_t consumed = relay->relay(buffer, length);
+			length -= consumed;
+
+			if (length == size)
+			{
+				// the event is larger than the buffer
+				if (size >= maxSize)
+				{
+					// cannot happen with valid events
+					throw SocketException();
+				}
+
+				unsigned char * old = buffer;
+				size = (2 * size < maxSize) ? 2 * size : maxSize;
+				buffer = new unsigned char[size];
+				memcpy(buffer, old, length);
+				delete [] old;
+			}
+
+			if (length != 0 && consumed != 0)
+			{
+				memmove(buffer, buffer + consumed, length);
+			}
+		}
+
+		LogLog::debug(_T("End of stream. Closing connection."));
+	}
+	catch(SocketException& e)
+	{
+		LogLog::debug(_T("Caught SocketException. Closing connection"));
+	}
+	catch(Exception& e)
+	{
+		LogLog::error(_T("Unexpected exception. Closing connection."), e);
+	}
+
+	delete [] buffer;
+
+	try
+	{
+		socket->close();
+	}
+	catch(SocketException& e)
+	{
+		LogLog::debug(_T("Could not close SocketRelayNode connection: "), e);
+	}
+}
@@ -0,0 +1,170 @@
+/***************************************************************************
+                          stacktrace.cpp  -  class StackTrace
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/helpers/stacktrace.h>
+#include <log4cxx/helpers/criticalsection.h>
+#include <map>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#ifdef HAVE_EXECINFO_H
+#include <execinfo.h>
+#endif
+#ifdef HAVE_DLADDR
+#include <dlfcn.h>
+#endif
+#ifdef __GNUC__
+#include <cxxabi.h>
+#endif
+#endif
+
+using namespace log4cxx;
+using namespace log4cxx::helpers;
+
+/** symbols of the addresses already looked up */
+static std::map<void *, tstring> symbols;
+static CriticalSection symbolsCs;
+
+StackTrace::StackTrace() : frameCount(0)
+{
+}
+
+StackTrace::StackTrace(const tstring& text) : frameCount(0), text(text)
+{
+}
+
+void StackTrace::capture(int skip)
+{
+	frameCount = 0;
+	text.erase();
+
+#ifdef WIN32
+	frameCount = ::CaptureStackBackTrace(skip + 1, MAX_FRAMES, frames, 0);
+#elif defined(HAVE_EXECINFO_H)
+	// backtrace cannot skip frames: they are removed from the array
+	void * captured[MAX_FRAMES + 8];
+	int count = ::backtrace(captured, MAX_FRAMES + 8);
+	for (int i = skip + 1; i < count && frameCount < MAX_FRAMES; i++)
+	{
+		frames[frameCount++] = captured[i];
+	}
+#endif
+}
+
+/** Widens or copies an ASCII string returned by the system. */
+static tstring toTString(const char * s)
+{
+	std::string narrow(s);
+	return tstring(narrow.begin(), narrow.end());
+}
+
+tstring StackTrace::getSymbol(void * address)
+{
+	symbolsCs.lock();
+	std::map<void *, tstring>::iterator it = symbols.find(address);
+	if (it != symbols.end())
+	{
+		tstring symbol = it->second;
+		symbolsCs.unlock();
+		return symbol;
+	}
+	symbolsCs.unlock();
+
+	// looked up without the lock: two threads may compute the same
+	// symbol, which is harmless.
+	tostringstream symbol;
+	symbol << std::hex;
+
+#if defined(HAVE_DLADDR) && !defined(WIN32)
+	Dl_info info;
+	if (::dladdr(address, &info) == 0)
+	{
+		info.dli_fname = 0;
+		info.dli_sname = 0;
+	}
+
+	if (info.dli_sname != 0)
+	{
+		char * demangled = 0;
+#ifdef __GNUC__
+		int status;
+		demangled = abi::__cxa_demangle(info.dli_sname, 0, 0, &status);
+#endif
+		symbol << toTString(demangled != 0 ? demangled : info.dli_sname)
+			<< _T("+0x") << ((char *)address - (char *)info.dli_saddr);
+		free(demangled);
+	}
+	else
+	{
+		symbol << address;
+	}
+
+	if (info.dli_fname != 0)
+	{
+		symbol << _T(" (") << toTString(info.dli_fname) << _T(")");
+	}
+#else
+	symbol << address;
+#endif
+
+	symbolsCs.lock();
+	symbols[address] = symbol.str();
+	symbolsCs.unlock();
+
+	return symbol.str();
+}
+
+long StackTrace::getCachedSymbolCount()
+{
+	symbolsCs.lock();
+	long count = (long)symbols.size();
+	symbolsCs.unlock();
+	return count;
+}
+
+void StackTrace::format(tostream& os, int maxFrames) const
+{
+	if (!text.empty())
+	{
+		// each frame of the text starts with a line separator
+		tstring::size_type end = tstring::npos;
+		if (maxFrames > 0)
+		{
+			end = 0;
+			for (int i = 0; i < maxFrames && end != tstring::npos; i++)
+			{
+				end = text.find(_T('\n'), end + 1);
+			}
+		}
+		os << text.substr(0, end);
+		return;
+	}
+
+	int count = (maxFrames > 0 && maxFrames < frameCount) ?
+		maxFrames : frameCount;
+	for (int i = 0; i < count; i++)
+	{
+		os << _T("\n\tat ") << getSymbol(frames[i]);
+	}
+}
+
+tstring StackTrace::toString() const
+{
+	tostringstream os;
+	format(os);
+	return os.str();
+}
@@ -0,0 +1,414 @@
+/***************************************************************************
+                          statisticsappender.cpp  -  class StatisticsAppender
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/statisticsappender.h>
+#include <log4cxx/helpers/loglog.h>
+#include <log4cxx/helpers/stringhelper.h>
+#include <log4cxx/helpers/optionconverter.h>
+#include <log4cxx/spi/loggingevent.h>
+#include <log4cxx/logger.h>
+#include <log4cxx/level.h>
+
+using namespace log4cxx;
+using namespace log4cxx::helpers;
+using namespace log4cxx::spi;
+
+/** The default flush interval is 60 seconds. */
+int StatisticsAppender::DEFAULT_FLUSH_INTERVAL = 60;
+
+/** The levels of the counters. */
+static const Level * levels[] =
+{
+	&Level::FATAL, &Level::ERROR, &Level::WARN, &Level::INFO, &Level::DEBUG
+};
+
+/** Returns the index of the counters of <code>level</code>. */
+static inline int levelIndex(const Level& level)
+{
+	int value = level.toInt();
+	if (value >= Level::FATAL_INT)
+	{
+		return 0;
+	}
+	else if (value >= Level::ERROR_INT)
+	{
+		return 1;
+	}
+	else if (value >= Level::WARN_INT)
+	{
+		return 2;
+	}
+	else if (value >= Level::INFO_INT)
+	{
+		return 3;
+	}
+	return 4;
+}
+
+/** Returns true if <code>c</code> may be part of a field name. */
+static inline bool isNameChar(TCHAR c)
+{
+	return (c >= _T('a') && c <= _T('z')) || (c >= _T('A') && c <= _T('Z'))
+		|| (c >= _T('0') && c <= _T('9')) || c == _T('_') || c == _T('.');
+}
+
+StatisticsAppender::StatisticsAppender()
+: depth(0), flushInterval(DEFAULT_FLUSH_INTERVAL), flusherStarted(false),
+closing(false)
+{
+}
+
+StatisticsAppender::~StatisticsAppender()
+{
+	finalize();
+
+	for (size_t i = 0; i < shards.size(); i++)
+	{
+		delete shards[i];
+	}
+}
+
+void StatisticsAppender::doAppend(const spi::LoggingEvent& event)
+{
+	if(closed)
+	{
+		LogLog::error(_T("Attempted to append to closed appender named [")
+			+name+_T("]."));
+		return;
+	}
+
+	if(!isAccepted(event))
+	{
+		return;
+	}
+
+	append(event);
+}
+
+void StatisticsAppender::append(const spi::LoggingEvent& event)
+{
+	Shard * shard = (Shard *)currentShard.GetData();
+	if (shard == 0)
+	{
+		shard = new Shard;
+		currentShard.SetData(shard);
+
+		synchronized sync(this);
+		shards.push_back(shard);
+	}
+
+	const tstring& name = event.getLoggerName();
+	int level = levelIndex(event.getLevel());
+
+	shard->cs.lock();
+
+	Counters * counters;
+	std::map<tstring, Counters *>::iterator it = shard->loggers.find(name);
+	if (it != shard->loggers.end())
+	{
+		counters = it->second;
+	}
+	else
+	{
+		counters = &shard->groups[getGroup(name)];
+		if (counters->fields.empty())
+		{
+			for (int i = 0; i < LEVEL_COUNT; i++)
+			{
+				counters->events[i] = 0;
+			}
+
+			FieldStatistics none = { 0, 0, 0, 0 };
+			counters->fields.resize(LEVEL_COUNT * fields.size() + 1, none);
+		}
+		shard->loggers[name] = counters;
+	}
+
+	counters->events[level]++;
+
+	if (!fields.empty())
+	{
+		parseFields(event.getRenderedMessage(),
+			&counters->fields[level * fields.size()]);
+	}
+
+	shard->cs.unlock();
+}
+
+tstring StatisticsAppender::getGroup(const tstring& name) const
+{
+	if (depth <= 0)
+	{
+		return name;
+	}
+
+	tstring::size_type end = 0;
+	for (int i = 0; i < depth; i++)
+	{
+		end = name.find(_T('.'), end == 0 ? 0 : end + 1);
+		if (end == tstring::npos)
+		{
+			return name;
+		}
+	}
+
+	return name.substr(0, end);
+}
+
+void StatisticsAppender::parseFields(const tstring& message,
+	FieldStatistics * statistics) const
+{
+	for (size_t f = 0; f < fields.size(); f++)
+	{
+		const tstring& field = fields[f];
+		tstring::size_type position = 0;
+
+		// the first name=value, where name is a whole word
+		while ((position = message.find(field, position)) != tstring::npos)
+		{
+			tstring::size_type end = position + field.size();
+			if ((position == 0 || !isNameChar(message[position - 1]))
+				&& end < message.size() && message[end] == _T('='))
+			{
+				const TCHAR * begin = message.c_str() + end + 1;
+				TCHAR * stop;
+				double value = tcstod(begin, &stop);
+				if (stop != begin)
+				{
+					FieldStatistics& s = statistics[f];
+					if (s.count == 0 || value < s.min)
+					{
+						s.min = value;
+					}
+					if (s.count == 0 || value > s.max)
+					{
+						s.max = value;
+					}
+					s.count++;
+					s.sum += value;
+					break;
+				}
+			}
+			position = end;
+		}
+	}
+}
+
+void StatisticsAppender::flush()
+{
+	std::vector<Shard *> shards;
+	{
+		synchronized sync(this);
+		shards = this->shards;
+	}
+
+	// sums of the shards, which are reset
+	std::map<tstring, Counters> totals;
+	FieldStatistics none = { 0, 0, 0, 0 };
+	size_t fieldCount = LEVEL_COUNT * fields.size();
+
+	for (size_t i = 0; i < shards.size(); i++)
+	{
+		Shard * shard = shards[i];
+		shard->cs.lock();
+
+		std::map<tstring, Counters>::iterator it;
+		for (it = shard->groups.begin(); it != shard->groups.end(); it++)
+		{
+			Counters& counters = it->second;
+			Counters& total = totals[it->first];
+			if (total.fields.empty())
+			{
+				for (int l = 0; l < LEVEL_COUNT; l++)
+				{
+					total.events[l] = 0;
+				}
+				total.fields.resize(fieldCount + 1, none);
+			}
+
+			for (int l = 0; l < LEVEL_COUNT; l++)
+			{
+				total.events[l] += counters.events[l];
+				counters.events[l] = 0;
+			}
+
+			for (size_t f = 0; f < fieldCount; f++)
+			{
+				FieldStatistics& s = counters.fields[f];
+				FieldStatistics& t = total.fields[f];
+				if (s.count == 0)
+				{
+					continue;
+				}
+				if (t.count == 0 || s.min < t.min)
+				{
+					t.min = s.min;
+				}
+				if (t.count == 0 || s.max > t.max)
+				{
+					t.max = s.max;
+				}
+				t.count += s.count;
+				t.sum += s.sum;
+				s = none;
+			}
+		}
+
+		shard->cs.unlock();
+	}
+
+	if (totals.empty())
+	{
+		return;
+	}
+
+	LoggerPtr logger = Logger::getLogger(_T("log4cxx.StatisticsAppender"));
+
+	std::map<tstring, Counters>::iterator it;
+	for (it = totals.begin(); it != totals.end(); it++)
+	{
+		const Counters& total = it->second;
+		for (int l = 0; l < LEVEL_COUNT; l++)
+		{
+			if (total.events[l] == 0)
+			{
+				continue;
+			}
+
+			tostringstream message;
+			message.precision(15);
+			message << it->first << _T(" ") << levels[l]->toString()
+				<< _T(" ") << total.events[l];
+
+			for (size_t f = 0; f < fields.size(); f++)
+			{
+				const FieldStatistics& s = total.fields[l * fields.size() + f];
+				if (s.count != 0)
+				{
+					message << _T(" ") << fields[f] << _T("=") << s.count
+						<< _T("/") << s.sum << _T("/") << s.min
+						<< _T("/") << s.max;
+				}
+			}
+
+			LoggingEvent summary(logger, Level::INFO, message.str());
+			appendLoopOnAppenders(summary);
+		}
+	}
+}
+
+void StatisticsAppender::activateOptions()
+{
+	if (flushInterval > 0 && !flusherStarted)
+	{
+		flusherStarted = true;
+		Thread * thread = new Thread(new Flusher(this));
+		thread->start();
+	}
+}
+
+void StatisticsAppender::close()
+{
+	{
+		synchronized sync(this);
+
+		if(closed)
+		{
+			return;
+		}
+
+		closed = true;
+	}
+
+	if (flusherStarted)
+	{
+		// the flush thread flushes once more before it ends. The thread
+		// object deletes itself: it cannot be joined.
+		closing = true;
+		wakeUp.post();
+		flusherEnded.wait();
+	}
+	else
+	{
+		flush();
+	}
+
+	AppenderList appenders = getAllAppenders();
+	for (size_t i = 0; i < appenders.size(); i++)
+	{
+		appenders[i]->close();
+	}
+}
+
+void StatisticsAppender::setFields(const tstring& fields)
+{
+	this->fields.clear();
+
+	tstring::size_type begin = 0;
+	while (begin <= fields.size())
+	{
+		tstring::size_type end = fields.find(_T(','), begin);
+		if (end == tstring::npos)
+		{
+			end = fields.size();
+		}
+
+		tstring field = StringHelper::trim(fields.substr(begin, end - begin));
+		if (!field.empty())
+		{
+			this->fields.push_back(field);
+		}
+		begin = end + 1;
+	}
+}
+
+void StatisticsAppender::setOption(const tstring& option,
+	const tstring& value)
+{
+	if (StringHelper::equalsIgnoreCase(option, _T("depth")))
+	{
+		setDepth(OptionConverter::toInt(value, 0));
+	}
+	else if (StringHelper::equalsIgnoreCase(option, _T("fields")))
+	{
+		setFields(value);
+	}
+	else if (StringHelper::equalsIgnoreCase(option, _T("flushinterval")))
+	{
+		setFlushInterval(OptionConverter::toInt(value,
+			DEFAULT_FLUSH_INTERVAL));
+	}
+	else
+	{
+		AppenderSkeleton::setOption(option, value);
+	}
+}
+
+StatisticsAppender::Flusher::Flusher(StatisticsAppender * appender)
+: appender(appender)
+{
+}
+
+void StatisticsAppender::Flusher::run()
+{
+	while (!appender->closing)
+	{
+		appender->wakeUp.wait((long)appender->flushInterval * 1000);
+		appender->flush();
+	}
+
+	appender->flusherEnded.post();
+}
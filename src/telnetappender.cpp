@@ -58,7 +58,7 @@ void TelnetAppender::setOption(const std::string& option,
 	}
 	else
 	{
-		AppenderSkeleton::setOption(name, value);
+		AppenderSkeleton::setOption(option, value);
 	}
 }
 
@@ -22,6 +22,7 @@ using namespace log4cxx::helpers;
 #ifdef HAVE_PTHREAD_H
 #include <pthread.h>
 #include <unistd.h> // usleep
+#include <sched.h> // sched_yield
 void * threadProc(void * arg)
 {
 //	LogLog::debug(_T("entering thread proc"));
@@ -135,6 +136,17 @@ void Thread::sleep(long millis)
 #endif
 }
 
+void Thread::yield()
+{
+#ifdef HAVE_PTHREAD_H
+	::sched_yield();
+#elif defined(WIN32)
+	::Sleep(0);
+#else
+	::usleep(0);
+#endif
+}
+
 void Thread::setPriority(int newPriority)
 {
 	switch(newPriority)
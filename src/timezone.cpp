@@ -0,0 +1,802 @@
+/***************************************************************************
+                          timezone.cpp  -  class TimeZone
+                             -------------------
+    begin                : dim mai 25 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/helpers/timezone.h>
+#include <log4cxx/helpers/interlocked.h>
+#include <log4cxx/helpers/loglog.h>
+#include <log4cxx/helpers/stringhelper.h>
+#include <algorithm>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+using namespace log4cxx;
+using namespace log4cxx::helpers;
+
+typedef std::map<tstring, TimeZonePtr> TimeZoneMap;
+static TimeZoneMap timeZones;
+static CriticalSection timeZonesCs;
+
+static const int64 MIN_TIME = -((int64)1 << 62);
+static const int64 MAX_TIME = ((int64)1 << 62);
+static const long SECONDS_PER_DAY = 86400;
+
+/** Days from 01.01.1970 to the given date of the proleptic Gregorian
+calendar. */
+static int64 daysFromCivil(int64 year, int month, int day)
+{
+	year -= (month <= 2) ? 1 : 0;
+	int64 era = (year >= 0 ? year : year - 399) / 400;
+	int64 yoe = year - era * 400;
+	int64 doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+	int64 doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+	return era * 146097 + doe - 719468;
+}
+
+/** Year of the day counted from 01.01.1970. */
+static int64 yearFromDays(int64 days)
+{
+	days += 719468;
+	int64 era = (days >= 0 ? days : days - 146096) / 146097;
+	int64 doe = days - era * 146097;
+	int64 yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+	int64 doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+	int64 mp = (5 * doy + 2) / 153;
+	return yoe + era * 400 + (mp >= 10 ? 1 : 0);
+}
+
+static bool isLeapYear(int64 year)
+{
+	return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+static int64 floorDiv(int64 a, int64 b)
+{
+	return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+static long readInt32(const unsigned char * p)
+{
+	return (long)(int)(((unsigned long)p[0] << 24) | ((unsigned long)p[1] << 16)
+		| ((unsigned long)p[2] << 8) | (unsigned long)p[3]);
+}
+
+static int64 readInt64(const unsigned char * p)
+{
+	return (int64)(((unsigned long long)(unsigned long)readInt32(p) << 32)
+		| ((unsigned long long)(unsigned long)readInt32(p + 4) & 0xFFFFFFFFULL));
+}
+
+/** Parses [+|-]hh[:mm[:ss]] at <code>pos</code>. */
+static bool parseTime(const std::string& s, size_t& pos, long& seconds)
+{
+	int sign = 1;
+	if (pos < s.length() && (s[pos] == '+' || s[pos] == '-'))
+	{
+		sign = (s[pos] == '-') ? -1 : 1;
+		pos++;
+	}
+
+	long fields[3] = { 0, 0, 0 };
+	for (int i = 0; i < 3; i++)
+	{
+		if (i > 0)
+		{
+			if (pos >= s.length() || s[pos] != ':')
+			{
+				break;
+			}
+			pos++;
+		}
+
+		size_t begin = pos;
+		while (pos < s.length() && s[pos] >= '0' && s[pos] <= '9' && pos - begin < 3)
+		{
+			fields[i] = fields[i] * 10 + (s[pos++] - '0');
+		}
+
+		if (pos == begin)
+		{
+			return false;
+		}
+	}
+
+	seconds = sign * (fields[0] * 3600 + fields[1] * 60 + fields[2]);
+	return true;
+}
+
+/** Parses a time zone abbreviation at <code>pos</code> into
+<code>name</code>. */
+static bool parseName(const std::string& s, size_t& pos, tstring& name)
+{
+	size_t begin = pos;
+	if (pos < s.length() && s[pos] == '<')
+	{
+		size_t end = s.find('>', pos);
+		if (end == std::string::npos)
+		{
+			return false;
+		}
+		name.assign(s.begin() + begin + 1, s.begin() + end);
+		pos = end + 1;
+		return end - begin > 3;
+	}
+
+	while (pos < s.length() && isalpha((unsigned char)s[pos]))
+	{
+		pos++;
+	}
+
+	name.assign(s.begin() + begin, s.begin() + pos);
+	return pos - begin >= 3;
+}
+
+TimeZone::TimeZone(const tstring& id)
+: id(id), hasRule(false), stdOffset(0), dstOffset(0), hasDst(false),
+ stdName(NO_NAME), dstName(NO_NAME), current(0)
+{
+}
+
+TimeZone::~TimeZone()
+{
+	std::vector<Period *>::iterator it;
+	for (it = periods.begin(); it != periods.end(); it++)
+	{
+		delete *it;
+	}
+}
+
+TimeZonePtr TimeZone::getTimeZone(const tstring& id)
+{
+	timeZonesCs.lock();
+
+	TimeZoneMap::iterator it = timeZones.find(id);
+	if (it != timeZones.end())
+	{
+		TimeZonePtr timeZone = it->second;
+		timeZonesCs.unlock();
+		return timeZone;
+	}
+
+	TimeZonePtr timeZone = new TimeZone(id);
+	bool found = true;
+
+	USES_CONVERSION;
+	if (id.empty())
+	{
+#ifdef WIN32
+		TIME_ZONE_INFORMATION tzi;
+		if (::GetTimeZoneInformation(&tzi) != TIME_ZONE_ID_INVALID)
+		{
+			timeZone->hasRule = true;
+			timeZone->stdOffset = -(tzi.Bias + tzi.StandardBias) * 60;
+			timeZone->dstOffset = -(tzi.Bias + tzi.DaylightBias) * 60;
+			timeZone->hasDst = tzi.StandardDate.wMonth != 0
+				&& tzi.DaylightDate.wMonth != 0;
+			timeZone->stdName = timeZone->addName(W2T(tzi.StandardName));
+			timeZone->dstName = timeZone->addName(W2T(tzi.DaylightName));
+
+			for (int i = 0; i < 2; i++)
+			{
+				// the day of these dates is a week of the month
+				const SYSTEMTIME& st = (i == 0) ? tzi.DaylightDate : tzi.StandardDate;
+				RuleDate& date = (i == 0) ? timeZone->dstStart : timeZone->dstEnd;
+				date.type = 'M';
+				date.month = st.wMonth;
+				date.week = st.wDay;
+				date.day = st.wDayOfWeek;
+				date.time = st.wHour * 3600 + st.wMinute * 60 + st.wSecond;
+			}
+		}
+#else
+		const char * tz = getenv("TZ");
+		if (tz == 0)
+		{
+			timeZone->loadFile("/etc/localtime");
+		}
+		else if (*tz != '\0')
+		{
+			found = timeZone->load((*tz == ':') ? tz + 1 : tz);
+		}
+#endif
+	}
+	else if (StringHelper::equalsIgnoreCase(id, _T("GMT"))
+		|| StringHelper::equalsIgnoreCase(id, _T("UTC")))
+	{
+		timeZone->hasRule = true;
+		timeZone->stdName = timeZone->addName(
+			StringHelper::toUpperCase(id));
+	}
+	else if (!timeZone->parseCustomID(id))
+	{
+		found = timeZone->load(T2A(id.c_str()));
+	}
+
+	if (!found)
+	{
+		LogLog::warn(_T("unknown time zone \"") + id + _T("\", using GMT"));
+		timeZone = new TimeZone(id);
+		timeZone->hasRule = true;
+		timeZone->stdName = timeZone->addName(_T("GMT"));
+	}
+
+	timeZones[id] = timeZone;
+	timeZonesCs.unlock();
+
+	return timeZone;
+}
+
+TimeZonePtr TimeZone::getDefault()
+{
+	return getTimeZone(_T(""));
+}
+
+bool TimeZone::inDaylightTime(time_t time)
+{
+	const Period * p = current;
+	if (p != 0 && time >= p->begin && time < p->end)
+	{
+		return p->isDst;
+	}
+
+	Period period;
+	findPeriod(time, period);
+	return period.isDst;
+}
+
+tstring TimeZone::getAbbreviation(time_t time)
+{
+	const Period * p = current;
+	Period period;
+	if (p == 0 || time < p->begin || time >= p->end)
+	{
+		findPeriod(time, period);
+		p = &period;
+	}
+
+	if (p->name != NO_NAME)
+	{
+		return names[p->name];
+	}
+
+	// the name of a custom ID
+	long offset = p->offset < 0 ? -p->offset : p->offset;
+	tostringstream name;
+	name << _T("GMT") << (p->offset < 0 ? _T('-') : _T('+'))
+		<< (TCHAR)(_T('0') + offset / 36000)
+		<< (TCHAR)(_T('0') + offset / 3600 % 10) << _T(':')
+		<< (TCHAR)(_T('0') + offset / 600 % 6)
+		<< (TCHAR)(_T('0') + offset / 60 % 10);
+	return name.str();
+}
+
+int TimeZone::addName(const tstring& name)
+{
+	if (name.empty())
+	{
+		return NO_NAME;
+	}
+
+	std::vector<tstring>::iterator it =
+		std::find(names.begin(), names.end(), name);
+	if (it != names.end())
+	{
+		return (int)(it - names.begin());
+	}
+
+	names.push_back(name);
+	return (int)names.size() - 1;
+}
+
+bool TimeZone::load(const std::string& name)
+{
+#ifndef WIN32
+	if (!name.empty() && name[0] == '/')
+	{
+		if (loadFile(name))
+		{
+			return true;
+		}
+	}
+	else
+	{
+		const char * dir = getenv("TZDIR");
+		if (loadFile(std::string(dir != 0 ? dir : "/usr/share/zoneinfo")
+			+ "/" + name))
+		{
+			return true;
+		}
+	}
+#endif
+
+	return parseRule(name);
+}
+
+bool TimeZone::loadFile(const std::string& fileName)
+{
+	FILE * file = fopen(fileName.c_str(), "rb");
+	if (file == 0)
+	{
+		return false;
+	}
+
+	std::vector<unsigned char> data;
+	unsigned char buffer[4096];
+	size_t read;
+	while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+	{
+		data.insert(data.end(), buffer, buffer + read);
+	}
+	fclose(file);
+
+	// header: magic, version, 15 reserved bytes and 6 counts
+	const size_t HEADER_SIZE = 44;
+	if (data.size() < HEADER_SIZE || memcmp(&data[0], "TZif", 4) != 0)
+	{
+		return false;
+	}
+
+	// version 2 files repeat the data with 64 bits times, followed by
+	// a POSIX TZ string for the times after the last transition.
+	size_t begin = 0;
+	size_t timeSize = 4;
+	for (int pass = 0; pass < 2; pass++)
+	{
+		if (data.size() < begin + HEADER_SIZE)
+		{
+			return false;
+		}
+
+		const unsigned char * header = &data[begin];
+		size_t isUtCount = readInt32(header + 20);
+		size_t isStdCount = readInt32(header + 24);
+		size_t leapCount = readInt32(header + 28);
+		size_t timeCount = readInt32(header + 32);
+		size_t typeCount = readInt32(header + 36);
+		size_t charCount = readInt32(header + 40);
+
+		size_t size = timeCount * (timeSize + 1) + typeCount * 6 + charCount
+			+ leapCount * (timeSize + 4) + isStdCount + isUtCount;
+		if (typeCount == 0 || data.size() < begin + HEADER_SIZE + size)
+		{
+			return false;
+		}
+
+		if (pass == 0 && header[4] >= '2')
+		{
+			begin += HEADER_SIZE + size;
+			timeSize = 8;
+			continue;
+		}
+
+		const unsigned char * p = header + HEADER_SIZE;
+		transitionTimes.resize(timeCount);
+		transitionTypes.resize(timeCount);
+		localTimeTypes.resize(typeCount);
+
+		size_t i;
+		for (i = 0; i < timeCount; i++, p += timeSize)
+		{
+			transitionTimes[i] = (timeSize == 8) ? readInt64(p) : readInt32(p);
+		}
+
+		for (i = 0; i < timeCount; i++, p++)
+		{
+			if (*p >= typeCount)
+			{
+				return false;
+			}
+			transitionTypes[i] = *p;
+		}
+
+		// the abbreviations follow the local time types
+		const char * chars = (const char *)p + typeCount * 6;
+		for (i = 0; i < typeCount; i++, p += 6)
+		{
+			localTimeTypes[i].offset = readInt32(p);
+			localTimeTypes[i].isDst = p[4] != 0;
+			localTimeTypes[i].name = NO_NAME;
+			if (p[5] < charCount)
+			{
+				const char * name = chars + p[5];
+				const char * end = (const char *)memchr(name, '\0',
+					charCount - p[5]);
+				if (end != 0)
+				{
+					localTimeTypes[i].name = addName(tstring(name, end));
+				}
+			}
+		}
+
+		// the footer is enclosed in new lines
+		size_t footer = begin + HEADER_SIZE + size;
+		if (timeSize == 8 && footer < data.size() && data[footer] == '\n')
+		{
+			std::string rule;
+			for (i = footer + 1; i < data.size() && data[i] != '\n'; i++)
+			{
+				rule += (char)data[i];
+			}
+
+			if (!rule.empty())
+			{
+				parseRule(rule);
+			}
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+bool TimeZone::parseRule(const std::string& rule)
+{
+	size_t pos = 0;
+	long offset;
+	tstring name;
+
+	// offsets of POSIX TZ strings are positive west of Greenwich
+	if (!parseName(rule, pos, name) || !parseTime(rule, pos, offset))
+	{
+		return false;
+	}
+
+	stdOffset = -offset;
+	dstOffset = stdOffset;
+	hasDst = false;
+	stdName = addName(name);
+	dstName = stdName;
+
+	if (pos < rule.length())
+	{
+		if (!parseName(rule, pos, name))
+		{
+			return false;
+		}
+
+		hasDst = true;
+		dstName = addName(name);
+		dstOffset = stdOffset + 3600;
+		if (pos < rule.length() && rule[pos] != ',')
+		{
+			if (!parseTime(rule, pos, offset))
+			{
+				return false;
+			}
+			dstOffset = -offset;
+		}
+
+		// the default rule is the one of the United States
+		std::string dates = (pos < rule.length()) ? rule.substr(pos)
+			: std::string(",M3.2.0,M11.1.0");
+
+		size_t datePos = 0;
+		for (int i = 0; i < 2; i++)
+		{
+			RuleDate& date = (i == 0) ? dstStart : dstEnd;
+			if (datePos >= dates.length() || dates[datePos++] != ',')
+			{
+				return false;
+			}
+
+			date.type = 'D';
+			date.day = date.week = date.month = 0;
+			if (datePos < dates.length()
+				&& (dates[datePos] == 'J' || dates[datePos] == 'M'))
+			{
+				date.type = dates[datePos++];
+			}
+
+			int fields[3] = { 0, 0, 0 };
+			int count = (date.type == 'M') ? 3 : 1;
+			for (int j = 0; j < count; j++)
+			{
+				if (j > 0 && (datePos >= dates.length() || dates[datePos++] != '.'))
+				{
+					return false;
+				}
+
+				size_t begin = datePos;
+				while (datePos < dates.length()
+					&& dates[datePos] >= '0' && dates[datePos] <= '9')
+				{
+					fields[j] = fields[j] * 10 + (dates[datePos++] - '0');
+				}
+
+				if (datePos == begin)
+				{
+					return false;
+				}
+			}
+
+			if (date.type == 'M')
+			{
+				date.month = fields[0];
+				date.week = fields[1];
+				date.day = fields[2];
+				if (date.month < 1 || date.month > 12 || date.week < 1
+					|| date.week > 5 || date.day > 6)
+				{
+					return false;
+				}
+			}
+			else
+			{
+				date.day = fields[0];
+				if (date.day > 365 || (date.type == 'J' && date.day < 1))
+				{
+					return false;
+				}
+			}
+
+			date.time = 7200;
+			if (datePos < dates.length() && dates[datePos] == '/')
+			{
+				datePos++;
+				if (!parseTime(dates, datePos, date.time))
+				{
+					return false;
+				}
+			}
+		}
+
+		if (datePos != dates.length())
+		{
+			return false;
+		}
+	}
+
+	hasRule = true;
+	return true;
+}
+
+bool TimeZone::parseCustomID(const tstring& id)
+{
+	if (id.length() < 5 || !(StringHelper::equalsIgnoreCase(id.substr(0, 3), _T("GMT"))
+		|| StringHelper::equalsIgnoreCase(id.substr(0, 3), _T("UTC")))
+		|| (id[3] != _T('+') && id[3] != _T('-')))
+	{
+		return false;
+	}
+
+	long hours = 0, minutes = 0;
+	size_t pos = 4, digits = 0;
+	while (pos < id.length() && id[pos] >= _T('0') && id[pos] <= _T('9'))
+	{
+		hours = hours * 10 + (id[pos++] - _T('0'));
+		digits++;
+	}
+
+	if (pos < id.length() && id[pos] == _T(':') && digits <= 2)
+	{
+		pos++;
+		size_t begin = pos;
+		while (pos < id.length() && id[pos] >= _T('0') && id[pos] <= _T('9'))
+		{
+			minutes = minutes * 10 + (id[pos++] - _T('0'));
+		}
+
+		if (pos - begin != 2)
+		{
+			return false;
+		}
+	}
+	else if (digits == 4)
+	{
+		// GMT+hhmm
+		minutes = hours % 100;
+		hours /= 100;
+	}
+	else if (digits == 0 || digits > 2)
+	{
+		return false;
+	}
+
+	if (pos != id.length() || hours > 23 || minutes > 59)
+	{
+		return false;
+	}
+
+	hasRule = true;
+	stdOffset = ((id[3] == _T('-')) ? -1 : 1) * (hours * 3600 + minutes * 60);
+	dstOffset = stdOffset;
+	return true;
+}
+
+void TimeZone::findPeriod(time_t time, Period& period)
+{
+	periodsCs.lock();
+
+	// the latest periods are the most likely to be used again
+	std::vector<Period *>::reverse_iterator it;
+	for (it = periods.rbegin(); it != periods.rend(); it++)
+	{
+		if (time >= (*it)->begin && time < (*it)->end)
+		{
+			break;
+		}
+	}
+
+	Period * p = 0;
+	if (it != periods.rend())
+	{
+		p = *it;
+		period = *p;
+	}
+	else
+	{
+		computePeriod(time, period);
+		if (periods.size() < MAX_PERIODS)
+		{
+			p = new Period(period);
+			periods.push_back(p);
+		}
+	}
+
+	if (p != 0)
+	{
+		// the exchange makes the period visible to the other threads
+		// before the pointer
+		Interlocked::compareExchange((void * volatile *)&current, (void *)p,
+			(void *)current);
+	}
+
+	periodsCs.unlock();
+}
+
+void TimeZone::computePeriod(int64 time, Period& period) const
+{
+	size_t count = transitionTimes.size();
+
+	if (count == 0 || time >= transitionTimes[count - 1])
+	{
+		if (hasRule)
+		{
+			computeRulePeriod(time, period);
+		}
+		else
+		{
+			const LocalTimeType * type = 0;
+			if (count > 0)
+			{
+				type = &localTimeTypes[transitionTypes[count - 1]];
+			}
+			else if (!localTimeTypes.empty())
+			{
+				type = &localTimeTypes[0];
+			}
+
+			period.begin = MIN_TIME;
+			period.end = MAX_TIME;
+			period.offset = (type != 0) ? type->offset : 0;
+			period.isDst = (type != 0) ? type->isDst : false;
+			period.name = (type != 0) ? type->name : (int)NO_NAME;
+		}
+
+		if (count > 0 && period.begin < transitionTimes[count - 1])
+		{
+			period.begin = transitionTimes[count - 1];
+		}
+	}
+	else if (time < transitionTimes[0])
+	{
+		// the first local time type is used before the first transition
+		period.begin = MIN_TIME;
+		period.end = transitionTimes[0];
+		period.offset = localTimeTypes[0].offset;
+		period.isDst = localTimeTypes[0].isDst;
+		period.name = localTimeTypes[0].name;
+	}
+	else
+	{
+		std::vector<int64>::const_iterator next = std::upper_bound(
+			transitionTimes.begin(), transitionTimes.end(), time);
+		size_t i = (next - transitionTimes.begin()) - 1;
+		const LocalTimeType& type = localTimeTypes[transitionTypes[i]];
+		period.begin = transitionTimes[i];
+		period.end = *next;
+		period.offset = type.offset;
+		period.isDst = type.isDst;
+		period.name = type.name;
+	}
+}
+
+void TimeZone::computeRulePeriod(int64 time, Period& period) const
+{
+	period.begin = MIN_TIME;
+	period.end = MAX_TIME;
+	period.offset = stdOffset;
+	period.isDst = false;
+	period.name = stdName;
+
+	if (!hasDst)
+	{
+		return;
+	}
+
+	// the transitions of the previous, current and next years, the
+	// start of daylight time being in local standard time and its end
+	// in local daylight time
+	int64 year = yearFromDays(floorDiv(time + stdOffset, SECONDS_PER_DAY));
+	std::vector< std::pair<int64, bool> > transitions;
+	for (int64 y = year - 1; y <= year + 1; y++)
+	{
+		int64 yearStart = daysFromCivil(y, 1, 1) * SECONDS_PER_DAY;
+		transitions.push_back(std::pair<int64, bool>(
+			yearStart + getRuleTime((int)y, dstStart) - stdOffset, true));
+		transitions.push_back(std::pair<int64, bool>(
+			yearStart + getRuleTime((int)y, dstEnd) - dstOffset, false));
+	}
+	std::sort(transitions.begin(), transitions.end());
+
+	for (size_t i = 0; i < transitions.size(); i++)
+	{
+		if (transitions[i].first > time)
+		{
+			period.end = transitions[i].first;
+			break;
+		}
+
+		period.begin = transitions[i].first;
+		period.isDst = transitions[i].second;
+		period.offset = period.isDst ? dstOffset : stdOffset;
+		period.name = period.isDst ? dstName : stdName;
+	}
+}
+
+int64 TimeZone::getRuleTime(int year, const RuleDate& date)
+{
+	int64 dayOfYear;
+	switch (date.type)
+	{
+	case 'J':
+		dayOfYear = date.day - 1
+			+ ((isLeapYear(year) && date.day >= 60) ? 1 : 0);
+		break;
+
+	case 'M':
+		{
+			static const int monthLengths[] =
+				{ 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+			// first day of the month, 01.01.1970 being a thursday
+			int64 firstDay = daysFromCivil(year, date.month, 1);
+			int weekDay = (int)(((firstDay % 7) + 7 + 4) % 7);
+			int day = 1 + (date.day - weekDay + 7) % 7 + (date.week - 1) * 7;
+			int length = monthLengths[date.month - 1]
+				+ ((date.month == 2 && isLeapYear(year)) ? 1 : 0);
+			if (day > length)
+			{
+				day -= 7;
+			}
+
+			dayOfYear = firstDay - daysFromCivil(year, 1, 1) + day - 1;
+		}
+		break;
+
+	default:
+		dayOfYear = date.day;
+		break;
+	}
+
+	return dayOfYear * SECONDS_PER_DAY + date.time;
+}
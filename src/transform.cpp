@@ -16,6 +16,12 @@
 
 #include <log4cxx/helpers/transform.h>
 
+#if !defined(UNICODE) && (defined(__SSE2__) || defined(_M_X64) \
+	|| (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define LOG4CXX_SSE2
+#endif
+
 using namespace log4cxx::helpers;
 
 tstring Transform::CDATA_START  = _T("<![CDATA[");
@@ -91,3 +97,170 @@ void Transform::appendEscapingCDATA(
 	buf << input.substr(start);
 }
 
+
+/** Returns true if appendSanitized copies c as is. */
+static inline bool isSafe(TCHAR c)
+{
+#ifdef UNICODE
+	return (c >= 0x20 && c != 0x7F) || c == _T('\t');
+#else
+	unsigned char b = (unsigned char)c;
+	return (b >= 0x20 && b < 0x7F) || b == '\t';
+#endif
+}
+
+size_t Transform::scanSafe(const TCHAR * input, size_t length)
+{
+	size_t i = 0;
+
+#ifdef LOG4CXX_SSE2
+	// as signed bytes, the control characters and the bytes of the
+	// multibyte sequences are lower than the space, except DEL
+	const __m128i space = _mm_set1_epi8(0x20);
+	const __m128i del = _mm_set1_epi8(0x7F);
+	const __m128i tab = _mm_set1_epi8('\t');
+
+	for (; i + 32 <= length; i += 32)
+	{
+		__m128i a = _mm_loadu_si128((const __m128i *)(input + i));
+		__m128i b = _mm_loadu_si128((const __m128i *)(input + i + 16));
+		__m128i unsafeA = _mm_andnot_si128(_mm_cmpeq_epi8(a, tab),
+			_mm_or_si128(_mm_cmplt_epi8(a, space), _mm_cmpeq_epi8(a, del)));
+		__m128i unsafeB = _mm_andnot_si128(_mm_cmpeq_epi8(b, tab),
+			_mm_or_si128(_mm_cmplt_epi8(b, space), _mm_cmpeq_epi8(b, del)));
+
+		if (_mm_movemask_epi8(_mm_or_si128(unsafeA, unsafeB)) != 0)
+		{
+			// the scalar loop finds the character
+			break;
+		}
+	}
+#endif
+
+	for (; i < length; i++)
+	{
+		if (!isSafe(input[i]))
+		{
+			return i;
+		}
+	}
+
+	return length;
+}
+
+#ifndef UNICODE
+/**
+Returns the length of the valid UTF-8 sequence starting at p or, if it
+is invalid, minus the length of its longest valid prefix, which is
+replaced by a single U+FFFD.
+*/
+static int sequenceLength(const unsigned char * p, const unsigned char * end)
+{
+	int length;
+	unsigned char low = 0x80, high = 0xBF;
+
+	if (*p >= 0xC2 && *p <= 0xDF)
+	{
+		length = 2;
+	}
+	else if (*p >= 0xE0 && *p <= 0xEF)
+	{
+		// no overlong forms nor surrogates
+		length = 3;
+		if (*p == 0xE0)
+		{
+			low = 0xA0;
+		}
+		else if (*p == 0xED)
+		{
+			high = 0x9F;
+		}
+	}
+	else if (*p >= 0xF0 && *p <= 0xF4)
+	{
+		// no overlong forms nor code points above U+10FFFF
+		length = 4;
+		if (*p == 0xF0)
+		{
+			low = 0x90;
+		}
+		else if (*p == 0xF4)
+		{
+			high = 0x8F;
+		}
+	}
+	else
+	{
+		return -1;
+	}
+
+	for (int i = 1; i < length; i++)
+	{
+		if (p + i == end || p[i] < low || p[i] > high)
+		{
+			return -i;
+		}
+
+		low = 0x80;
+		high = 0xBF;
+	}
+
+	return length;
+}
+#endif
+
+void Transform::appendSanitized(
+	tostream& buf, const tstring& input)
+{
+	const TCHAR * p = input.data();
+	const TCHAR * end = p + input.length();
+
+	while (p != end)
+	{
+		size_t safe = scanSafe(p, end - p);
+		buf.write(p, safe);
+		p += safe;
+
+		if (p == end)
+		{
+			return;
+		}
+
+		TCHAR ch = *p;
+#ifndef UNICODE
+		if ((unsigned char)ch >= 0x80)
+		{
+			int length = sequenceLength((const unsigned char *)p,
+				(const unsigned char *)end);
+			if (length > 0)
+			{
+				buf.write(p, length);
+				p += length;
+			}
+			else
+			{
+				buf << "\xEF\xBF\xBD";
+				p -= length;
+			}
+			continue;
+		}
+#endif
+
+		if (ch == _T('\r'))
+		{
+			buf << _T("\\r");
+		}
+		else if (ch == _T('\n'))
+		{
+			buf << _T("\\n");
+		}
+		else
+		{
+			static const TCHAR digits[] = _T("0123456789ABCDEF");
+			TCHAR escape[] = { _T('\\'), _T('x'),
+				digits[(ch >> 4) & 0xF], digits[ch & 0xF] };
+			buf.write(escape, 4);
+		}
+		p++;
+	}
+}
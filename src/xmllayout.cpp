@@ -30,6 +30,38 @@ using namespace log4cxx::xml;
 
 tstring XMLLayout::LOCATION_INFO_OPTION = _T("LocationInfo");
 
+/** Names of the types of the fields. */
+static const TCHAR * fieldTypes[] =
+{
+	_T("int64"), _T("double"), _T("string"), _T("bool")
+};
+
+/** Writes <code>input</code> as the value of an attribute. */
+static void appendEscapingAttribute(tostream& buf, const tstring& input)
+{
+	tstring::const_iterator it;
+	for (it = input.begin(); it != input.end(); it++)
+	{
+		switch (*it)
+		{
+		case _T('<'):
+			buf << _T("&lt;");
+			break;
+		case _T('>'):
+			buf << _T("&gt;");
+			break;
+		case _T('&'):
+			buf << _T("&amp;");
+			break;
+		case _T('"'):
+			buf << _T("&quot;");
+			break;
+		default:
+			buf << *it;
+		}
+	}
+}
+
 XMLLayout::XMLLayout()
 : locationInfo(false)
 {
@@ -86,6 +118,27 @@ void XMLLayout::format(tostream& output, const spi::LoggingEvent& event)
 		output << _T("\"/>\r\n");
 	}
 
+	const Fields& fields = event.getFields();
+	if (fields.size() != 0)
+	{
+		output << _T("<log4cxx:properties>\r\n");
+		for (int i = 0; i < fields.size(); i++)
+		{
+			const Field& field = fields[i];
+			tostringstream value;
+			field.format(value);
+
+			output << _T("<log4cxx:data name=\"");
+			appendEscapingAttribute(output,
+				tstring(field.name, field.nameLength));
+			output << _T("\" type=\"") << fieldTypes[field.type];
+			output << _T("\" value=\"");
+			appendEscapingAttribute(output, value.str());
+			output << _T("\"/>\r\n");
+		}
+		output << _T("</log4cxx:properties>\r\n");
+	}
+
 	output << _T("</log4cxx:event>\r\n\r\n");
 //	output << _T("</event>\r\n\r\n");
 }
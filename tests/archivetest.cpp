@@ -0,0 +1,216 @@
+/***************************************************************************
+                          archivetest.cpp  -  tests of the log archives
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/helpers/archivewriter.h>
+#include <log4cxx/helpers/archivereader.h>
+#include <log4cxx/helpers/thread.h>
+#include <log4cxx/spi/loggingevent.h>
+#include <log4cxx/logger.h>
+#include <log4cxx/level.h>
+#include <stdio.h>
+#include "check.h"
+
+using namespace log4cxx;
+using namespace log4cxx::helpers;
+using namespace log4cxx::spi;
+
+static const TCHAR * fileName = _T("archivetest.tmp");
+
+/** Gives access to the encodings of the last block read. */
+class EncodingReader : public ArchiveReader
+{
+public:
+	int getEncoding(int column) const
+		{ return encodings[column]; }
+};
+
+/** Writes an event of <code>loggerName</code> to <code>writer</code>. */
+static void write(ArchiveWriter& writer, const tstring& loggerName,
+	const Level& level, const tstring& message)
+{
+	LoggingEvent event(Logger::getLogger(loggerName), level, message);
+	writer.write(event);
+}
+
+/** Returns the events of the archive matching <code>query</code>. */
+static std::vector<ArchiveReader::Record> scan(ArchiveReader& reader,
+	const ArchiveReader::Query& query)
+{
+	std::vector<ArchiveReader::Record> records;
+	CHECK(reader.open(fileName));
+	CHECK(reader.scan(query, records));
+	return records;
+}
+
+/**
+Writes events of several loggers and levels in blocks of four events,
+and reads them back with and without filters.
+*/
+void testRoundTrip()
+{
+	static const TCHAR * loggers[] = { _T("db.pool"), _T("http"), _T("db") };
+	const Level * levels[] = { &Level::INFO, &Level::WARN, &Level::ERROR };
+	const int count = 10;
+
+	ArchiveWriter writer;
+	writer.setBlockSize(4);
+	CHECK(writer.open(fileName, false));
+	for (int i = 0; i < count; i++)
+	{
+		tostringstream message;
+		message << _T("event ") << i;
+		write(writer, loggers[i % 3], *levels[i % 3], message.str());
+	}
+	writer.close();
+
+	ArchiveReader reader;
+	ArchiveReader::Query query;
+	std::vector<ArchiveReader::Record> records = scan(reader, query);
+	CHECK(records.size() == (size_t)count);
+	CHECK(reader.getBlocksRead() == 3);
+	CHECK(reader.getBlocksSkipped() == 0);
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		tostringstream message;
+		message << _T("event ") << i;
+		CHECK(records[i].message == message.str());
+		CHECK(records[i].loggerName == loggers[i % 3]);
+		CHECK(records[i].level == levels[i % 3]->toInt());
+		CHECK(records[i].threadId == Thread::getCurrentThreadId());
+		CHECK(i == 0 || records[i].timeStamp >= records[i - 1].timeStamp);
+	}
+
+	query.minLevel = Level::WARN.toInt();
+	CHECK(scan(reader, query).size() == 6);
+
+	// db is in every block, db.pool is not its prefix
+	query.minLevel = ArchiveReader::Query().minLevel;
+	query.loggerName = _T("db");
+	records = scan(reader, query);
+	CHECK(records.size() == 3);
+	CHECK(records.size() == 3 && records[0].message == _T("event 2"));
+
+	// only the columns asked for are returned
+	query.loggerName = _T("http");
+	query.columns = ArchiveReader::MESSAGE;
+	records = scan(reader, query);
+	CHECK(records.size() == 3);
+	CHECK(records.size() == 3 && records[0].message == _T("event 1")
+		&& records[0].loggerName.empty());
+
+	// an appended archive keeps its header and its blocks
+	CHECK(writer.open(fileName, true));
+	write(writer, _T("http"), Level::INFO, _T("appended"));
+	writer.close();
+	records = scan(reader, ArchiveReader::Query());
+	CHECK(records.size() == (size_t)count + 1);
+	CHECK(records.back().message == _T("appended"));
+}
+
+/** Checks that the blocks out of the range or without the logger of a
+query are skipped. */
+void testSkippedBlocks()
+{
+	ArchiveWriter writer;
+	writer.setBlockSize(4);
+	CHECK(writer.open(fileName, false));
+	for (int i = 0; i < 4; i++)
+	{
+		write(writer, _T("early"), Level::INFO, _T("early"));
+	}
+	Thread::sleep(5);
+	for (int i = 0; i < 4; i++)
+	{
+		write(writer, _T("late"), Level::INFO, _T("late"));
+	}
+	writer.close();
+
+	ArchiveReader reader;
+	ArchiveReader::Query query;
+	std::vector<ArchiveReader::Record> records = scan(reader, query);
+	CHECK(records.size() == 8);
+	if (records.size() != 8)
+	{
+		return;
+	}
+
+	query.from = records[4].timeStamp;
+	records = scan(reader, query);
+	CHECK(records.size() == 4);
+	CHECK(reader.getBlocksRead() == 1);
+	CHECK(reader.getBlocksSkipped() == 1);
+
+	query = ArchiveReader::Query();
+	query.loggerName = _T("late");
+	records = scan(reader, query);
+	CHECK(records.size() == 4);
+	CHECK(reader.getBlocksRead() == 1);
+	CHECK(reader.getBlocksSkipped() == 1);
+
+	query.loggerName = _T("other");
+	CHECK(scan(reader, query).empty());
+}
+
+/**
+Checks that columns which do not compress are stored raw, and the others
+deflated when zlib is available.
+*/
+void testEncodings()
+{
+	ArchiveWriter writer;
+	CHECK(writer.open(fileName, false));
+	write(writer, _T("db"), Level::INFO, _T("x"));
+	writer.close();
+
+	EncodingReader reader;
+	std::vector<ArchiveReader::Record> records =
+		scan(reader, ArchiveReader::Query());
+	CHECK(records.size() == 1);
+	for (int column = 0; column < ArchiveWriter::COLUMN_COUNT; column++)
+	{
+		CHECK(reader.getEncoding(column) == ArchiveWriter::RAW);
+	}
+
+	const tstring message(200, _T('m'));
+	CHECK(writer.open(fileName, false));
+	for (int i = 0; i < 100; i++)
+	{
+		write(writer, _T("db"), Level::INFO, message);
+	}
+	writer.close();
+
+	records = scan(reader, ArchiveReader::Query());
+	CHECK(records.size() == 100);
+	CHECK(records.size() == 100 && records[99].message == message);
+#ifdef HAVE_LIBZ
+	CHECK(reader.getEncoding(4) == ArchiveWriter::DEFLATE);
+#else
+	CHECK(reader.getEncoding(4) == ArchiveWriter::RAW);
+#endif
+}
+
+int main()
+{
+	USES_CONVERSION;
+
+	testRoundTrip();
+	testSkippedBlocks();
+	testEncodings();
+
+	remove(T2A(fileName));
+
+	return CHECK_STATUS();
+}
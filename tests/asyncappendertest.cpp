@@ -0,0 +1,334 @@
+/***************************************************************************
+                          asyncappendertest.cpp  -  tests of AsyncAppender
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/asyncappender.h>
+#include <log4cxx/logger.h>
+#include <log4cxx/level.h>
+#include <log4cxx/spi/loggingevent.h>
+#include <log4cxx/helpers/thread.h>
+#include <log4cxx/helpers/semaphore.h>
+#include <vector>
+#include "check.h"
+
+using namespace log4cxx;
+using namespace log4cxx::helpers;
+using namespace log4cxx::spi;
+
+/** Keeps the messages it receives, slowly from time to time. */
+class RecordingAppender : public AppenderSkeleton
+{
+public:
+	RecordingAppender(int slowEvery) : slowEvery(slowEvery) {}
+
+	void append(const LoggingEvent& event)
+	{
+		messages.push_back(event.getRenderedMessage());
+		if (slowEvery > 0 && messages.size() % slowEvery == 0)
+		{
+			Thread::sleep(1);
+		}
+	}
+
+	void close() {}
+	bool requiresLayout() { return false; }
+
+	int slowEvery;
+	std::vector<tstring> messages;
+};
+
+/** Waits in append until the test opens the gate. */
+class GatedAppender : public RecordingAppender
+{
+public:
+	GatedAppender() : RecordingAppender(0) {}
+
+	void append(const LoggingEvent& event)
+	{
+		entered.post();
+		gate.wait();
+		RecordingAppender::append(event);
+	}
+
+	Semaphore entered;
+	Semaphore gate;
+};
+
+/** Logs the numbers 0 to count - 1, prefixed by its index. */
+class Producer : public Runnable, public ObjectImpl
+{
+public:
+	Producer(const LoggerPtr& logger, int index, int count, Semaphore& done)
+	: logger(logger), index(index), count(count), done(done)
+	{
+	}
+
+	void run()
+	{
+		for (int i = 0; i < count; i++)
+		{
+			tostringstream message;
+			message << index << _T(" ") << i;
+			logger->info(message.str());
+		}
+		done.post();
+	}
+
+	LoggerPtr logger;
+	int index;
+	int count;
+	Semaphore& done;
+};
+
+/**
+Logs from several threads through an AsyncAppender and checks that each
+thread's events all arrive, in the order they were logged.
+*/
+void testOrdering(bool hybrid, AsyncAppender::WaitStrategy waitStrategy)
+{
+	const int threads = 4;
+	const int count = 2000;
+
+	RecordingAppender * recorder = new RecordingAppender(97);
+	AppenderPtr recorderPtr = recorder;
+
+	AsyncAppender * async = new AsyncAppender();
+	AppenderPtr asyncPtr = async;
+	async->setBufferSize(16);
+	async->setHybrid(hybrid);
+	async->setWaitStrategy(waitStrategy);
+	async->addAppender(recorderPtr);
+	async->activateOptions();
+
+	LoggerPtr logger = Logger::getLogger(_T("asyncappendertest"));
+	logger->setLevel(Level::INFO);
+	logger->setAdditivity(false);
+	logger->addAppender(asyncPtr);
+
+	Semaphore done;
+	for (int t = 0; t < threads; t++)
+	{
+		Thread * thread = new Thread(new Producer(logger, t, count, done));
+		thread->start();
+	}
+	for (int t = 0; t < threads; t++)
+	{
+		done.wait();
+	}
+
+	logger->removeAppender(asyncPtr);
+	async->close();
+
+	CHECK(recorder->messages.size() == (size_t)(threads * count));
+
+	std::vector<int> next(threads, 0);
+	for (size_t m = 0; m < recorder->messages.size(); m++)
+	{
+		std::basic_istringstream<TCHAR> message(recorder->messages[m]);
+		int index = -1, i = -1;
+		message >> index >> i;
+		CHECK(index >= 0 && index < threads);
+		if (index >= 0 && index < threads)
+		{
+			CHECK(i == next[index]);
+			next[index] = i + 1;
+		}
+	}
+}
+
+/** Returns the statistics of the sink of <code>name</code>. */
+static bool findSink(AsyncAppender * async, const tstring& name,
+	AsyncAppender::SinkStatistics& statistics)
+{
+	std::vector<AsyncAppender::SinkStatistics> all =
+		async->getSinkStatistics();
+	for (size_t i = 0; i < all.size(); i++)
+	{
+		if (all[i].appenderName == name)
+		{
+			statistics = all[i];
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+Waits at most two seconds for the sink of <code>name</code> to have
+written and discarded <code>events</code> events.
+*/
+static bool waitForSink(AsyncAppender * async, const tstring& name,
+	long events)
+{
+	AsyncAppender::SinkStatistics statistics;
+	for (int i = 0; i < 2000; i++)
+	{
+		if (findSink(async, name, statistics) &&
+			statistics.written + statistics.discarded +
+			statistics.pending >= events)
+		{
+			return true;
+		}
+		Thread::sleep(1);
+	}
+	return false;
+}
+
+/** Logs the numbers first to last - 1. */
+static void logNumbers(const LoggerPtr& logger, int first, int last)
+{
+	for (int i = first; i < last; i++)
+	{
+		tostringstream message;
+		message << i;
+		logger->info(message.str());
+	}
+}
+
+/**
+In fan-out mode, fills the queue of an appender blocked in append and
+checks which events its overflow policy keeps, while an appender with
+the default policy receives them all.
+*/
+void testOverflowPolicy(AsyncAppender::OverflowPolicy policy)
+{
+	const int count = 10;
+
+	GatedAppender * slow = new GatedAppender();
+	AppenderPtr slowPtr = slow;
+	slow->setName(_T("slow"));
+	RecordingAppender * fast = new RecordingAppender(0);
+	AppenderPtr fastPtr = fast;
+	fast->setName(_T("fast"));
+
+	AsyncAppender * async = new AsyncAppender();
+	AppenderPtr asyncPtr = async;
+	async->setFanOut(true);
+	async->setSinkBufferSize(2);
+	async->setOption(_T("OverflowPolicy.slow"),
+		policy == AsyncAppender::DISCARD_NEWEST ?
+		_T("DiscardNewest") : _T("DiscardOldest"));
+	async->addAppender(slowPtr);
+	async->addAppender(fastPtr);
+	async->activateOptions();
+
+	LoggerPtr logger = Logger::getLogger(_T("asyncappendertest.fanout"));
+	logger->setLevel(Level::INFO);
+	logger->setAdditivity(false);
+	logger->addAppender(asyncPtr);
+
+	// the first event is taken by the sink, which then waits in append
+	logNumbers(logger, 0, 1);
+	slow->entered.wait();
+	logNumbers(logger, 1, count);
+
+	CHECK(waitForSink(async, _T("slow"), count - 1));
+	AsyncAppender::SinkStatistics statistics;
+	CHECK(findSink(async, _T("slow"), statistics));
+	CHECK(statistics.pending == 2);
+	CHECK(statistics.highWaterMark == 2);
+	CHECK(statistics.discarded == count - 3);
+
+	for (int i = 0; i < count; i++)
+	{
+		slow->gate.post();
+	}
+	logger->removeAppender(asyncPtr);
+	async->close();
+
+	CHECK(fast->messages.size() == (size_t)count);
+	CHECK(slow->messages.size() == 3);
+	if (slow->messages.size() == 3)
+	{
+		bool newest = (policy == AsyncAppender::DISCARD_NEWEST);
+		CHECK(slow->messages[0] == _T("0"));
+		CHECK(slow->messages[1] == (newest ? _T("1") : _T("8")));
+		CHECK(slow->messages[2] == (newest ? _T("2") : _T("9")));
+	}
+	CHECK(async->getSinkStatistics().empty());
+}
+
+/**
+Removes the appenders of an AsyncAppender in fan-out mode and checks
+that their queues are written and dropped from the statistics.
+*/
+void testRemoveAppender()
+{
+	const int count = 100;
+
+	RecordingAppender * first = new RecordingAppender(7);
+	AppenderPtr firstPtr = first;
+	first->setName(_T("first"));
+	RecordingAppender * second = new RecordingAppender(0);
+	AppenderPtr secondPtr = second;
+	second->setName(_T("second"));
+
+	AsyncAppender * async = new AsyncAppender();
+	AppenderPtr asyncPtr = async;
+	async->setFanOut(true);
+	async->setSinkBufferSize(4);
+	async->addAppender(firstPtr);
+	async->addAppender(secondPtr);
+	async->activateOptions();
+
+	LoggerPtr logger = Logger::getLogger(_T("asyncappendertest.remove"));
+	logger->setLevel(Level::INFO);
+	logger->setAdditivity(false);
+	logger->addAppender(asyncPtr);
+
+	logNumbers(logger, 0, count);
+	CHECK(waitForSink(async, _T("first"), count));
+	CHECK(async->getSinkStatistics().size() == 2);
+
+	// the events queued for the appender are written before it is removed
+	async->removeAppender(_T("first"));
+	CHECK(first->messages.size() == (size_t)count);
+	AsyncAppender::SinkStatistics statistics;
+	CHECK(!findSink(async, _T("first"), statistics));
+	CHECK(findSink(async, _T("second"), statistics));
+
+	logNumbers(logger, count, 2 * count);
+	CHECK(waitForSink(async, _T("second"), 2 * count));
+	async->removeAllAppenders();
+	CHECK(async->getSinkStatistics().empty());
+	CHECK(first->messages.size() == (size_t)count);
+	CHECK(second->messages.size() == (size_t)(2 * count));
+
+	logger->removeAppender(asyncPtr);
+	async->close();
+}
+
+int main()
+{
+	static const AsyncAppender::WaitStrategy strategies[] =
+	{
+		AsyncAppender::BLOCK,
+		AsyncAppender::SPIN,
+		AsyncAppender::YIELD,
+		AsyncAppender::PARK
+	};
+
+	for (int s = 0; s < 4; s++)
+	{
+		testOrdering(false, strategies[s]);
+		testOrdering(true, strategies[s]);
+	}
+
+	testOverflowPolicy(AsyncAppender::DISCARD_NEWEST);
+	testOverflowPolicy(AsyncAppender::DISCARD_OLDEST);
+	testRemoveAppender();
+
+	return CHECK_STATUS();
+}
@@ -0,0 +1,37 @@
+/***************************************************************************
+                          check.h  -  checks of the test programs
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#ifndef _LOG4CXX_TESTS_CHECK_H
+#define _LOG4CXX_TESTS_CHECK_H
+
+#include <iostream>
+
+/** Number of failed checks of the test program. */
+static int failures = 0;
+
+/** Reports <code>condition</code> with its line if it is false. */
+#define CHECK(condition) \
+	if (!(condition)) \
+	{ \
+		std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " \
+			<< #condition << std::endl; \
+		failures++; \
+	}
+
+/** Exit status of the test program. */
+#define CHECK_STATUS() (failures == 0 ? 0 : 1)
+
+#endif //_LOG4CXX_TESTS_CHECK_H
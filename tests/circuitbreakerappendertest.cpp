@@ -0,0 +1,239 @@
+/***************************************************************************
+                          circuitbreakerappendertest.cpp  -  tests of CircuitBreakerAppender
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+
+#include <log4cxx/circuitbreakerappender.h>
+#include <log4cxx/logger.h>
+#include <log4cxx/level.h>
+#include <log4cxx/spi/loggingevent.h>
+#include <log4cxx/helpers/exception.h>
+#include <log4cxx/helpers/thread.h>
+#include <log4cxx/helpers/semaphore.h>
+#include <log4cxx/helpers/interlocked.h>
+#include <vector>
+#include "check.h"
+
+using namespace log4cxx;
+using namespace log4cxx::helpers;
+using namespace log4cxx::spi;
+
+/** Keeps the messages it receives, or throws while it is failing. */
+class FailingAppender : public AppenderSkeleton
+{
+public:
+	FailingAppender() : failing(false) {}
+
+	void append(const LoggingEvent& event)
+	{
+		if (failing)
+		{
+			throw IllegalArgumentException(_T("disk full"));
+		}
+		messages.push_back(event.getRenderedMessage());
+	}
+
+	void close() {}
+	bool requiresLayout() { return false; }
+
+	bool failing;
+	std::vector<tstring> messages;
+};
+
+/** Counts the events it receives. */
+class CountingAppender : public AppenderSkeleton
+{
+public:
+	CountingAppender() : count(0) {}
+
+	void append(const LoggingEvent&)
+	{
+		Interlocked::increment(&count);
+	}
+
+	void close() {}
+	bool requiresLayout() { return false; }
+
+	volatile long count;
+};
+
+/**
+Makes the protected appender fail, and checks that the circuit breaker
+trips, diverts the events to the backup appender, probes the protected
+appender and is reset once it has recovered.
+*/
+void testTripProbeAndRecovery()
+{
+	FailingAppender * primary = new FailingAppender();
+	AppenderPtr primaryPtr = primary;
+	primary->setName(_T("primary"));
+	FailingAppender * backup = new FailingAppender();
+	AppenderPtr backupPtr = backup;
+	backup->setName(_T("backup"));
+
+	CircuitBreakerAppender * breaker = new CircuitBreakerAppender();
+	AppenderPtr breakerPtr = breaker;
+	breaker->setName(_T("breaker"));
+	breaker->setOption(_T("FailureThreshold"), _T("2"));
+	breaker->setOption(_T("ProbeInterval"), _T("30"));
+	breaker->addAppender(primaryPtr);
+	breaker->addAppender(backupPtr);
+	CHECK(breaker->getAppender() == primaryPtr);
+	CHECK(breaker->getBackupAppender() == backupPtr);
+
+	LoggerPtr logger = Logger::getLogger(_T("circuitbreakerappendertest"));
+	logger->setLevel(Level::INFO);
+	logger->setAdditivity(false);
+	logger->addAppender(breakerPtr);
+
+	logger->info(_T("a"));
+	CHECK(!breaker->isTripped());
+
+	// each failed event is diverted, and the breaker trips on the
+	// second consecutive failure
+	primary->failing = true;
+	logger->info(_T("b"));
+	CHECK(!breaker->isTripped());
+	logger->info(_T("c"));
+	CHECK(breaker->isTripped());
+	CHECK(breaker->getTripCount() == 1);
+
+	// no probe before the probe interval elapses
+	logger->info(_T("d"));
+
+	// a probe which fails keeps the breaker tripped
+	Thread::sleep(60);
+	logger->info(_T("e"));
+	CHECK(breaker->isTripped());
+
+	// a probe which succeeds resets the breaker
+	primary->failing = false;
+	Thread::sleep(60);
+	logger->info(_T("f"));
+	CHECK(!breaker->isTripped());
+	logger->info(_T("g"));
+
+	CHECK(breaker->getTripCount() == 1);
+	CHECK(breaker->getDivertedCount() == 4);
+	CHECK(breaker->getDroppedCount() == 0);
+
+	// without a backup appender, the events are dropped
+	breaker->removeAppender(backupPtr);
+	CHECK(breaker->getBackupAppender() == 0);
+	breaker->setOption(_T("FailureThreshold"), _T("1"));
+	primary->failing = true;
+	logger->info(_T("h"));
+	CHECK(breaker->isTripped());
+	CHECK(breaker->getTripCount() == 2);
+	CHECK(breaker->getDroppedCount() == 1);
+
+	logger->removeAllAppenders();
+
+	CHECK(primary->messages.size() == 3);
+	if (primary->messages.size() == 3)
+	{
+		CHECK(primary->messages[0] == _T("a"));
+		CHECK(primary->messages[1] == _T("f"));
+		CHECK(primary->messages[2] == _T("g"));
+	}
+
+	CHECK(backup->messages.size() == 4);
+	if (backup->messages.size() == 4)
+	{
+		CHECK(backup->messages[0] == _T("b"));
+		CHECK(backup->messages[1] == _T("c"));
+		CHECK(backup->messages[2] == _T("d"));
+		CHECK(backup->messages[3] == _T("e"));
+	}
+}
+
+/** Logs count events. */
+class Producer : public Runnable, public ObjectImpl
+{
+public:
+	Producer(const LoggerPtr& logger, int count, Semaphore& done)
+	: logger(logger), count(count), done(done)
+	{
+	}
+
+	void run()
+	{
+		for (int i = 0; i < count; i++)
+		{
+			logger->info(_T("event"));
+		}
+		done.post();
+	}
+
+	LoggerPtr logger;
+	int count;
+	Semaphore& done;
+};
+
+/**
+Replaces the appenders of the circuit breaker while other threads log,
+and checks that every event reaches one of them.
+*/
+void testReplacement()
+{
+	const int threads = 4;
+	const int count = 20000;
+
+	CountingAppender * first = new CountingAppender();
+	AppenderPtr firstPtr = first;
+	CountingAppender * second = new CountingAppender();
+	AppenderPtr secondPtr = second;
+
+	CircuitBreakerAppender * breaker = new CircuitBreakerAppender();
+	AppenderPtr breakerPtr = breaker;
+	breaker->setAppender(firstPtr);
+
+	LoggerPtr logger =
+		Logger::getLogger(_T("circuitbreakerappendertest.replacement"));
+	logger->setLevel(Level::INFO);
+	logger->setAdditivity(false);
+	logger->addAppender(breakerPtr);
+
+	Semaphore done;
+	for (int t = 0; t < threads; t++)
+	{
+		Thread * thread = new Thread(new Producer(logger, count, done));
+		thread->start();
+	}
+
+	for (int i = 0; i < 2000; i++)
+	{
+		breaker->setAppender((i % 2 == 0) ? secondPtr : firstPtr);
+		breaker->setBackupAppender((i % 3 == 0) ? secondPtr : 0);
+	}
+
+	for (int t = 0; t < threads; t++)
+	{
+		done.wait();
+	}
+
+	logger->removeAllAppenders();
+
+	CHECK(first->count + second->count == threads * count);
+	CHECK(breaker->getDroppedCount() == 0);
+}
+
+int main()
+{
+	testTripProbeAndRecovery();
+	testReplacement();
+
+	return CHECK_STATUS();
+}
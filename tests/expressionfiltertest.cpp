@@ -0,0 +1,205 @@
+/***************************************************************************
+                          expressionfiltertest.cpp  -  tests of ExpressionFilter
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/varia/expressionfilter.h>
+#include <log4cxx/spi/loggingevent.h>
+#include <log4cxx/logger.h>
+#include <log4cxx/level.h>
+#include <log4cxx/ndc.h>
+#include <log4cxx/fields.h>
+#include "check.h"
+
+using namespace log4cxx;
+using namespace log4cxx::helpers;
+using namespace log4cxx::spi;
+using namespace log4cxx::varia;
+
+/** Returns the decision of a filter accepting on
+<code>expression</code>. */
+static int decide(const tstring& expression, const LoggingEvent& event)
+{
+	ExpressionFilterPtr filter = new ExpressionFilter();
+	filter->setExpression(expression);
+	filter->setAcceptOnMatch(true);
+	return filter->decide(event);
+}
+
+/** Returns true if <code>expression</code> is true for
+<code>event</code>. */
+static bool matches(const tstring& expression, const LoggingEvent& event)
+{
+	return decide(expression, event) == Filter::ACCEPT;
+}
+
+/** Returns the error reported by LogLog for <code>expression</code>,
+or an empty string. */
+static tstring compileError(const tstring& expression)
+{
+	tostringstream output;
+	std::basic_streambuf<TCHAR> * previous = tcerr.rdbuf(output.rdbuf());
+
+	ExpressionFilterPtr filter = new ExpressionFilter();
+	filter->setExpression(expression);
+
+	tcerr.rdbuf(previous);
+	return output.str();
+}
+
+/** Returns true if <code>expression</code> is reported as invalid
+with <code>message</code>. */
+static bool fails(const tstring& expression, const tstring& message)
+{
+	tstring error = compileError(expression);
+	tstring expected = _T("]: ") + message + _T(".");
+	size_t found = error.find(expected);
+	if (found == tstring::npos)
+	{
+		tcerr << _T("unexpected error for [") << expression << _T("]: ")
+			<< error << std::endl;
+	}
+	return found != tstring::npos;
+}
+
+void testLevels()
+{
+	LoggerPtr logger = Logger::getLogger(_T("db.pool"));
+	LoggingEvent warn(logger, Level::WARN, _T("slow query"));
+	LoggingEvent info(logger, Level::INFO, _T("connected"));
+
+	CHECK(matches(_T("level >= WARN"), warn));
+	CHECK(!matches(_T("level >= WARN"), info));
+	CHECK(matches(_T("level < warn"), info));
+	CHECK(matches(_T("level == 30000"), warn));
+	CHECK(matches(_T("level != ERROR"), warn));
+	CHECK(matches(_T("level > DEBUG && level <= WARN"), info));
+}
+
+void testStrings()
+{
+	LoggerPtr logger = Logger::getLogger(_T("db.pool"));
+
+	NDC::push(_T("request 42"));
+	LoggingEvent event(logger, Level::INFO, _T("query \"users\" timed out"));
+	event.getNDC();
+	NDC::pop();
+
+	CHECK(matches(_T("logger == \"db.pool\""), event));
+	CHECK(matches(_T("logger ^= \"db.\""), event));
+	CHECK(!matches(_T("logger ^= \"http.\""), event));
+	CHECK(matches(_T("logger $= \".pool\""), event));
+	CHECK(matches(_T("message ~= \"timed\""), event));
+	CHECK(matches(_T("message ~= \"\\\"users\\\"\""), event));
+	CHECK(matches(_T("ndc != \"request 43\""), event));
+	CHECK(matches(_T("ndc ~= \"42\""), event));
+	CHECK(matches(_T("message ~= \"\""), event));
+}
+
+void testFields()
+{
+	LoggerPtr logger = Logger::getLogger(_T("http"));
+	LoggingEvent event(logger, Level::INFO, _T("request served"),
+		Fields().add(_T("status"), 503).add(_T("latency"), 0.25)
+		.add(_T("tenant"), _T("acme")).add(_T("cached"), false));
+
+	CHECK(matches(_T("field.status >= 500"), event));
+	CHECK(matches(_T("field.latency > 0.2 && field.latency < .3"), event));
+	CHECK(matches(_T("field.tenant == \"acme\""), event));
+	CHECK(matches(_T("field.tenant ^= \"ac\""), event));
+	CHECK(matches(_T("field.cached == false"), event));
+	CHECK(matches(_T("field.cached"), event));
+	CHECK(matches(_T("mdc.tenant == \"acme\""), event));
+	CHECK(!matches(_T("field.user"), event));
+
+	// a missing field or one of another type is only different
+	CHECK(!matches(_T("field.status == \"503\""), event));
+	CHECK(matches(_T("field.status != \"503\""), event));
+	CHECK(!matches(_T("field.user == 1"), event));
+	CHECK(matches(_T("field.user != 1"), event));
+	CHECK(!matches(_T("field.tenant < 1"), event));
+}
+
+void testOperators()
+{
+	LoggerPtr logger = Logger::getLogger(_T("db.pool"));
+	LoggingEvent event(logger, Level::ERROR, _T("failed"),
+		Fields().add(_T("tenant"), _T("acme")));
+
+	CHECK(matches(_T("level >= WARN && logger ^= \"db.\" && field.tenant == \"acme\""),
+		event));
+	CHECK(matches(_T("!(level < ERROR) || field.tenant == \"other\""), event));
+	CHECK(matches(_T("!!(level == ERROR)"), event));
+	CHECK(!matches(_T("level == ERROR && !field.tenant"), event));
+	CHECK(matches(_T("(false || level == ERROR) && (true || field.x)"), event));
+	CHECK(!matches(_T("false && level == ERROR"), event));
+
+	// the decision depends on AcceptOnMatch, and is neutral otherwise
+	ExpressionFilterPtr filter = new ExpressionFilter();
+	filter->setOption(_T("Expression"), _T("level == ERROR"));
+	filter->setOption(_T("AcceptOnMatch"), _T("false"));
+	CHECK(filter->decide(event) == Filter::DENY);
+	CHECK(decide(_T("level == INFO"), event) == Filter::NEUTRAL);
+}
+
+void testErrors()
+{
+	CHECK(compileError(_T("level >= WARN")).empty());
+
+	CHECK(fails(_T("levle == WARN"),
+		_T("unknown attribute levle at position 0")));
+	CHECK(fails(_T("level @ WARN"), _T("unexpected @ at position 6")));
+	CHECK(fails(_T("level ~= \"x\""), _T("unexpected ~= at position 6")));
+	CHECK(fails(_T("level >= "),
+		_T("expected a level instead of end of expression at position 9")));
+	CHECK(fails(_T("level >= WARNING"),
+		_T("unknown level WARNING at position 9")));
+	CHECK(fails(_T("logger == db"),
+		_T("expected a string instead of db at position 10")));
+	CHECK(fails(_T("message ~= \"abc"),
+		_T("unterminated string at position 11")));
+	CHECK(fails(_T("(level > INFO"), _T("missing ) at position 13")));
+	CHECK(fails(_T("level == WARN &&"),
+		_T("unexpected end of expression at position 16")));
+	CHECK(fails(_T("level == WARN WARN"),
+		_T("unexpected WARN at position 14")));
+	CHECK(fails(_T("field.a < \"x\""),
+		_T("strings cannot be ordered at position 10")));
+	CHECK(fails(_T("field.n ^= 5"),
+		_T("numbers cannot be compared as strings at position 11")));
+	CHECK(fails(_T("field.b > true"),
+		_T("booleans can only be compared with == and != at position 10")));
+	CHECK(fails(_T("field.b == WARN"),
+		_T("expected a constant instead of WARN at position 11")));
+
+	// an invalid expression leaves the filter neutral
+	LoggerPtr logger = Logger::getLogger(_T("db.pool"));
+	LoggingEvent event(logger, Level::ERROR, _T("failed"));
+	tostringstream ignored;
+	std::basic_streambuf<TCHAR> * previous = tcerr.rdbuf(ignored.rdbuf());
+	int decision = decide(_T("level >="), event);
+	tcerr.rdbuf(previous);
+	CHECK(decision == Filter::NEUTRAL);
+}
+
+int main()
+{
+	testLevels();
+	testStrings();
+	testFields();
+	testOperators();
+	testErrors();
+
+	return CHECK_STATUS();
+}
@@ -0,0 +1,129 @@
+/***************************************************************************
+                          fallbackerrorhandlertest.cpp  -  tests of FallbackErrorHandler
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/varia/fallbackerrorhandler.h>
+#include <log4cxx/appenderskeleton.h>
+#include <log4cxx/logger.h>
+#include <log4cxx/level.h>
+#include <log4cxx/spi/loggingevent.h>
+#include <log4cxx/helpers/exception.h>
+#include <log4cxx/helpers/thread.h>
+#include <vector>
+#include "check.h"
+
+using namespace log4cxx;
+using namespace log4cxx::helpers;
+using namespace log4cxx::spi;
+using namespace log4cxx::varia;
+
+/** Keeps the messages it receives, or reports an error for each of them
+while it is failing. */
+class FailingAppender : public AppenderSkeleton
+{
+public:
+	FailingAppender() : failing(false) {}
+
+	void append(const LoggingEvent& event)
+	{
+		if (failing)
+		{
+			IllegalArgumentException e(_T("disk full"));
+			errorHandler->error(_T("could not write"), e, 0,
+				const_cast<LoggingEvent&>(event));
+			return;
+		}
+		messages.push_back(event.getRenderedMessage());
+	}
+
+	void close() {}
+	bool requiresLayout() { return false; }
+
+	bool failing;
+	std::vector<tstring> messages;
+};
+
+/**
+Makes an appender fail, and checks that its events go to the backup
+appender until a retry succeeds, and then to the appender again.
+*/
+void testRedirection()
+{
+	FailingAppender * primary = new FailingAppender();
+	AppenderPtr primaryPtr = primary;
+	primary->setName(_T("primary"));
+	FailingAppender * backup = new FailingAppender();
+	AppenderPtr backupPtr = backup;
+	backup->setName(_T("backup"));
+
+	FallbackErrorHandler * handler = new FallbackErrorHandler();
+	ErrorHandlerPtr handlerPtr = handler;
+	handler->setOption(_T("RetryInterval"), _T("20"));
+	handler->setAppender(primaryPtr);
+	handler->setBackupAppender(backupPtr);
+	primary->setErrorHandler(handlerPtr);
+
+	LoggerPtr logger = Logger::getLogger(_T("fallbackerrorhandlertest"));
+	logger->setLevel(Level::INFO);
+	logger->setAdditivity(false);
+	logger->addAppender(primaryPtr);
+
+	logger->info(_T("before"));
+	CHECK(!handler->isRedirected());
+
+	// the event which failed goes to the backup appender, and the next
+	// ones directly until the retry interval elapses
+	primary->failing = true;
+	logger->info(_T("failed"));
+	CHECK(handler->isRedirected());
+	logger->info(_T("redirected"));
+
+	// a retry which fails keeps the redirection
+	Thread::sleep(40);
+	logger->info(_T("retry failed"));
+	CHECK(handler->isRedirected());
+
+	// a retry which succeeds restores the appender
+	primary->failing = false;
+	Thread::sleep(40);
+	logger->info(_T("retry succeeded"));
+	CHECK(!handler->isRedirected());
+	logger->info(_T("restored"));
+
+	logger->removeAllAppenders();
+
+	CHECK(primary->messages.size() == 3);
+	if (primary->messages.size() == 3)
+	{
+		CHECK(primary->messages[0] == _T("before"));
+		CHECK(primary->messages[1] == _T("retry succeeded"));
+		CHECK(primary->messages[2] == _T("restored"));
+	}
+
+	CHECK(backup->messages.size() == 3);
+	if (backup->messages.size() == 3)
+	{
+		CHECK(backup->messages[0] == _T("failed"));
+		CHECK(backup->messages[1] == _T("redirected"));
+		CHECK(backup->messages[2] == _T("retry failed"));
+	}
+}
+
+int main()
+{
+	testRedirection();
+
+	return CHECK_STATUS();
+}
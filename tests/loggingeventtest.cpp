@@ -0,0 +1,225 @@
+/***************************************************************************
+                          loggingeventtest.cpp  -  tests of the wire format of LoggingEvent
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/spi/loggingevent.h>
+#include <log4cxx/logger.h>
+#include <log4cxx/level.h>
+#include <log4cxx/ndc.h>
+#include <log4cxx/fields.h>
+#include <log4cxx/helpers/serversocket.h>
+#include <log4cxx/helpers/socket.h>
+#include <log4cxx/helpers/socketoutputstream.h>
+#include <log4cxx/helpers/socketinputstream.h>
+#include <log4cxx/helpers/stacktrace.h>
+#include <log4cxx/helpers/inetaddress.h>
+#include "check.h"
+
+using namespace log4cxx;
+using namespace log4cxx::helpers;
+using namespace log4cxx::spi;
+
+/**
+Sends what <code>event</code> writes through a connection on the loopback
+interface and reads it back in <code>received</code>.
+*/
+template<class Event>
+void transfer(const Event& event, LoggingEvent& received)
+{
+	// the server socket only knows the port it was given
+	ServerSocket * server = 0;
+	int port;
+	for (port = 47350; server == 0 && port < 47400; port++)
+	{
+		try
+		{
+			server = new ServerSocket(port);
+		}
+		catch(SocketException&)
+		{
+		}
+	}
+	CHECK(server != 0);
+	if (server == 0)
+	{
+		return;
+	}
+
+	SocketPtr client = new Socket(InetAddress::getByName(_T("127.0.0.1")),
+		port - 1);
+	SocketPtr accepted = server->accept();
+
+	// the input stream reads ahead: the connection is closed first so
+	// that it does not wait for the next event
+	SocketOutputStreamPtr os = new SocketOutputStream(client);
+	event.write(os);
+	os->flush();
+	os->close();
+	client->close();
+
+	SocketInputStreamPtr is = new SocketInputStream(accepted);
+	received.read(is);
+	is->close();
+	server->close();
+	delete server;
+}
+
+void testEvent()
+{
+	LoggerPtr logger = Logger::getLogger(_T("loggingeventtest.wire"));
+	tstring user = _T("alice");
+
+	NDC::push(_T("request 42"));
+	LoggingEvent event(logger, Level::WARN, _T("request served"),
+		Fields().add(_T("status"), 200).add(_T("latency"), 0.125)
+		.add(_T("user"), user).add(_T("cached"), true)
+		.add(_T("bytes"), (int64)1 << 40));
+
+	// the NDC is read when it is first needed, as AsyncAppender does
+	event.getNDC();
+	NDC::pop();
+
+	LoggingEvent received;
+	transfer(event, received);
+
+	CHECK(received.getLoggerName() == _T("loggingeventtest.wire"));
+	CHECK(received.getLevel().level == Level::WARN.level);
+	CHECK(received.getRenderedMessage() == _T("request served"));
+	CHECK(received.getTimeStamp() == event.getTimeStamp());
+	CHECK(received.getThreadId() == event.getThreadId());
+	CHECK(received.getNDC() == _T("request 42"));
+	CHECK(received.getStackTrace() == 0);
+
+	const Fields& fields = received.getFields();
+	CHECK(fields.size() == 5);
+
+	const Field * status = fields.find(_T("status"));
+	CHECK(status != 0 && status->type == Field::INT64
+		&& status->value.int64Value == 200);
+
+	const Field * latency = fields.find(_T("latency"));
+	CHECK(latency != 0 && latency->type == Field::DOUBLE
+		&& latency->value.doubleValue == 0.125);
+
+	const Field * name = fields.find(_T("user"));
+	CHECK(name != 0 && name->type == Field::STRING
+		&& tstring(name->string, name->stringLength) == user);
+
+	const Field * cached = fields.find(_T("cached"));
+	CHECK(cached != 0 && cached->type == Field::BOOL
+		&& cached->value.boolValue);
+
+	const Field * bytes = fields.find(_T("bytes"));
+	CHECK(bytes != 0 && bytes->type == Field::INT64
+		&& bytes->value.int64Value == (int64)1 << 40);
+
+	// the received strings are owned by the event
+	tostringstream text;
+	fields.format(text);
+	CHECK(text.str() ==
+		_T("status=200 latency=0.125 user=alice cached=true bytes=1099511627776"));
+}
+
+/** Writes an event with a stack trace as another process would. */
+struct RemoteEvent
+{
+	tstring trace;
+
+	void write(SocketOutputStreamPtr os) const
+	{
+		os->write(tstring(_T("loggingeventtest.trace")));
+		os->write(Level::ERROR.toInt());
+		os->write(tstring(_T("remote")));
+		os->write((long)time(0));
+		os->write(-1);
+		os->write(tstring());
+		os->write((unsigned long)1);
+		os->write(0);
+		os->write(trace);
+	}
+};
+
+void testStackTrace()
+{
+	LoggerPtr logger = Logger::getLogger(_T("loggingeventtest.trace"));
+
+	LoggingEvent::setStackTraceLevel(Level::ERROR);
+	LoggingEvent info(logger, Level::INFO, _T("no trace"));
+	LoggingEvent error(logger, Level::ERROR, _T("with a trace"));
+	LoggingEvent::setStackTraceLevel(Level::OFF);
+
+	CHECK(info.getStackTrace() == 0);
+	CHECK(error.getStackTrace() != 0);
+	if (error.getStackTrace() == 0)
+	{
+		return;
+	}
+
+	// a trace is sent as the text formatted by the sender
+	tstring trace = error.getStackTrace()->toString();
+	CHECK(error.getStackTrace()->getFrameCount() > 0);
+	CHECK(trace.substr(0, 5) == _T("\n\tat "));
+
+	LoggingEvent received;
+	transfer(error, received);
+	CHECK(received.getRenderedMessage() == _T("with a trace"));
+	CHECK(received.getFields().size() == 0);
+	CHECK(received.getStackTrace() != 0
+		&& received.getStackTrace()->toString() == trace);
+
+	// a copy keeps its own trace
+	LoggingEvent * copy = received.copy();
+	CHECK(copy->getStackTrace() != 0
+		&& copy->getStackTrace() != received.getStackTrace()
+		&& copy->getStackTrace()->toString() == trace);
+	delete copy;
+}
+
+void testLongStackTrace()
+{
+	// longer than the strings the stream references instead of copying
+	tstring trace;
+	for (int i = 0; i < 200; i++)
+	{
+		tostringstream frame;
+		frame << _T("\n\tat frame") << i
+			<< _T("+0x10 (/usr/lib/liblog4cxx-with-a-long-path.so)");
+		trace += frame.str();
+	}
+	CHECK(trace.size() * sizeof(TCHAR) > 8192);
+
+	RemoteEvent remote;
+	remote.trace = trace;
+	LoggingEvent relayed;
+	transfer(remote, relayed);
+	CHECK(relayed.getStackTrace() != 0
+		&& relayed.getStackTrace()->toString() == trace);
+
+	// a relay writes the received text again, after its own trace
+	LoggingEvent received;
+	transfer(relayed, received);
+	CHECK(received.getRenderedMessage() == _T("remote"));
+	CHECK(received.getStackTrace() != 0
+		&& received.getStackTrace()->toString() == trace);
+}
+
+int main()
+{
+	testEvent();
+	testStackTrace();
+	testLongStackTrace();
+
+	return CHECK_STATUS();
+}
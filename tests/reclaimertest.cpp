@@ -0,0 +1,188 @@
+/***************************************************************************
+                          reclaimertest.cpp  -  tests of Reclaimer
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/helpers/reclaimer.h>
+#include <log4cxx/helpers/objectimpl.h>
+#include <log4cxx/helpers/thread.h>
+#include <log4cxx/helpers/semaphore.h>
+#include <log4cxx/spi/loggerfactory.h>
+#include <log4cxx/appenderskeleton.h>
+#include <log4cxx/logger.h>
+#include <log4cxx/level.h>
+#include "check.h"
+
+using namespace log4cxx;
+using namespace log4cxx::helpers;
+using namespace log4cxx::spi;
+
+/** Sets a flag when it is deleted. */
+class Snapshot : public ObjectImpl
+{
+public:
+	Snapshot(bool& deleted) : deleted(deleted) { deleted = false; }
+	~Snapshot() { deleted = true; }
+
+	bool& deleted;
+};
+
+void testReaders()
+{
+	Reclaimer reclaimer;
+	bool deleted;
+
+	// without any reader, a snapshot is released when retired
+	reclaimer.retire(new Snapshot(deleted));
+	CHECK(deleted);
+	CHECK(reclaimer.getRetiredCount() == 0);
+
+	// otherwise, by the last reader which leaves
+	reclaimer.enter();
+	reclaimer.enter();
+	reclaimer.retire(new Snapshot(deleted));
+	CHECK(!deleted);
+	CHECK(reclaimer.getRetiredCount() == 1);
+	reclaimer.leave();
+	CHECK(!deleted);
+	reclaimer.leave();
+	CHECK(deleted);
+	CHECK(reclaimer.getRetiredCount() == 0);
+
+	{
+		Reclaimer::Reader reader(reclaimer);
+		reclaimer.retire(new Snapshot(deleted));
+		CHECK(!deleted);
+	}
+	CHECK(deleted);
+}
+
+/** Counts the events it receives. */
+class CountingAppender : public AppenderSkeleton
+{
+public:
+	CountingAppender() : count(0) {}
+
+	void append(const LoggingEvent&)
+		{ Interlocked::increment(&count); }
+	void close() {}
+	bool requiresLayout() { return false; }
+
+	volatile long count;
+};
+
+/** Gives access to the retired appender snapshots of a logger. */
+class ReclaimerLogger : public Logger
+{
+public:
+	ReclaimerLogger(const tstring& name) : Logger(name) {}
+
+	long getRetiredCount() const
+		{ return snapshots.getRetiredCount(); }
+};
+
+class ReclaimerLoggerFactory :
+	public virtual LoggerFactory,
+	public virtual ObjectImpl
+{
+public:
+	LoggerPtr makeNewLoggerInstance(const tstring& name)
+		{ return new ReclaimerLogger(name); }
+};
+
+/** Logs count events. */
+class Producer : public Runnable, public ObjectImpl
+{
+public:
+	Producer(const LoggerPtr& logger, int count, Semaphore& done)
+	: logger(logger), count(count), done(done)
+	{
+	}
+
+	void run()
+	{
+		for (int i = 0; i < count; i++)
+		{
+			logger->info(_T("event"));
+		}
+		done.post();
+	}
+
+	LoggerPtr logger;
+	int count;
+	Semaphore& done;
+};
+
+/**
+Changes the appenders of a logger while other threads log, and checks
+that the replaced snapshots are released.
+*/
+void testLogger()
+{
+	const int threads = 4;
+	const int count = 20000;
+
+	LoggerFactoryPtr factory = new ReclaimerLoggerFactory();
+	LoggerPtr logger = Logger::getLogger(_T("reclaimertest"), factory);
+	ReclaimerLogger * reclaimerLogger =
+		dynamic_cast<ReclaimerLogger *>((Logger *)logger);
+	CHECK(reclaimerLogger != 0);
+	if (reclaimerLogger == 0)
+	{
+		return;
+	}
+
+	CountingAppender * counter = new CountingAppender();
+	AppenderPtr counterPtr = counter;
+	CountingAppender * toggled = new CountingAppender();
+	AppenderPtr toggledPtr = toggled;
+	logger->setLevel(Level::INFO);
+	logger->setAdditivity(false);
+	logger->addAppender(counterPtr);
+
+	Semaphore done;
+	for (int t = 0; t < threads; t++)
+	{
+		Thread * thread = new Thread(new Producer(logger, count, done));
+		thread->start();
+	}
+
+	for (int i = 0; i < 2000; i++)
+	{
+		logger->addAppender(toggledPtr);
+		logger->info(_T("added"));
+		logger->removeAppender(toggledPtr);
+	}
+
+	for (int t = 0; t < threads; t++)
+	{
+		done.wait();
+	}
+
+	// the last call finds no other reader
+	logger->info(_T("done"));
+	CHECK(reclaimerLogger->getRetiredCount() == 0);
+	CHECK(counter->count == threads * count + 2000 + 1);
+	CHECK(toggled->count >= 2000);
+
+	logger->removeAllAppenders();
+}
+
+int main()
+{
+	testReaders();
+	testLogger();
+
+	return CHECK_STATUS();
+}
@@ -0,0 +1,137 @@
+/***************************************************************************
+                          timezonetest.cpp  -  tests of TimeZone and DateFormat
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/helpers/timezone.h>
+#include <log4cxx/helpers/dateformat.h>
+#include <stdio.h>
+#include "check.h"
+
+using namespace log4cxx;
+using namespace log4cxx::helpers;
+
+/** 2024-01-15 12:00:00 and 2024-07-15 12:00:00 UTC */
+static const time_t WINTER = 1705320000;
+static const time_t SUMMER = 1721044800;
+
+/** Formats <code>time</code> with <code>pattern</code> in
+<code>timeZone</code>. */
+static tstring format(const tstring& pattern, const tstring& timeZone,
+	time_t time, long microseconds = 0)
+{
+	DateFormat dateFormat(pattern, timeZone);
+	tostringstream os;
+	dateFormat.format(os, time, microseconds);
+	return os.str();
+}
+
+void testRule()
+{
+	TimeZonePtr cet = TimeZone::getTimeZone(_T("CET-1CEST,M3.5.0,M10.5.0/3"));
+	CHECK(cet->getOffset(WINTER) == 3600);
+	CHECK(cet->getOffset(SUMMER) == 7200);
+	CHECK(!cet->inDaylightTime(WINTER));
+	CHECK(cet->inDaylightTime(SUMMER));
+	CHECK(cet->getAbbreviation(WINTER) == _T("CET"));
+	CHECK(cet->getAbbreviation(SUMMER) == _T("CEST"));
+
+	// 2024-03-31 and 2024-10-27 at 01:00 UTC
+	CHECK(cet->getOffset(1711846800 - 1) == 3600);
+	CHECK(cet->getOffset(1711846800) == 7200);
+	CHECK(cet->getOffset(1729990800 - 1) == 7200);
+	CHECK(cet->getOffset(1729990800) == 3600);
+
+	// the default rule of the United States: 2024-03-10 at 07:00 UTC
+	// and 2024-11-03 at 06:00 UTC
+	TimeZonePtr est = TimeZone::getTimeZone(_T("EST5EDT"));
+	CHECK(est->getOffset(1710054000 - 1) == -5 * 3600);
+	CHECK(est->getOffset(1710054000) == -4 * 3600);
+	CHECK(est->getOffset(1730613600 - 1) == -4 * 3600);
+	CHECK(est->getOffset(1730613600) == -5 * 3600);
+
+	// daylight time across the new year in the southern hemisphere
+	TimeZonePtr aest =
+		TimeZone::getTimeZone(_T("AEST-10AEDT,M10.1.0,M4.1.0/3"));
+	CHECK(aest->getOffset(WINTER) == 11 * 3600);
+	CHECK(aest->getOffset(SUMMER) == 10 * 3600);
+	CHECK(aest->getAbbreviation(WINTER) == _T("AEDT"));
+
+	// quoted abbreviations
+	TimeZonePtr quoted = TimeZone::getTimeZone(_T("<-03>3"));
+	CHECK(quoted->getOffset(WINTER) == -3 * 3600);
+	CHECK(quoted->getAbbreviation(WINTER) == _T("-03"));
+}
+
+void testCustomID()
+{
+	TimeZonePtr india = TimeZone::getTimeZone(_T("GMT+05:30"));
+	CHECK(india->getOffset(WINTER) == 19800);
+	CHECK(india->getAbbreviation(WINTER) == _T("GMT+05:30"));
+
+	TimeZonePtr pacific = TimeZone::getTimeZone(_T("GMT-0800"));
+	CHECK(pacific->getOffset(SUMMER) == -8 * 3600);
+	CHECK(pacific->getAbbreviation(SUMMER) == _T("GMT-08:00"));
+
+	TimeZonePtr utc = TimeZone::getTimeZone(_T("UTC"));
+	CHECK(utc->getOffset(SUMMER) == 0);
+	CHECK(utc->getAbbreviation(SUMMER) == _T("UTC"));
+}
+
+void testZoneinfo()
+{
+	// only run where the zoneinfo database is installed
+	FILE * file = fopen("/usr/share/zoneinfo/Europe/Paris", "rb");
+	if (file == 0)
+	{
+		return;
+	}
+	fclose(file);
+
+	TimeZonePtr paris = TimeZone::getTimeZone(_T("Europe/Paris"));
+	CHECK(paris->getOffset(WINTER) == 3600);
+	CHECK(paris->getOffset(SUMMER) == 7200);
+	CHECK(paris->getAbbreviation(WINTER) == _T("CET"));
+	CHECK(paris->getAbbreviation(SUMMER) == _T("CEST"));
+
+	// before 1940, Paris used its own mean time
+	CHECK(paris->getOffset(-3000000000LL) == 561);
+}
+
+void testDateFormat()
+{
+	const tstring pattern = _T("%Y-%m-%d %H:%M:%S,%Q %z %Z");
+	const tstring cet = _T("CET-1CEST,M3.5.0,M10.5.0/3");
+
+	CHECK(format(pattern, cet, WINTER, 5000)
+		== _T("2024-01-15 13:00:00,005 +0100 CET"));
+	CHECK(format(pattern, cet, SUMMER, 999999)
+		== _T("2024-07-15 14:00:00,999 +0200 CEST"));
+	CHECK(format(pattern, _T("EST5EDT"), WINTER)
+		== _T("2024-01-15 07:00:00,000 -0500 EST"));
+	CHECK(format(_T("%H:%M %z %Z"), _T("GMT+05:30"), WINTER)
+		== _T("17:30 +0530 GMT+05:30"));
+	CHECK(format(_T("%T.%f %%z"), _T("GMT"), SUMMER, 42)
+		== _T("12:00:00.000042 %z"));
+}
+
+int main()
+{
+	testRule();
+	testCustomID();
+	testZoneinfo();
+	testDateFormat();
+
+	return CHECK_STATUS();
+}
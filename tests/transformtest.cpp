@@ -0,0 +1,168 @@
+/***************************************************************************
+                          transformtest.cpp  -  tests of the sanitizer of Transform
+                             -------------------
+    begin                : mar mai 27 2003
+    copyright            : (C) 2003 by Michael CATANZARITI
+    email                : mcatan@free.fr
+ ***************************************************************************/
+
+/***************************************************************************
+ * Copyright (C) The Apache Software Foundation. All rights reserved.      *
+ *                                                                         *
+ * This software is published under the terms of the Apache Software       *
+ * License version 1.1, a copy of which has been included with this        *
+ * distribution in the LICENSE.txt file.                                   *
+ ***************************************************************************/
+
+#include <log4cxx/helpers/transform.h>
+#include <log4cxx/patternlayout.h>
+#include <log4cxx/logger.h>
+#include <log4cxx/level.h>
+#include <log4cxx/spi/loggingevent.h>
+#include "check.h"
+
+using namespace log4cxx;
+using namespace log4cxx::helpers;
+using namespace log4cxx::spi;
+
+/** Returns <code>input</code> as sanitized by Transform. */
+static tstring sanitize(const tstring& input)
+{
+	tostringstream buf;
+	Transform::appendSanitized(buf, input);
+	return buf.str();
+}
+
+/** Returns the length of the safe prefix found one character at a
+time. */
+static size_t scanReference(const tstring& input)
+{
+	for (size_t i = 0; i < input.length(); i++)
+	{
+		unsigned long c = (unsigned long)input[i];
+#ifndef UNICODE
+		c &= 0xFF;
+		if (c >= 0x80)
+		{
+			return i;
+		}
+#endif
+		if ((c < 0x20 && c != '\t') || c == 0x7F)
+		{
+			return i;
+		}
+	}
+
+	return input.length();
+}
+
+/**
+Puts each unsafe character at each position of strings from 0 to 100
+characters: the short strings and the tails are scanned one character
+at a time, the others 32 bytes at a time when SSE2 is available.
+*/
+void testScanSafe()
+{
+	static const TCHAR unsafe[] = { 0x01, _T('\n'), 0x1F, 0x7F
+#ifndef UNICODE
+		, (TCHAR)0x80, (TCHAR)0xC3, (TCHAR)0xFF
+#endif
+	};
+
+	for (size_t length = 0; length <= 100; length++)
+	{
+		tstring safe(length, _T('a'));
+		if (length > 0)
+		{
+			safe[length / 2] = _T('\t');
+		}
+		CHECK(Transform::scanSafe(safe.data(), length) == length);
+
+		for (size_t u = 0; u < sizeof(unsafe) / sizeof(unsafe[0]); u++)
+		{
+			for (size_t pos = 0; pos < length; pos++)
+			{
+				tstring input(length, _T('~'));
+				input[pos] = unsafe[u];
+				size_t found = Transform::scanSafe(input.data(), length);
+				CHECK(found == pos && found == scanReference(input));
+			}
+		}
+	}
+}
+
+void testEscapes()
+{
+	CHECK(sanitize(_T("")) == _T(""));
+	CHECK(sanitize(_T("plain text")) == _T("plain text"));
+	CHECK(sanitize(_T("a\tb")) == _T("a\tb"));
+	CHECK(sanitize(_T("line 1\r\nline 2")) == _T("line 1\\r\\nline 2"));
+	CHECK(sanitize(_T("\x1B[31mred")) == _T("\\x1B[31mred"));
+	CHECK(sanitize(_T("del\x7F")) == _T("del\\x7F"));
+	CHECK(sanitize(tstring(1, (TCHAR)0)) == _T("\\x00"));
+}
+
+#ifndef UNICODE
+void testUtf8()
+{
+	const tstring replacement = "\xEF\xBF\xBD";
+
+	// valid sequences of 2, 3 and 4 bytes
+	CHECK(sanitize("caf\xC3\xA9") == "caf\xC3\xA9");
+	CHECK(sanitize("\xE2\x82\xAC 5") == "\xE2\x82\xAC 5");
+	CHECK(sanitize("\xF0\x9F\x98\x80") == "\xF0\x9F\x98\x80");
+	CHECK(sanitize("\xF4\x8F\xBF\xBF") == "\xF4\x8F\xBF\xBF");
+
+	// overlong forms and surrogates: each byte is replaced
+	CHECK(sanitize("\xC0\xAF") == replacement + replacement);
+	CHECK(sanitize("\xE0\x80\xAF")
+		== replacement + replacement + replacement);
+	CHECK(sanitize("\xED\xA0\x80")
+		== replacement + replacement + replacement);
+
+	// above U+10FFFF
+	CHECK(sanitize("\xF4\x90\x80\x80")
+		== replacement + replacement + replacement + replacement);
+	CHECK(sanitize("\xFF") == replacement);
+
+	// a truncated sequence is replaced once
+	CHECK(sanitize("\xE2\x82") == replacement);
+	CHECK(sanitize("\xE2\x82" "A") == replacement + "A");
+	CHECK(sanitize("\xF0\x9F\x98\n") == replacement + "\\n");
+
+	// the same after a prefix long enough for the vector scan
+	tstring prefix(40, 'x');
+	CHECK(sanitize(prefix + "\xC3\xA9\r" + prefix)
+		== prefix + "\xC3\xA9\\r" + prefix);
+	CHECK(sanitize(prefix + "\xE2\x82" "A" + prefix)
+		== prefix + replacement + "A" + prefix);
+}
+#endif
+
+/** Only the text output by the conversion specifiers is sanitized. */
+void testPatternLayout()
+{
+	LoggerPtr logger = Logger::getLogger(_T("transformtest"));
+	LoggingEvent event(logger, Level::INFO, _T("forged\nINFO entry"));
+
+	PatternLayout * layout = new PatternLayout(_T("%p\t%m%n"));
+	LayoutPtr layoutPtr = layout;
+	layout->setSanitize(true);
+	layout->activateOptions();
+
+	tostringstream output;
+	layout->format(output, event);
+	CHECK(output.str() == _T("INFO\tforged\\nINFO entry\n"));
+}
+
+int main()
+{
+	testScanSafe();
+	testEscapes();
+#ifndef UNICODE
+	testUtf8();
+#endif
+	testPatternLayout();
+
+	return CHECK_STATUS();
+}